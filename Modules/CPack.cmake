@@ -182,6 +182,18 @@
 #  will be a boolean variable which enables stripping of all files (a list
 #  of files evaluates to TRUE in CMake, so this change is compatible).
 #
+# .. variable:: CPACK_ARCHIVE_COMPRESSION_JOBS
+#
+#  Number of parallel jobs the archive generators (TGZ, STGZ, TBZ2, ...)
+#  use to compress packages.  When greater than 1 and a parallel
+#  compressor for the format (pigz for gzip, pbzip2 for bzip2) is found
+#  in the PATH, the archive is piped through it.  The result is read by
+#  the standard tools.  Otherwise the built-in single-threaded
+#  compression is used.  Set it in :variable:`CPACK_PROJECT_CONFIG_FILE`
+#  to choose a value per generator.  None of these generators writes xz;
+#  see :variable:`CPACK_DEBIAN_COMPRESSION_JOBS` for the xz data archive
+#  of Debian packages.
+#
 # The following CPack variables are specific to source packages, and
 # will not affect binary packages:
 #
@@ -252,6 +264,21 @@
 #
 #  Extra directories to install.
 #
+# .. variable:: CPACK_STAGING_MODE
+#
+#  How files are placed in the temporary directory packages are created
+#  from.  One of:
+#
+#  * COPY (default): copy the files
+#  * REFLINK: clone the files as copy-on-write copies.  The files
+#    installed by projects are cloned by setting
+#    :variable:`CMAKE_INSTALL_REFLINK`.
+#
+#  Files are copied whenever the file system cannot clone them.  Hard
+#  links are not supported since package generators may modify the
+#  staged files.  Verbose output reports how much data was copied and
+#  cloned.
+#
 # .. variable:: CPACK_PACKAGE_INSTALL_REGISTRY_KEY
 #
 #  Registry key used when installing this project. This is only used by
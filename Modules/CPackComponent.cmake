@@ -59,6 +59,21 @@
 #  One can specify different grouping for different CPack generator by
 #  using a CPACK_PROJECT_CONFIG_FILE.
 #
+# .. variable:: CPACK_COMPONENTS_INSTALL_JOBS
+#
+#  Maximum number of components installed at the same time.
+#
+#  When greater than 1 and the generator packages components separately,
+#  each component is installed by a separate ``cmake -P`` process.
+#  Components sharing an install directory are still installed one after
+#  another.  Defaults to 1.
+#
+#  The install scripts see the same variables as when CPack installs the
+#  components itself, such as ``CMAKE_INSTALL_PREFIX`` and
+#  ``CMAKE_INSTALL_COMPONENT``.  As there, the CPack variables, including
+#  those set in :variable:`CPACK_PROJECT_CONFIG_FILE`, are not visible to
+#  them.
+#
 # .. variable:: CPACK_COMPONENT_<compName>_DISPLAY_NAME
 #
 #  The name to be displayed for a component.
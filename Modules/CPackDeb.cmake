@@ -74,6 +74,18 @@
 #
 #     Possible values are: lzma, xz, bzip2 and gzip.
 #
+# .. variable:: CPACK_DEBIAN_COMPRESSION_JOBS
+#
+#  * Mandatory : NO
+#  * Default   : 1
+#
+#     Number of parallel jobs used to compress the data archive of the
+#     package.  When greater than 1 the gzip or bzip2 data is piped
+#     through pigz or pbzip2 if found in the PATH.  The xz data is
+#     written by the system tar, which is given ``XZ_OPT=-T<jobs>`` in
+#     its environment; xz 5.2 or later is needed to compress in parallel
+#     and older versions use a single thread.
+#
 # .. variable:: CPACK_DEBIAN_PACKAGE_PRIORITY
 #
 #  * Mandatory : YES
@@ -32,6 +32,20 @@ macro(__compiler_gnu lang)
   set(CMAKE_SHARED_LIBRARY_CREATE_${lang}_FLAGS "-shared")
   set(CMAKE_${lang}_COMPILE_OPTIONS_SYSROOT "--sysroot=")
 
+  # Precompiled headers are found next to the header named by -include.
+  if("${lang}" MATCHES "^(C|CXX)$"
+      AND NOT CMAKE_${lang}_COMPILER_VERSION VERSION_LESS 3.4)
+    if("${lang}" STREQUAL "C")
+      set(__pch_header_type "c-header")
+    else()
+      set(__pch_header_type "c++-header")
+    endif()
+    set(CMAKE_PCH_EXTENSION .gch)
+    set(CMAKE_${lang}_COMPILE_OPTIONS_USE_PCH -Winvalid-pch -include <PCH_HEADER>)
+    set(CMAKE_${lang}_COMPILE_OPTIONS_CREATE_PCH -Winvalid-pch -x ${__pch_header_type})
+    unset(__pch_header_type)
+  endif()
+
   # Older versions of gcc (< 4.5) contain a bug causing them to report a missing
   # header file as a warning if depfiles are enabled, causing check_header_file
   # tests to always succeed.  Work around this by disabling dependency tracking
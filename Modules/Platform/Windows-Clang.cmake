@@ -23,6 +23,9 @@ if(CMAKE_C_SIMULATE_ID STREQUAL "MSVC"
   include(Platform/Windows-MSVC)
   macro(__windows_compiler_clang lang)
     __windows_compiler_msvc(${lang})
+    # clang-cl ignores the options creating and using precompiled headers.
+    unset(CMAKE_${lang}_COMPILE_OPTIONS_USE_PCH)
+    unset(CMAKE_${lang}_COMPILE_OPTIONS_CREATE_PCH)
   endmacro()
 else()
   include(Platform/Windows-GNU)
@@ -31,6 +31,8 @@ cmCPackArchiveGenerator::cmCPackArchiveGenerator(cmArchiveWrite::Compress t,
 {
   this->Compress = t;
   this->Archive = at;
+  this->CompressionJobs = 1;
+  this->ArchiveStartTime = 0;
 }
 
 //----------------------------------------------------------------------
@@ -100,7 +102,9 @@ if (!GenerateHeader(&gf)) \
             << ">." << std::endl); \
     return 0; \
   } \
-cmArchiveWrite archive(gf,this->Compress, this->Archive); \
+this->ArchiveStartTime = cmSystemTools::GetTime(); \
+cmArchiveWrite archive(gf,this->Compress, this->Archive, \
+                       this->CompressionJobs); \
 if (!archive) \
   { \
   cmCPackLogger(cmCPackLog::LOG_ERROR, "Problem to create archive < " \
@@ -111,6 +115,32 @@ if (!archive) \
   return 0; \
   }
 
+//----------------------------------------------------------------------
+int cmCPackArchiveGenerator::FinishArchive(cmArchiveWrite& archive,
+                                           std::string const& filename)
+{
+  if (!archive.Close())
+    {
+    cmCPackLogger(cmCPackLog::LOG_ERROR, "Problem to finish archive < "
+       << filename
+       << ">. ERROR ="
+       << archive.GetError()
+       << std::endl);
+    return 0;
+    }
+  double seconds = cmSystemTools::GetTime() - this->ArchiveStartTime;
+  double megabytes = static_cast<double>(archive.GetBytesIn()) / 1048576;
+  cmCPackLogger(cmCPackLog::LOG_VERBOSE, "Compressed "
+    << megabytes << " MB to "
+    << static_cast<double>(archive.GetBytesOut()) / 1048576 << " MB in "
+    << seconds << " sec ("
+    << (seconds > 0 ? megabytes / seconds : 0) << " MB/s) using "
+    << (archive.GetCompressor().empty() ?
+        std::string("built-in compression") : archive.GetCompressor())
+    << std::endl);
+  return 1;
+}
+
 //----------------------------------------------------------------------
 int cmCPackArchiveGenerator::PackageComponents(bool ignoreGroup)
 {
@@ -146,6 +176,10 @@ int cmCPackArchiveGenerator::PackageComponents(bool ignoreGroup)
           // Add the files of this component to the archive
           addOneComponentToArchive(archive,*compIt);
           }
+        if (!this->FinishArchive(archive, packageFileName))
+          {
+          return 0;
+          }
       }
       // add the generated package to package file names list
       packageFileNames.push_back(packageFileName);
@@ -178,6 +212,10 @@ int cmCPackArchiveGenerator::PackageComponents(bool ignoreGroup)
           DECLARE_AND_OPEN_ARCHIVE(packageFileName,archive);
           // Add the files of this component to the archive
           addOneComponentToArchive(archive,&(compIt->second));
+          if (!this->FinishArchive(archive, packageFileName))
+            {
+            return 0;
+            }
         }
         // add the generated package to package file names list
         packageFileNames.push_back(packageFileName);
@@ -205,6 +243,10 @@ int cmCPackArchiveGenerator::PackageComponents(bool ignoreGroup)
         DECLARE_AND_OPEN_ARCHIVE(packageFileName,archive);
         // Add the files of this component to the archive
         addOneComponentToArchive(archive,&(compIt->second));
+        if (!this->FinishArchive(archive, packageFileName))
+          {
+          return 0;
+          }
       }
       // add the generated package to package file names list
       packageFileNames.push_back(packageFileName);
@@ -237,8 +279,7 @@ int cmCPackArchiveGenerator::PackageComponentsAllInOne()
     addOneComponentToArchive(archive,&(compIt->second));
     }
 
-  // archive goes out of scope so it will finalized and closed.
-  return 1;
+  return this->FinishArchive(archive, packageFileNames[0]);
 }
 
 //----------------------------------------------------------------------
@@ -247,6 +288,13 @@ int cmCPackArchiveGenerator::PackageFiles()
   cmCPackLogger(cmCPackLog::LOG_DEBUG, "Toplevel: "
                 << toplevel << std::endl);
 
+  this->CompressionJobs = 1;
+  if (const char* jobs = this->GetOption("CPACK_ARCHIVE_COMPRESSION_JOBS"))
+    {
+    int n = atoi(jobs);
+    this->CompressionJobs = n > 1 ? static_cast<unsigned int>(n) : 1;
+    }
+
   if (WantsComponentInstallation()) {
     // CASE 1 : COMPONENT ALL-IN-ONE package
     // If ALL COMPONENTS in ONE package has been requested
@@ -289,8 +337,7 @@ int cmCPackArchiveGenerator::PackageFiles()
       }
     }
   cmSystemTools::ChangeDirectory(dir.c_str());
-  // The destructor of cmArchiveWrite will close and finish the write
-  return 1;
+  return this->FinishArchive(archive, packageFileNames[0]);
 }
 
 //----------------------------------------------------------------------
@@ -66,9 +66,16 @@ protected:
    * components will be put in a single installer.
    */
   int PackageComponentsAllInOne();
+  /**
+   * Finish writing the given archive and report its compression
+   * throughput.  Returns 0 on error.
+   */
+  int FinishArchive(cmArchiveWrite& archive, std::string const& filename);
   virtual const char* GetOutputExtension() = 0;
   cmArchiveWrite::Compress Compress;
   cmArchiveWrite::Type Archive;
+  unsigned int CompressionJobs;
+  double ArchiveStartTime;
   };
 
 #endif
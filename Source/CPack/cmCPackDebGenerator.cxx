@@ -15,6 +15,7 @@
 #include "cmMakefile.h"
 #include "cmGeneratedFileStream.h"
 #include "cmCPackLog.h"
+#include "cmArchiveWrite.h"
 
 #include <cmsys/SystemTools.hxx>
 #include <cmsys/Glob.hxx>
@@ -282,8 +283,6 @@ int cmCPackDebGenerator::PackageFiles()
 
 int cmCPackDebGenerator::createDeb()
 {
-  const char* cmakeExecutable = this->GetOption("CMAKE_COMMAND");
-
   // debian-binary file
   std::string dbfilename;
     dbfilename += this->GetOption("WDIR");
@@ -399,11 +398,6 @@ int cmCPackDebGenerator::createDeb()
     out << std::endl;
     }
 
-  std::string cmd;
-  if (NULL != this->GetOption("CPACK_DEBIAN_FAKEROOT_EXECUTABLE")) {
-      cmd += this->GetOption("CPACK_DEBIAN_FAKEROOT_EXECUTABLE");
-  }
-
   const char* debian_compression_type =
       this->GetOption("CPACK_DEBIAN_COMPRESSION_TYPE");
   if(!debian_compression_type)
@@ -411,40 +405,49 @@ int cmCPackDebGenerator::createDeb()
     debian_compression_type = "gzip";
     }
 
-  std::string cmake_tar = " ", compression_modifier = "a", compression_suffix;
+  // The built-in libarchive cannot write lzma or xz so those formats
+  // are still produced by the tar tool of the system.
+  bool inProcess = true;
+  cmArchiveWrite::Compress tar_compression_type = cmArchiveWrite::CompressGZip;
+  std::string compression_suffix;
   if(!strcmp(debian_compression_type, "lzma")) {
       compression_suffix = ".lzma";
+      inProcess = false;
   } else if(!strcmp(debian_compression_type, "xz")) {
       compression_suffix = ".xz";
+      inProcess = false;
   } else if(!strcmp(debian_compression_type, "bzip2")) {
       compression_suffix = ".bz2";
-      compression_modifier = "j";
-      cmake_tar += "\"" + std::string(cmakeExecutable) + "\" -E ";
+      tar_compression_type = cmArchiveWrite::CompressBZip2;
   } else if(!strcmp(debian_compression_type, "gzip")) {
       compression_suffix = ".gz";
-      compression_modifier = "z";
-      cmake_tar += "\"" + std::string(cmakeExecutable) + "\" -E ";
+      tar_compression_type = cmArchiveWrite::CompressGZip;
   } else if(!strcmp(debian_compression_type, "none")) {
       compression_suffix = "";
-      compression_modifier = "";
-      cmake_tar += "\"" + std::string(cmakeExecutable) + "\" -E ";
+      tar_compression_type = cmArchiveWrite::CompressNone;
   } else {
       cmCPackLogger(cmCPackLog::LOG_ERROR,
                     "Error unrecognized compression type: "
                     << debian_compression_type << std::endl);
+      return 0;
   }
 
-  cmd += cmake_tar + "tar c" + compression_modifier + "f data.tar"
-      + compression_suffix;
+  unsigned int compressionJobs = 1;
+  if (const char* jobs = this->GetOption("CPACK_DEBIAN_COMPRESSION_JOBS"))
+    {
+    int n = atoi(jobs);
+    compressionJobs = n > 1 ? static_cast<unsigned int>(n) : 1;
+    }
 
   // now add all directories which have to be compressed
   // collect all top level install dirs for that
   // e.g. /opt/bin/foo, /usr/bin/bar and /usr/bin/baz would give /usr and /opt
-    size_t topLevelLength = std::string(this->GetOption("WDIR")).length();
-    cmCPackLogger(cmCPackLog::LOG_DEBUG, "WDIR: \"" << this->GetOption("WDIR")
+  std::string const wdir = this->GetOption("WDIR");
+    size_t topLevelLength = wdir.length();
+    cmCPackLogger(cmCPackLog::LOG_DEBUG, "WDIR: \"" << wdir
           << "\", length = " << topLevelLength
           << std::endl);
-  std::set<std::string> installDirs;
+  std::vector<std::string> installDirs;
     for (std::vector<std::string>::const_iterator fileIt =
         packageFiles.begin();
         fileIt != packageFiles.end(); ++ fileIt )
@@ -456,129 +459,171 @@ int cmCPackDebGenerator::createDeb()
                                              slashPos - topLevelLength);
       cmCPackLogger(cmCPackLog::LOG_DEBUG, "RELATIVEDIR: \"" << relativeDir
       << "\"" << std::endl);
-    if (installDirs.find(relativeDir) == installDirs.end())
+    if (std::find(installDirs.begin(), installDirs.end(), relativeDir)
+        == installDirs.end())
       {
-      installDirs.insert(relativeDir);
-      cmd += " .";
-      cmd += relativeDir;
+      installDirs.push_back(relativeDir);
       }
     }
 
-  std::string output;
-    int retval = -1;
-  int res = cmSystemTools::RunSingleCommand(cmd.c_str(), &output,
-      &retval, this->GetOption("WDIR"), this->GeneratorVerbose, 0);
-
-    if ( !res || retval )
+  std::string md5filename = wdir + "/md5sums";
+  std::string datafilename = wdir + "/data.tar" + compression_suffix;
+  if (inProcess)
     {
-    std::string tmpFile = this->GetOption("CPACK_TOPLEVEL_DIRECTORY");
-    tmpFile += "/Deb.log";
-    cmGeneratedFileStream ofs(tmpFile.c_str());
-    ofs << "# Run command: " << cmd << std::endl
-      << "# Working directory: " << toplevel << std::endl
-      << "# Output:" << std::endl
-      << output << std::endl;
-    cmCPackLogger(cmCPackLog::LOG_ERROR, "Problem running tar command: "
-      << cmd << std::endl
-      << "Please check " << tmpFile << " for errors" << std::endl);
-    return 0;
-    }
-
-  std::string md5filename;
-    md5filename = this->GetOption("WDIR");
-  md5filename += "/md5sums";
+    // Write data.tar and compute the md5sums while each file is read.
+    cmArchiveWrite::MD5SumsType md5sums;
+      {
+      cmGeneratedFileStream gf;
+      gf.Open(datafilename.c_str(), false, true);
+      double start = cmSystemTools::GetTime();
+      cmArchiveWrite data_tar(gf, tar_compression_type,
+                              cmArchiveWrite::TypeTAR, compressionJobs);
+      // The packaged files are owned by root.
+      data_tar.SetUIDAndGID(0, 0);
+      data_tar.SetUNAMEAndGNAME("root", "root");
+      data_tar.SetComputeMD5(true);
+      for (std::vector<std::string>::const_iterator dirIt =
+             installDirs.begin(); dirIt != installDirs.end(); ++dirIt)
+        {
+        // debian is picky and need relative to ./ path in the tar.*
+        data_tar.Add(wdir + *dirIt, topLevelLength, ".");
+        }
+      if (!data_tar.Close())
+        {
+        cmCPackLogger(cmCPackLog::LOG_ERROR, "Problem creating archive "
+          << datafilename << ": " << data_tar.GetError() << std::endl);
+        return 0;
+        }
+      cmCPackLogger(cmCPackLog::LOG_VERBOSE, "Compressed "
+        << static_cast<double>(data_tar.GetBytesIn()) / 1048576.0
+        << " MB of data to "
+        << static_cast<double>(data_tar.GetBytesOut()) / 1048576.0
+        << " MB in " << cmSystemTools::GetTime() - start << " sec using "
+        << (data_tar.GetCompressor().empty()?
+            std::string("built-in compression") : data_tar.GetCompressor())
+        << std::endl);
+      md5sums = data_tar.GetMD5Sums();
+      }
 
-    { // the scope is needed for cmGeneratedFileStream
     cmGeneratedFileStream out(md5filename.c_str());
-    std::vector<std::string>::const_iterator fileIt;
-//       std::string topLevelWithTrailingSlash = toplevel;
-    std::string topLevelWithTrailingSlash =
-        this->GetOption("CPACK_TEMPORARY_DIRECTORY");
-    topLevelWithTrailingSlash += '/';
-      for ( fileIt = packageFiles.begin();
-            fileIt != packageFiles.end(); ++ fileIt )
+    for (cmArchiveWrite::MD5SumsType::const_iterator md5It =
+           md5sums.begin(); md5It != md5sums.end(); ++md5It)
       {
-      cmd = "\"";
-      cmd += cmakeExecutable;
-      cmd += "\" -E md5sum \"";
-      cmd += *fileIt;
-      cmd += "\"";
-      //std::string output;
-      //int retVal = -1;
-      res = cmSystemTools::RunSingleCommand(cmd.c_str(), &output,
-          &retval, toplevel.c_str(), this->GeneratorVerbose, 0);
       // debian md5sums entries are like this:
       // 014f3604694729f3bf19263bac599765  usr/bin/ccmake
-      // thus strip the full path (with the trailing slash)
-      cmSystemTools::ReplaceString(output,
-                                   topLevelWithTrailingSlash.c_str(), "");
-      out << output;
+      out << md5It->second << "  " << md5It->first.substr(2) << "\n";
       }
-    // each line contains a eol.
-    // Do not end the md5sum file with yet another (invalid)
     }
-
-    cmd = "";
+  else
+    {
+    std::string cmd;
     if (NULL != this->GetOption("CPACK_DEBIAN_FAKEROOT_EXECUTABLE"))
       {
-      cmd = this->GetOption("CPACK_DEBIAN_FAKEROOT_EXECUTABLE");
+      cmd += this->GetOption("CPACK_DEBIAN_FAKEROOT_EXECUTABLE");
       }
-    cmd += cmake_tar + "tar czf control.tar.gz ./control ./md5sums";
-    const char* controlExtra =
-      this->GetOption("CPACK_DEBIAN_PACKAGE_CONTROL_EXTRA");
-  if( controlExtra )
-    {
-    std::vector<std::string> controlExtraList;
-    cmSystemTools::ExpandListArgument(controlExtra, controlExtraList);
-    for(std::vector<std::string>::iterator i =
-          controlExtraList.begin(); i != controlExtraList.end(); ++i)
+    cmd += " tar caf data.tar" + compression_suffix;
+    for (std::vector<std::string>::const_iterator dirIt =
+           installDirs.begin(); dirIt != installDirs.end(); ++dirIt)
+      {
+      cmd += " .";
+      cmd += *dirIt;
+      }
+
+    // The system tar runs xz, which compresses in parallel with -T.
+    cmSystemTools::SaveRestoreEnvironment restoreEnv;
+    if (compressionJobs > 1 && !strcmp(debian_compression_type, "xz"))
+      {
+      cmOStringStream xzOpt;
+      xzOpt << "XZ_OPT=-T" << compressionJobs;
+      cmSystemTools::PutEnv(xzOpt.str().c_str());
+      }
+
+    std::string output;
+    int retval = -1;
+    int res = cmSystemTools::RunSingleCommand(cmd.c_str(), &output,
+        &retval, wdir.c_str(), this->GeneratorVerbose, 0);
+    if ( !res || retval )
+      {
+      std::string tmpFile = this->GetOption("CPACK_TOPLEVEL_DIRECTORY");
+      tmpFile += "/Deb.log";
+      cmGeneratedFileStream ofs(tmpFile.c_str());
+      ofs << "# Run command: " << cmd << std::endl
+        << "# Working directory: " << toplevel << std::endl
+        << "# Output:" << std::endl
+        << output << std::endl;
+      cmCPackLogger(cmCPackLog::LOG_ERROR, "Problem running tar command: "
+        << cmd << std::endl
+        << "Please check " << tmpFile << " for errors" << std::endl);
+      return 0;
+      }
+
+    cmGeneratedFileStream out(md5filename.c_str());
+    for (std::vector<std::string>::const_iterator fileIt =
+           packageFiles.begin(); fileIt != packageFiles.end(); ++ fileIt )
       {
-      std::string filenamename =
-        cmsys::SystemTools::GetFilenameName(*i);
-      std::string localcopy = this->GetOption("WDIR");
-      localcopy += "/";
-      localcopy += filenamename;
-      // if we can copy the file, it means it does exist, let's add it:
-      if( cmsys::SystemTools::CopyFileIfDifferent(
-            i->c_str(), localcopy.c_str()) )
+      char md5[33];
+      md5[32] = 0;
+      if (!cmSystemTools::FileIsSymlink(fileIt->c_str()) &&
+          cmSystemTools::ComputeFileMD5(*fileIt, md5))
         {
-        // debian is picky and need relative to ./ path in the tar.*
-        cmd += " ./";
-        cmd += filenamename;
+        out << md5 << "  " << fileIt->substr(topLevelLength + 1) << "\n";
         }
       }
     }
-  res = cmSystemTools::RunSingleCommand(cmd.c_str(), &output,
-      &retval, this->GetOption("WDIR"), this->GeneratorVerbose, 0);
 
-    if ( !res || retval )
+  // control.tar.gz holds the control file, the md5sums and any extra
+  // files requested by the project.
+  std::string controlfilename = wdir + "/control.tar.gz";
     {
-    std::string tmpFile = this->GetOption("CPACK_TOPLEVEL_DIRECTORY");
-    tmpFile += "/Deb.log";
-    cmGeneratedFileStream ofs(tmpFile.c_str());
-    ofs << "# Run command: " << cmd << std::endl
-      << "# Working directory: " << toplevel << std::endl
-      << "# Output:" << std::endl
-      << output << std::endl;
-    cmCPackLogger(cmCPackLog::LOG_ERROR, "Problem running tar command: "
-      << cmd << std::endl
-      << "Please check " << tmpFile << " for errors" << std::endl);
-    return 0;
+    cmGeneratedFileStream gf;
+    gf.Open(controlfilename.c_str(), false, true);
+    cmArchiveWrite control_tar(gf, cmArchiveWrite::CompressGZip,
+                               cmArchiveWrite::TypeTAR);
+    control_tar.SetUIDAndGID(0, 0);
+    control_tar.SetUNAMEAndGNAME("root", "root");
+    control_tar.Add(ctlfilename, topLevelLength, ".");
+    control_tar.Add(md5filename, topLevelLength, ".");
+    const char* controlExtra =
+      this->GetOption("CPACK_DEBIAN_PACKAGE_CONTROL_EXTRA");
+    if( controlExtra )
+      {
+      std::vector<std::string> controlExtraList;
+      cmSystemTools::ExpandListArgument(controlExtra, controlExtraList);
+      for(std::vector<std::string>::iterator i =
+            controlExtraList.begin(); i != controlExtraList.end(); ++i)
+        {
+        std::string filenamename =
+          cmsys::SystemTools::GetFilenameName(*i);
+        std::string localcopy = wdir;
+        localcopy += "/";
+        localcopy += filenamename;
+        // if we can copy the file, it means it does exist, let's add it:
+        if( cmsys::SystemTools::CopyFileIfDifferent(
+              i->c_str(), localcopy.c_str()) )
+          {
+          control_tar.Add(localcopy, topLevelLength, ".");
+          }
+        }
+      }
+    if (!control_tar.Close())
+      {
+      cmCPackLogger(cmCPackLog::LOG_ERROR, "Problem creating archive "
+        << controlfilename << ": " << control_tar.GetError() << std::endl);
+      return 0;
+      }
     }
 
   // ar -r your-package-name.deb debian-binary control.tar.* data.tar.*
   // since debian packages require BSD ar (most Linux distros and even
   // FreeBSD and NetBSD ship GNU ar) we use a copy of OpenBSD ar here.
   std::vector<std::string> arFiles;
-    std::string topLevelString = this->GetOption("WDIR");
-  topLevelString += "/";
-  arFiles.push_back(topLevelString + "debian-binary");
-  arFiles.push_back(topLevelString + "control.tar.gz");
-  arFiles.push_back(topLevelString + "data.tar" + compression_suffix);
+  arFiles.push_back(dbfilename);
+  arFiles.push_back(controlfilename);
+  arFiles.push_back(datafilename);
     std::string outputFileName = this->GetOption("CPACK_TOPLEVEL_DIRECTORY");
     outputFileName += "/";
     outputFileName += this->GetOption("CPACK_OUTPUT_FILE_NAME");
-    res = ar_append(outputFileName.c_str(), arFiles);
+    int res = ar_append(outputFileName.c_str(), arFiles);
   if ( res!=0 )
     {
     std::string tmpFile = this->GetOption("CPACK_TEMPORARY_PACKAGE_FILE_NAME");
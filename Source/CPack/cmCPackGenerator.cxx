@@ -24,6 +24,7 @@
 #include <cmsys/SystemTools.hxx>
 #include <cmsys/Glob.hxx>
 #include <cmsys/FStream.hxx>
+#include <cmsys/Process.h>
 #include <algorithm>
 
 #if defined(__HAIKU__)
@@ -316,6 +317,15 @@ int cmCPackGenerator::InstallProjectViaInstalledDirectories(
 {
   (void)setDestDir;
   (void)tempInstallDirectory;
+  std::string stagingMode = this->GetStagingMode();
+  if ( stagingMode.empty() )
+    {
+    return 0;
+    }
+  unsigned long stagedFiles = 0;
+  unsigned long upToDateFiles = 0;
+  double copiedBytes = 0;
+  double clonedBytes = 0;
   std::vector<cmsys::RegularExpression> ignoreFilesRegex;
   const char* cpackIgnoreFiles = this->GetOption("CPACK_IGNORE_FILES");
   if ( cpackIgnoreFiles )
@@ -408,16 +418,46 @@ int cmCPackGenerator::InstallProjectViaInstalledDirectories(
           symlinkedFiles.push_back(std::pair<std::string,
                                    std::string>(targetFile,inFileRelative));
           }
-        /* If it is not a symlink then do a plain copy */
-        else if (!(
-            cmSystemTools::CopyFileIfDifferent(inFile.c_str(),filePath.c_str())
-            &&
-            cmSystemTools::CopyFileTime(inFile.c_str(),filePath.c_str())
-                ) )
+        /* If it is not a symlink then clone it or do a plain copy */
+        else
           {
-          cmCPackLogger(cmCPackLog::LOG_ERROR, "Problem copying file: "
-            << inFile << " -> " << filePath << std::endl);
-          return 0;
+          /* Replace only a file that differs */
+          if ( !cmSystemTools::FilesDiffer(inFile.c_str(), filePath.c_str()) )
+            {
+            ++upToDateFiles;
+            continue;
+            }
+          bool cloned = false;
+          if ( stagingMode == "REFLINK" )
+            {
+            cmSystemTools::MakeDirectory(
+              cmSystemTools::GetFilenamePath(filePath).c_str());
+            cmSystemTools::RemoveFile(filePath.c_str());
+            cloned =
+              cmSystemTools::CloneFile(inFile.c_str(),filePath.c_str()) &&
+              cmSystemTools::CopyFileTime(inFile.c_str(),filePath.c_str());
+            }
+          if ( !cloned && !(
+              cmSystemTools::CopyFileAlways(inFile.c_str(), filePath.c_str())
+              &&
+              cmSystemTools::CopyFileTime(inFile.c_str(),filePath.c_str())
+                  ) )
+            {
+            cmCPackLogger(cmCPackLog::LOG_ERROR, "Problem copying file: "
+              << inFile << " -> " << filePath << std::endl);
+            return 0;
+            }
+          double size =
+            static_cast<double>(cmSystemTools::FileLength(inFile.c_str()));
+          ++stagedFiles;
+          if ( cloned )
+            {
+            clonedBytes += size;
+            }
+          else
+            {
+            copiedBytes += size;
+            }
           }
         }
       /* rebuild symlinks in the installed tree */
@@ -451,10 +491,43 @@ int cmCPackGenerator::InstallProjectViaInstalledDirectories(
         cmSystemTools::ChangeDirectory(curDir.c_str());
         }
       }
+    cmCPackLogger(cmCPackLog::LOG_VERBOSE, "Staged " << stagedFiles
+      << " files: " << copiedBytes / 1048576.0 << " MB copied, "
+      << clonedBytes / 1048576.0 << " MB cloned, "
+      << upToDateFiles << " files up-to-date" << std::endl);
     }
   return 1;
 }
 
+//----------------------------------------------------------------------
+std::string cmCPackGenerator::GetStagingMode()
+{
+  const char* mode = this->GetOption("CPACK_STAGING_MODE");
+  if ( !mode || !*mode )
+    {
+    return "COPY";
+    }
+  std::string stagingMode = cmSystemTools::UpperCase(mode);
+  if ( stagingMode == "HARDLINK" )
+    {
+    // Generators may modify the staged files in place, which would
+    // modify the original files through a hard link.
+    cmCPackLogger(cmCPackLog::LOG_ERROR,
+      "CPACK_STAGING_MODE HARDLINK is not supported because package "
+      "generators may modify the staged files.  Use REFLINK instead."
+      << std::endl);
+    return "";
+    }
+  if ( stagingMode != "COPY" && stagingMode != "REFLINK" )
+    {
+    cmCPackLogger(cmCPackLog::LOG_ERROR,
+      "CPACK_STAGING_MODE must be one of COPY or REFLINK, not: "
+      << mode << std::endl);
+    return "";
+    }
+  return stagingMode;
+}
+
 //----------------------------------------------------------------------
 int cmCPackGenerator::InstallProjectViaInstallScript(
   bool setDestDir, const std::string& tempInstallDirectory)
@@ -522,6 +595,232 @@ int cmCPackGenerator::InstallProjectViaInstallScript(
   return 1;
 }
 
+//----------------------------------------------------------------------
+// A component installation running in a child "cmake -P" process.
+class cmCPackGeneratorInstallJob
+{
+public:
+  cmCPackGeneratorInstallJob(): Process(0), ComponentInstall(false) {}
+  ~cmCPackGeneratorInstallJob()
+    {
+    if(this->Process)
+      {
+      cmsysProcess_Kill(this->Process);
+      cmsysProcess_Delete(this->Process);
+      }
+    }
+
+  bool Start(std::vector<std::string> const& args)
+    {
+    std::vector<const char*> argv;
+    for(std::vector<std::string>::const_iterator a = args.begin();
+        a != args.end(); ++a)
+      {
+      argv.push_back(a->c_str());
+      }
+    argv.push_back(0);
+    this->Process = cmsysProcess_New();
+    cmsysProcess_SetCommand(this->Process, &*argv.begin());
+    cmsysProcess_SetOption(this->Process,
+                           cmsysProcess_Option_HideWindow, 1);
+    cmsysProcess_Execute(this->Process);
+    return (cmsysProcess_GetState(this->Process) ==
+            cmsysProcess_State_Executing);
+    }
+
+  // Read whatever output is available without blocking.  Returns true
+  // once the process has finished.
+  bool Poll(bool& active)
+    {
+    for(;;)
+      {
+      char* data;
+      int length;
+      double timeout = 0;
+      int p = cmsysProcess_WaitForData(this->Process, &data, &length,
+                                       &timeout);
+      if(p == cmsysProcess_Pipe_Timeout)
+        {
+        return false;
+        }
+      active = true;
+      if(p == cmsysProcess_Pipe_None)
+        {
+        break;
+        }
+      this->Output.append(data, length);
+      }
+    cmsysProcess_WaitForExit(this->Process, 0);
+    return true;
+    }
+
+  bool Succeeded()
+    {
+    return (cmsysProcess_GetState(this->Process) ==
+            cmsysProcess_State_Exited &&
+            cmsysProcess_GetExitValue(this->Process) == 0);
+    }
+
+  cmsysProcess* Process;
+  std::string Component;
+  bool ComponentInstall;
+  std::string InstallPrefix;
+  std::vector<std::string> FilesBefore;
+  std::string AbsoluteFilesFile;
+  std::string Output;
+};
+
+//----------------------------------------------------------------------
+// Owns the install jobs still running and kills them if packaging
+// is aborted.
+class cmCPackGeneratorInstallJobs:
+  public std::vector<cmCPackGeneratorInstallJob*>
+{
+public:
+  ~cmCPackGeneratorInstallJobs()
+    {
+    for(iterator i = this->begin(); i != this->end(); ++i)
+      {
+      delete *i;
+      }
+    }
+};
+
+//----------------------------------------------------------------------
+int cmCPackGenerator::WaitForInstallJobs(cmCPackGeneratorInstallJobs& jobs,
+                                         size_t maxRunning,
+                                         std::string const& installPrefix,
+                                         std::string& absoluteDestFiles)
+{
+  for(;;)
+    {
+    // Components installed into the same directory are told apart by
+    // the files each one adds, so they may not be installed together.
+    bool busy = jobs.size() > maxRunning;
+    for(cmCPackGeneratorInstallJobs::iterator i = jobs.begin();
+        i != jobs.end(); ++i)
+      {
+      busy = busy || (*i)->InstallPrefix == installPrefix;
+      }
+    if(!busy)
+      {
+      return 1;
+      }
+
+    bool active = false;
+    for(size_t i = 0; i < jobs.size();)
+      {
+      cmCPackGeneratorInstallJob* job = jobs[i];
+      if(!job->Poll(active))
+        {
+        ++i;
+        continue;
+        }
+      jobs.erase(jobs.begin() + i);
+      cmsys::auto_ptr<cmCPackGeneratorInstallJob> finished(job);
+      cmCPackLogger(cmCPackLog::LOG_VERBOSE, job->Output);
+      if(!job->Succeeded())
+        {
+        cmCPackLogger(cmCPackLog::LOG_ERROR,
+                      "Problem installing component: " << job->Component
+                      << std::endl << job->Output << std::endl);
+        return 0;
+        }
+      std::string absoluteFiles;
+      cmsys::ifstream fin(job->AbsoluteFilesFile.c_str());
+      bool haveAbsoluteFiles = fin? true : false;
+      if(haveAbsoluteFiles)
+        {
+        cmSystemTools::GetLineFromStream(fin, absoluteFiles);
+        }
+      this->FinishComponentInstall(job->Component, job->ComponentInstall,
+                                   job->InstallPrefix, job->FilesBefore,
+                                   haveAbsoluteFiles?
+                                   absoluteFiles.c_str() : 0,
+                                   absoluteDestFiles);
+      }
+    if(!active)
+      {
+      cmSystemTools::Delay(10);
+      }
+    }
+}
+
+//----------------------------------------------------------------------
+void cmCPackGenerator::FinishComponentInstall(
+  std::string const& installComponent, bool componentInstall,
+  std::string const& installPrefix,
+  std::vector<std::string> const& filesBefore,
+  const char* absoluteFiles, std::string& absoluteDestFiles)
+{
+  const char* InstallPrefix = installPrefix.c_str();
+  std::string findExpr(InstallPrefix);
+  findExpr += "/*";
+
+  // Now rebuild the list of files after installation
+  // of the current component (if we are in component install)
+  if (componentInstall)
+    {
+    cmsys::Glob glA;
+    glA.RecurseOn();
+    glA.FindFiles(findExpr);
+    std::vector<std::string> filesAfter = glA.GetFiles();
+    std::sort(filesAfter.begin(),filesAfter.end());
+    std::vector<std::string>::iterator diff;
+    std::vector<std::string> result(filesAfter.size());
+    diff = std::set_difference (
+            filesAfter.begin(),filesAfter.end(),
+            filesBefore.begin(),filesBefore.end(),
+            result.begin());
+
+    std::vector<std::string>::iterator fit;
+    std::string localFileName;
+    // Populate the File field of each component
+    for (fit=result.begin();fit!=diff;++fit)
+      {
+      localFileName =
+          cmSystemTools::RelativePath(InstallPrefix, fit->c_str());
+      localFileName =
+          localFileName.substr(localFileName.find_first_not_of('/'),
+                               std::string::npos);
+      Components[installComponent].Files.push_back(localFileName);
+      cmCPackLogger(cmCPackLog::LOG_DEBUG, "Adding file <"
+                          <<localFileName<<"> to component <"
+                          <<installComponent<<">"<<std::endl);
+      }
+    }
+
+  if (NULL != absoluteFiles) {
+    if (absoluteDestFiles.length()>0) {
+      absoluteDestFiles +=";";
+    }
+    absoluteDestFiles += absoluteFiles;
+    cmCPackLogger(cmCPackLog::LOG_DEBUG,
+                              "Got some ABSOLUTE DESTINATION FILES: "
+                              << absoluteDestFiles << std::endl);
+    // define component specific var
+    if (componentInstall)
+      {
+      std::string absoluteDestFileComponent =
+          std::string("CPACK_ABSOLUTE_DESTINATION_FILES")
+          + "_" + GetComponentInstallDirNameSuffix(installComponent);
+      if (NULL != this->GetOption(absoluteDestFileComponent))
+        {
+          std::string absoluteDestFilesListComponent =
+              this->GetOption(absoluteDestFileComponent);
+          absoluteDestFilesListComponent +=";";
+          absoluteDestFilesListComponent += absoluteFiles;
+          this->SetOption(absoluteDestFileComponent,
+              absoluteDestFilesListComponent.c_str());
+        }
+      else
+        {
+        this->SetOption(absoluteDestFileComponent, absoluteFiles);
+        }
+      }
+  }
+}
+
 //----------------------------------------------------------------------
 int cmCPackGenerator::InstallProjectViaInstallCMakeProjects(
   bool setDestDir, const std::string& baseTempInstallDirectory)
@@ -531,6 +830,20 @@ int cmCPackGenerator::InstallProjectViaInstallCMakeProjects(
   const char* cmakeGenerator
     = this->GetOption("CPACK_CMAKE_GENERATOR");
   std::string absoluteDestFiles;
+  // Components may be installed by several child processes at once.
+  size_t installJobs = 1;
+  if (const char* jobsOption =
+      this->GetOption("CPACK_COMPONENTS_INSTALL_JOBS"))
+    {
+    int n = atoi(jobsOption);
+    installJobs = n > 1 ? static_cast<size_t>(n) : 1;
+    }
+  cmCPackGeneratorInstallJobs jobs;
+  std::string stagingMode = this->GetStagingMode();
+  if ( stagingMode.empty() )
+    {
+    return 0;
+    }
   if ( cmakeProjects && *cmakeProjects )
     {
     if ( !cmakeGenerator )
@@ -681,6 +994,7 @@ int cmCPackGenerator::InstallProjectViaInstallCMakeProjects(
         "- Install project: " << installProjectName << std::endl);
 
       // Run the installation for each component
+      bool parallel = componentInstall && installJobs > 1;
       std::vector<std::string>::iterator componentIt;
       for (componentIt = componentsVector.begin();
            componentIt != componentsVector.end();
@@ -841,6 +1155,18 @@ int cmCPackGenerator::InstallProjectViaInstallCMakeProjects(
           {
           mf->AddDefinition("CMAKE_INSTALL_DO_STRIP", "1");
           }
+        // Clone the installed files if possible.
+        if (stagingMode == "REFLINK")
+          {
+          mf->AddDefinition("CMAKE_INSTALL_REFLINK", "1");
+          }
+        if (parallel &&
+            !this->WaitForInstallJobs(jobs, installJobs - 1,
+                                      tempInstallDirectory,
+                                      absoluteDestFiles))
+          {
+          return 0;
+          }
         // Remember the list of files before installation
         // of the current component (if we are in component install)
         const char* InstallPrefix = tempInstallDirectory.c_str();
@@ -873,87 +1199,71 @@ int cmCPackGenerator::InstallProjectViaInstallCMakeProjects(
             mf->AddDefinition("CMAKE_ERROR_ON_ABSOLUTE_INSTALL_DESTINATION",
                               "1");
           }
-        // do installation
-        int res = mf->ReadListFile(0, installFile.c_str());
-        // forward definition of CMAKE_ABSOLUTE_DESTINATION_FILES
-        // to CPack (may be used by generators like CPack RPM or DEB)
-        // in order to transparently handle ABSOLUTE PATH
-        if (mf->GetDefinition("CMAKE_ABSOLUTE_DESTINATION_FILES"))
+        if (parallel)
           {
-            mf->AddDefinition("CPACK_ABSOLUTE_DESTINATION_FILES",
-                mf->GetDefinition("CMAKE_ABSOLUTE_DESTINATION_FILES"));
-          }
-
-        // Now rebuild the list of files after installation
-        // of the current component (if we are in component install)
-        if (componentInstall)
+          // Install the component in a child process.  A wrapper
+          // script sets the variables the install script would see if
+          // read here and reports the absolute destination files back.
+          cmsys::auto_ptr<cmCPackGeneratorInstallJob>
+            job(new cmCPackGeneratorInstallJob);
+          job->Component = installComponent;
+          job->ComponentInstall = componentInstall;
+          job->InstallPrefix = tempInstallDirectory;
+          job->FilesBefore = filesBefore;
+          std::string jobBase = this->GetOption("CPACK_TOPLEVEL_DIRECTORY");
+          jobBase += "/InstallComponent-" + installComponent;
+          job->AbsoluteFilesFile = jobBase + "-absolute.txt";
+          cmSystemTools::RemoveFile(job->AbsoluteFilesFile.c_str());
+          std::string script = jobBase + ".cmake";
           {
-          cmsys::Glob glA;
-          glA.RecurseOn();
-          glA.FindFiles(findExpr);
-          std::vector<std::string> filesAfter = glA.GetFiles();
-          std::sort(filesAfter.begin(),filesAfter.end());
-          std::vector<std::string>::iterator diff;
-          std::vector<std::string> result(filesAfter.size());
-          diff = std::set_difference (
-                  filesAfter.begin(),filesAfter.end(),
-                  filesBefore.begin(),filesBefore.end(),
-                  result.begin());
-
-          std::vector<std::string>::iterator fit;
-          std::string localFileName;
-          // Populate the File field of each component
-          for (fit=result.begin();fit!=diff;++fit)
+          cmGeneratedFileStream fout(script.c_str());
+          std::vector<std::string> vars = mf->GetDefinitions();
+          for(std::vector<std::string>::const_iterator vi = vars.begin();
+              vi != vars.end(); ++vi)
             {
-            localFileName =
-                cmSystemTools::RelativePath(InstallPrefix, fit->c_str());
-            localFileName =
-                localFileName.substr(localFileName.find_first_not_of('/'),
-                                     std::string::npos);
-            Components[installComponent].Files.push_back(localFileName);
-            cmCPackLogger(cmCPackLog::LOG_DEBUG, "Adding file <"
-                                <<localFileName<<"> to component <"
-                                <<installComponent<<">"<<std::endl);
+            fout << "set(" << cmLocalGenerator::EscapeForCMake(*vi) << " "
+                 << cmLocalGenerator::EscapeForCMake(
+                      mf->GetSafeDefinition(*vi)) << ")\n";
             }
+          fout << "include(\"" << installFile << "\")\n"
+               << "if(DEFINED CMAKE_ABSOLUTE_DESTINATION_FILES)\n"
+               << "  file(WRITE \"" << job->AbsoluteFilesFile
+               << "\" \"${CMAKE_ABSOLUTE_DESTINATION_FILES}\")\n"
+               << "endif()\n";
           }
-
-        if (NULL !=mf->GetDefinition("CPACK_ABSOLUTE_DESTINATION_FILES")) {
-          if (absoluteDestFiles.length()>0) {
-            absoluteDestFiles +=";";
-          }
-          absoluteDestFiles +=
-            mf->GetDefinition("CPACK_ABSOLUTE_DESTINATION_FILES");
-          cmCPackLogger(cmCPackLog::LOG_DEBUG,
-                                    "Got some ABSOLUTE DESTINATION FILES: "
-                                    << absoluteDestFiles << std::endl);
-          // define component specific var
-          if (componentInstall)
+          std::vector<std::string> args;
+          args.push_back(cmSystemTools::GetCMakeCommand());
+          args.push_back("-P");
+          args.push_back(script);
+          cmCPackLogger(cmCPackLog::LOG_DEBUG, "- Install command: "
+                        << cmSystemTools::PrintSingleCommand(args)
+                        << std::endl);
+          if (!job->Start(args))
             {
-            std::string absoluteDestFileComponent =
-                std::string("CPACK_ABSOLUTE_DESTINATION_FILES")
-                + "_" + GetComponentInstallDirNameSuffix(installComponent);
-            if (NULL != this->GetOption(absoluteDestFileComponent))
-              {
-                std::string absoluteDestFilesListComponent =
-                    this->GetOption(absoluteDestFileComponent);
-                absoluteDestFilesListComponent +=";";
-                absoluteDestFilesListComponent +=
-                    mf->GetDefinition("CPACK_ABSOLUTE_DESTINATION_FILES");
-                this->SetOption(absoluteDestFileComponent,
-                    absoluteDestFilesListComponent.c_str());
-              }
-            else
-              {
-              this->SetOption(absoluteDestFileComponent,
-                  mf->GetDefinition("CPACK_ABSOLUTE_DESTINATION_FILES"));
-              }
+            cmCPackLogger(cmCPackLog::LOG_ERROR,
+                          "Problem starting install of component: "
+                          << installComponent << std::endl);
+            return 0;
             }
-        }
+          jobs.push_back(job.release());
+          continue;
+          }
+        // do installation
+        int res = mf->ReadListFile(0, installFile.c_str());
+        this->FinishComponentInstall(installComponent, componentInstall,
+          tempInstallDirectory, filesBefore,
+          mf->GetDefinition("CMAKE_ABSOLUTE_DESTINATION_FILES"),
+          absoluteDestFiles);
         if ( cmSystemTools::GetErrorOccuredFlag() || !res )
           {
           return 0;
           }
         }
+      // Later projects may install into the same directories.
+      if (!this->WaitForInstallJobs(jobs, 0, "", absoluteDestFiles))
+        {
+        return 0;
+        }
       }
     }
   this->SetOption("CPACK_ABSOLUTE_DESTINATION_FILES",
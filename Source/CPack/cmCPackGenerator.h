@@ -47,6 +47,7 @@
 
 class cmMakefile;
 class cmCPackLog;
+class cmCPackGeneratorInstallJobs;
 
 /** \class cmCPackGenerator
  * \brief A superclass of all CPack Generators
@@ -198,6 +199,20 @@ protected:
     bool setDestDir, const std::string& tempInstallDirectory);
   virtual int InstallProjectViaInstallCMakeProjects(
     bool setDestDir, const std::string& tempInstallDirectory);
+  /**
+   * Return how files are staged as given by CPACK_STAGING_MODE:
+   * COPY or REFLINK.  Returns an empty string on error.
+   */
+  std::string GetStagingMode();
+  int WaitForInstallJobs(cmCPackGeneratorInstallJobs& jobs,
+                         size_t maxRunning, std::string const& installPrefix,
+                         std::string& absoluteDestFiles);
+  void FinishComponentInstall(std::string const& installComponent,
+                              bool componentInstall,
+                              std::string const& installPrefix,
+                              std::vector<std::string> const& filesBefore,
+                              const char* absoluteFiles,
+                              std::string& absoluteDestFiles);
 
   /**
    * The various level of support of
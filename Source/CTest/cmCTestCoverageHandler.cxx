@@ -20,6 +20,8 @@
 #include "cmSystemTools.h"
 #include "cmGeneratedFileStream.h"
 #include "cmXMLSafe.h"
+#include "cmCryptoHash.h"
+#include "cmVersion.h"
 
 #include <cmsys/Process.h>
 #include <cmsys/RegularExpression.hxx>
@@ -415,6 +417,11 @@ int cmCTestCoverageHandler::ProcessHandler()
     return error;
     }
 
+  double report_time_start = cmSystemTools::GetTime();
+  cmCTestLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
+    "   Collected coverage data in "
+    << (report_time_start - elapsed_time_start) << " sec" << std::endl);
+
   std::set<std::string> uncovered = this->FindUncoveredFiles(&cont);
 
   if ( file_count == 0 )
@@ -684,6 +691,10 @@ int cmCTestCoverageHandler::ProcessHandler()
     << "</Coverage>" << std::endl;
   this->CTest->EndXML(covSumFile);
 
+  cmCTestLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
+    "   Wrote coverage report in "
+    << (cmSystemTools::GetTime() - report_time_start) << " sec" << std::endl);
+
   cmCTestLog(this->CTest, HANDLER_OUTPUT, "" << std::endl
     << "\tCovered LOC:         "
     << total_tested << std::endl
@@ -871,6 +882,322 @@ struct cmCTestCoverageHandlerLocale
   std::string lc_all;
 };
 
+//----------------------------------------------------------------------
+// State carried across the output of all gcov runs.
+class cmCTestCoverageHandlerGCovParser
+{
+public:
+  cmCTestCoverageHandlerGCovParser():
+    // Style 1
+    st1re1("[0-9]+\\.[0-9]+% of [0-9]+ (source |)lines executed in file "
+           "(.*)$"),
+    st1re2("^Creating (.*\\.gcov)\\."),
+    // Style 2
+    st2re1("^File *[`'](.*)'$"),
+    st2re2("Lines executed: *[0-9]+\\.[0-9]+% of [0-9]+$"),
+    st2re3("^(.*)reating [`'](.*\\.gcov)'"),
+    st2re4("^(.*):unexpected EOF *$"),
+    st2re5("^(.*):cannot open source file*$"),
+    st2re6("^(.*):source file is newer than graph file `(.*)'$"),
+    GCovStyle(0) {}
+  cmsys::RegularExpression st1re1;
+  cmsys::RegularExpression st1re2;
+  cmsys::RegularExpression st2re1;
+  cmsys::RegularExpression st2re2;
+  cmsys::RegularExpression st2re3;
+  cmsys::RegularExpression st2re4;
+  cmsys::RegularExpression st2re5;
+  cmsys::RegularExpression st2re6;
+  int GCovStyle;
+  std::set<std::string> MissingFiles;
+};
+
+//----------------------------------------------------------------------
+// Line counts contributed by one coverage data file, per source file.
+struct cmCTestCoverageHandlerGCovEntry
+{
+  typedef cmCTestCoverageHandlerContainer::SingleFileCoverageVector
+    SingleFileCoverageVector;
+  typedef std::vector<std::pair<std::string, SingleFileCoverageVector> >
+    FileCoverageVector;
+  std::string Hash;
+  FileCoverageVector Files;
+  // Content hash of each of the Files when the counts were taken.
+  std::vector<std::string> SourceHashes;
+};
+typedef std::map<std::string, cmCTestCoverageHandlerGCovEntry>
+  cmCTestCoverageHandlerGCovCache;
+
+//----------------------------------------------------------------------
+// Hash the content of a source file once per run.
+static std::string const& cmCTestCoverageHandlerSourceHash(
+  cmCryptoHashMD5& md5, std::map<std::string, std::string>& hashes,
+  std::string const& file)
+{
+  std::map<std::string, std::string>::iterator i = hashes.find(file);
+  if(i == hashes.end())
+    {
+    i = hashes.insert(std::make_pair(file, md5.HashFile(file))).first;
+    }
+  return i->second;
+}
+
+//----------------------------------------------------------------------
+static void cmCTestCoverageHandlerMerge(
+  cmCTestCoverageHandlerContainer* cont, std::string const& sourceFile,
+  cmCTestCoverageHandlerContainer::SingleFileCoverageVector const& fcov)
+{
+  cmCTestCoverageHandlerContainer::SingleFileCoverageVector& vec
+    = cont->TotalCoverage[sourceFile];
+  if(vec.size() < fcov.size())
+    {
+    vec.resize(fcov.size(), -1);
+    }
+  for(size_t i = 0; i < fcov.size(); ++i)
+    {
+    // Entries of -1 are lines without coverage information.
+    if(fcov[i] >= 0)
+      {
+      vec[i] = (vec[i] < 0 ? 0 : vec[i]) + fcov[i];
+      }
+    }
+}
+
+//----------------------------------------------------------------------
+static void cmCTestCoverageHandlerMerge(
+  cmCTestCoverageHandlerContainer* cont,
+  cmCTestCoverageHandlerGCovEntry const& entry)
+{
+  for(cmCTestCoverageHandlerGCovEntry::FileCoverageVector::const_iterator
+        fi = entry.Files.begin(); fi != entry.Files.end(); ++fi)
+    {
+    cmCTestCoverageHandlerMerge(cont, fi->first, fi->second);
+    }
+}
+
+//----------------------------------------------------------------------
+// The cache of gcov results from the previous run is a text file with a
+// header identifying the tree, then one record per coverage data file:
+//   <data file>\n<hash>\n<count>\n
+// followed by <count> source file records with its content hash and
+// line counts:
+//   <source file>\n<hash>\n<size> <count0> <count1> ...\n
+static std::string cmCTestCoverageHandlerGCovCacheHeader(
+  cmCTestCoverageHandlerContainer* cont)
+{
+  return std::string("CTestGCovCache-2\n") +
+    cmVersion::GetCMakeVersion() + "\n" +
+    cont->SourceDir + "\n" + cont->BinaryDir + "\n";
+}
+
+//----------------------------------------------------------------------
+static void cmCTestCoverageHandlerReadGCovCache(
+  std::string const& fname, cmCTestCoverageHandlerContainer* cont,
+  cmCTestCoverageHandlerGCovCache& cache)
+{
+  cmsys::ifstream fin(fname.c_str());
+  if(!fin)
+    {
+    return;
+    }
+  std::string header;
+  std::string line;
+  for(int i = 0; i < 4 && cmSystemTools::GetLineFromStream(fin, line); ++i)
+    {
+    header += line + "\n";
+    }
+  if(header != cmCTestCoverageHandlerGCovCacheHeader(cont))
+    {
+    return;
+    }
+  std::string dataFile;
+  while(cmSystemTools::GetLineFromStream(fin, dataFile))
+    {
+    cmCTestCoverageHandlerGCovEntry entry;
+    size_t count = 0;
+    if(!cmSystemTools::GetLineFromStream(fin, entry.Hash) ||
+       !cmSystemTools::GetLineFromStream(fin, line) ||
+       !(std::istringstream(line) >> count))
+      {
+      cache.clear();
+      return;
+      }
+    for(size_t i = 0; i < count; ++i)
+      {
+      std::string sourceFile;
+      std::string sourceHash;
+      size_t size = 0;
+      if(!cmSystemTools::GetLineFromStream(fin, sourceFile) ||
+         !cmSystemTools::GetLineFromStream(fin, sourceHash) ||
+         !cmSystemTools::GetLineFromStream(fin, line))
+        {
+        cache.clear();
+        return;
+        }
+      std::istringstream counts(line);
+      if(!(counts >> size))
+        {
+        cache.clear();
+        return;
+        }
+      entry.Files.push_back(cmCTestCoverageHandlerGCovEntry::
+        FileCoverageVector::value_type(sourceFile,
+        cmCTestCoverageHandlerGCovEntry::SingleFileCoverageVector(size)));
+      entry.SourceHashes.push_back(sourceHash);
+      cmCTestCoverageHandlerGCovEntry::SingleFileCoverageVector& fcov =
+        entry.Files.back().second;
+      for(size_t j = 0; j < size; ++j)
+        {
+        if(!(counts >> fcov[j]))
+          {
+          cache.clear();
+          return;
+          }
+        }
+      }
+    cache[dataFile] = entry;
+    }
+}
+
+//----------------------------------------------------------------------
+static void cmCTestCoverageHandlerWriteGCovCache(
+  std::string const& fname, cmCTestCoverageHandlerContainer* cont,
+  cmCTestCoverageHandlerGCovCache const& cache)
+{
+  cmGeneratedFileStream fout(fname.c_str(), true);
+  fout << cmCTestCoverageHandlerGCovCacheHeader(cont);
+  for(cmCTestCoverageHandlerGCovCache::const_iterator ci = cache.begin();
+      ci != cache.end(); ++ci)
+    {
+    cmCTestCoverageHandlerGCovEntry const& entry = ci->second;
+    fout << ci->first << "\n" << entry.Hash << "\n"
+         << entry.Files.size() << "\n";
+    for(size_t f = 0; f < entry.Files.size(); ++f)
+      {
+      cmCTestCoverageHandlerGCovEntry::SingleFileCoverageVector const&
+        fcov = entry.Files[f].second;
+      fout << entry.Files[f].first << "\n" << entry.SourceHashes[f] << "\n"
+           << fcov.size();
+      for(size_t i = 0; i < fcov.size(); ++i)
+        {
+        fout << " " << fcov[i];
+        }
+      fout << "\n";
+      }
+    }
+}
+
+//----------------------------------------------------------------------
+// One gcov process running in its own working directory.
+class cmCTestCoverageHandlerGCovJob
+{
+public:
+  cmCTestCoverageHandlerGCovJob(): Process(0), Result(0), ExitValue(0) {}
+  ~cmCTestCoverageHandlerGCovJob()
+    {
+    if(this->Process)
+      {
+      cmsysProcess_Delete(this->Process);
+      }
+    }
+
+  void Start(std::string const& file, std::string const& command)
+    {
+    this->File = file;
+    this->Command = command;
+    this->Output = "";
+    this->Errors = "";
+    this->Coverage.Files.clear();
+    this->Coverage.SourceHashes.clear();
+    this->Result = 0;
+    this->ExitValue = 0;
+    std::vector<std::string> args =
+      cmSystemTools::ParseArguments(command.c_str());
+    std::vector<const char*> argv;
+    for(std::vector<std::string>::const_iterator a = args.begin();
+        a != args.end(); ++a)
+      {
+      argv.push_back(a->c_str());
+      }
+    argv.push_back(0);
+    this->Process = cmsysProcess_New();
+    cmsysProcess_SetCommand(this->Process, &*argv.begin());
+    cmsysProcess_SetWorkingDirectory(this->Process,
+                                     this->Directory.c_str());
+    if(cmSystemTools::GetRunCommandHideConsole())
+      {
+      cmsysProcess_SetOption(this->Process,
+                             cmsysProcess_Option_HideWindow, 1);
+      }
+    cmsysProcess_Execute(this->Process);
+    }
+
+  bool IsRunning() const { return this->Process != 0; }
+
+  // Read whatever output is available without blocking.  Returns true
+  // once the process has finished; the results are then available.
+  bool Poll(bool& active)
+    {
+    for(;;)
+      {
+      char* data;
+      int length;
+      double timeout = 0;
+      int p = cmsysProcess_WaitForData(this->Process, &data, &length,
+                                       &timeout);
+      if(p == cmsysProcess_Pipe_Timeout)
+        {
+        return false;
+        }
+      active = true;
+      if(p == cmsysProcess_Pipe_STDOUT)
+        {
+        this->Output.append(data, length);
+        }
+      else if(p == cmsysProcess_Pipe_STDERR)
+        {
+        this->Errors.append(data, length);
+        }
+      else
+        {
+        break;
+        }
+      }
+    cmsysProcess_WaitForExit(this->Process, 0);
+    this->Result = 1;
+    switch(cmsysProcess_GetState(this->Process))
+      {
+      case cmsysProcess_State_Exited:
+        this->ExitValue = cmsysProcess_GetExitValue(this->Process);
+        break;
+      case cmsysProcess_State_Exception:
+        this->Errors += cmsysProcess_GetExceptionString(this->Process);
+        this->Result = 0;
+        break;
+      case cmsysProcess_State_Error:
+        this->Errors += cmsysProcess_GetErrorString(this->Process);
+        this->Result = 0;
+        break;
+      default:
+        this->Result = 0;
+        break;
+      }
+    cmsysProcess_Delete(this->Process);
+    this->Process = 0;
+    return true;
+    }
+
+  cmsysProcess* Process;
+  std::string Directory;
+  std::string File;
+  std::string Command;
+  std::string Output;
+  std::string Errors;
+  int Result;
+  int ExitValue;
+  cmCTestCoverageHandlerGCovEntry Coverage;
+};
+
 //----------------------------------------------------------------------
 int cmCTestCoverageHandler::HandleGCovCoverage(
   cmCTestCoverageHandlerContainer* cont)
@@ -893,33 +1220,8 @@ int cmCTestCoverageHandler::HandleGCovCoverage(
     return 0;
     }
 
-  // Style 1
-  std::string st1gcovOutputRex1
-    = "[0-9]+\\.[0-9]+% of [0-9]+ (source |)lines executed in file (.*)$";
-  std::string st1gcovOutputRex2 = "^Creating (.*\\.gcov)\\.";
-  cmsys::RegularExpression st1re1(st1gcovOutputRex1.c_str());
-  cmsys::RegularExpression st1re2(st1gcovOutputRex2.c_str());
-
-
-  // Style 2
-  std::string st2gcovOutputRex1 = "^File *[`'](.*)'$";
-  std::string st2gcovOutputRex2
-    = "Lines executed: *[0-9]+\\.[0-9]+% of [0-9]+$";
-  std::string st2gcovOutputRex3 = "^(.*)reating [`'](.*\\.gcov)'";
-  std::string st2gcovOutputRex4 = "^(.*):unexpected EOF *$";
-  std::string st2gcovOutputRex5 = "^(.*):cannot open source file*$";
-  std::string st2gcovOutputRex6
-    = "^(.*):source file is newer than graph file `(.*)'$";
-  cmsys::RegularExpression st2re1(st2gcovOutputRex1.c_str());
-  cmsys::RegularExpression st2re2(st2gcovOutputRex2.c_str());
-  cmsys::RegularExpression st2re3(st2gcovOutputRex3.c_str());
-  cmsys::RegularExpression st2re4(st2gcovOutputRex4.c_str());
-  cmsys::RegularExpression st2re5(st2gcovOutputRex5.c_str());
-  cmsys::RegularExpression st2re6(st2gcovOutputRex6.c_str());
-
   std::vector<std::string> files;
   this->FindGCovFiles(files);
-  std::vector<std::string>::iterator it;
 
   if ( files.size() == 0 )
     {
@@ -936,11 +1238,8 @@ int cmCTestCoverageHandler::HandleGCovCoverage(
   cmSystemTools::MakeDirectory(tempDir.c_str());
   cmSystemTools::ChangeDirectory(tempDir.c_str());
 
-  int gcovStyle = 0;
-
-  std::set<std::string> missingFiles;
+  cmCTestCoverageHandlerGCovParser parser;
 
-  std::string actualSourceFile = "";
   cmCTestLog(this->CTest, HANDLER_OUTPUT,
     "   Processing coverage (each . represents one file):" << std::endl);
   cmCTestLog(this->CTest, HANDLER_OUTPUT, "    ");
@@ -954,359 +1253,518 @@ int cmCTestCoverageHandler::HandleGCovCoverage(
   // These are binary files that you give as input to gcov so that it will
   // give us text output we can analyze to summarize coverage.
   //
-  for ( it = files.begin(); it != files.end(); ++ it )
-    {
-    cmCTestLog(this->CTest, HANDLER_OUTPUT, "." << std::flush);
-
-    // Call gcov to get coverage data for this *.gcda file:
-    //
-    std::string fileDir = cmSystemTools::GetFilenamePath(*it);
+  // The line counts gcov reported for each of them on the last run are
+  // cached.  A data file whose content, notes file, gcov command and
+  // source files did not change since contributes its cached counts
+  // without running gcov.
+  double startTime = cmSystemTools::GetTime();
+  std::string cacheFile = tempDir + "/GCovCache.txt";
+  cmCTestCoverageHandlerGCovCache cache;
+  cmCTestCoverageHandlerGCovCache newCache;
+  cmCTestCoverageHandlerReadGCovCache(cacheFile, cont, cache);
+  cmCryptoHashMD5 md5;
+  std::map<std::string, std::string> sourceHashes;
+  std::vector<std::string> pendingFiles;
+  std::vector<std::string> pendingCommands;
+  std::vector<std::string> pendingHashes;
+  for ( std::vector<std::string>::const_iterator fit = files.begin();
+        fit != files.end(); ++fit )
+    {
+    std::string fileDir = cmSystemTools::GetFilenamePath(*fit);
     std::string command = "\"" + gcovCommand + "\" " +
       gcovExtraFlags + " " +
       "-o \"" + fileDir + "\" " +
-      "\"" + *it + "\"";
-
-    cmCTestLog(this->CTest, HANDLER_VERBOSE_OUTPUT, command.c_str()
-      << std::endl);
+      "\"" + *fit + "\"";
+    std::string notesFile =
+      cmSystemTools::GetFilenameWithoutLastExtension(*fit) + ".gcno";
+    std::string hash = md5.HashString(command + "\n" +
+      md5.HashFile(*fit) + "\n" +
+      md5.HashFile(fileDir + "/" + notesFile));
+
+    cmCTestCoverageHandlerGCovCache::const_iterator ci = cache.find(*fit);
+    bool changed = ci == cache.end() || ci->second.Hash != hash;
+    for ( size_t f = 0; !changed && f < ci->second.Files.size(); ++f )
+      {
+      changed = ci->second.SourceHashes[f] !=
+        cmCTestCoverageHandlerSourceHash(md5, sourceHashes,
+                                         ci->second.Files[f].first);
+      }
+    if ( changed )
+      {
+      pendingFiles.push_back(*fit);
+      pendingCommands.push_back(command);
+      pendingHashes.push_back(hash);
+      continue;
+      }
+    *cont->OFS << "* Use cached coverage for: " << *fit << std::endl;
+    cmCTestCoverageHandlerMerge(cont, ci->second);
+    newCache.insert(*ci);
 
-    std::string output = "";
-    std::string errors = "";
-    int retVal = 0;
-    *cont->OFS << "* Run coverage for: " << fileDir << std::endl;
-    *cont->OFS << "  Command: " << command << std::endl;
-    int res = this->CTest->RunCommand(command.c_str(), &output, &errors,
-      &retVal, tempDir.c_str(), 0 /*this->TimeOut*/);
+    cmCTestLog(this->CTest, HANDLER_OUTPUT, "." << std::flush);
+    file_count++;
 
-    *cont->OFS << "  Output: " << output << std::endl;
-    *cont->OFS << "  Errors: " << errors << std::endl;
-    if ( ! res )
+    if ( file_count % 50 == 0 )
       {
-      cmCTestLog(this->CTest, ERROR_MESSAGE,
-        "Problem running coverage on file: " << *it << std::endl);
-      cmCTestLog(this->CTest, ERROR_MESSAGE,
-        "Command produced error: " << errors << std::endl);
-      cont->Error ++;
-      continue;
+      cmCTestLog(this->CTest, HANDLER_OUTPUT, " processed: " << file_count
+        << " out of " << files.size() << std::endl);
+      cmCTestLog(this->CTest, HANDLER_OUTPUT, "    ");
       }
-    if ( retVal != 0 )
+    }
+  int cached_count = file_count;
+
+  // Run up to the parallel level of gcov processes at once.  gcov
+  // writes its .gcov files to the working directory, so each job slot
+  // gets a directory of its own.  The output of a finished job is
+  // parsed while the others keep running.
+  size_t parallelLevel = this->CTest->GetParallelLevel() > 1 ?
+    static_cast<size_t>(this->CTest->GetParallelLevel()) : 1;
+  if ( parallelLevel > pendingFiles.size() )
+    {
+    parallelLevel = pendingFiles.size();
+    }
+  std::vector<cmCTestCoverageHandlerGCovJob> jobs(parallelLevel);
+  for ( size_t slot = 0; slot < jobs.size(); ++slot )
+    {
+    jobs[slot].Directory = tempDir;
+    if ( parallelLevel > 1 )
       {
-      cmCTestLog(this->CTest, ERROR_MESSAGE, "Coverage command returned: "
-        << retVal << " while processing: " << *it << std::endl);
-      cmCTestLog(this->CTest, ERROR_MESSAGE,
-        "Command produced error: " << cont->Error << std::endl);
+      cmOStringStream slotDir;
+      slotDir << tempDir << "/" << slot;
+      jobs[slot].Directory = slotDir.str();
+      cmSystemTools::MakeDirectory(jobs[slot].Directory.c_str());
       }
-    cmCTestLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
-      "--------------------------------------------------------------"
-      << std::endl
-      << output << std::endl
-      << "--------------------------------------------------------------"
-      << std::endl);
+    }
 
-    std::vector<std::string> lines;
-    std::vector<std::string>::iterator line;
+  double gcovTime = cmSystemTools::GetTime();
+  double parseTime = 0;
+  size_t next = 0;
+  size_t running = 0;
+  while ( next < pendingFiles.size() || running > 0 )
+    {
+    bool active = false;
+    for ( size_t slot = 0; slot < jobs.size(); ++slot )
+      {
+      cmCTestCoverageHandlerGCovJob& job = jobs[slot];
+      if ( !job.IsRunning() && next < pendingFiles.size() )
+        {
+        // Call gcov to get coverage data for this *.gcda file:
+        //
+        std::string const& command = pendingCommands[next];
+        cmCTestLog(this->CTest, HANDLER_VERBOSE_OUTPUT, command.c_str()
+          << std::endl);
+        job.Start(pendingFiles[next], command);
+        job.Coverage.Hash = pendingHashes[next];
+        ++next;
+        ++running;
+        active = true;
+        }
+      if ( !job.IsRunning() || !job.Poll(active) )
+        {
+        continue;
+        }
+      --running;
 
-    cmSystemTools::Split(output.c_str(), lines);
+      cmCTestLog(this->CTest, HANDLER_OUTPUT, "." << std::flush);
+      double parseStart = cmSystemTools::GetTime();
+      if ( this->HandleGCovJob(cont, parser, job) )
+        {
+        for ( size_t f = 0; f < job.Coverage.Files.size(); ++f )
+          {
+          job.Coverage.SourceHashes.push_back(
+            cmCTestCoverageHandlerSourceHash(md5, sourceHashes,
+                                             job.Coverage.Files[f].first));
+          }
+        newCache[job.File] = job.Coverage;
+        }
+      parseTime += cmSystemTools::GetTime() - parseStart;
 
-    for ( line = lines.begin(); line != lines.end(); ++line)
+      file_count++;
+
+      if ( file_count % 50 == 0 )
+        {
+        cmCTestLog(this->CTest, HANDLER_OUTPUT, " processed: " << file_count
+          << " out of " << files.size() << std::endl);
+        cmCTestLog(this->CTest, HANDLER_OUTPUT, "    ");
+        }
+      }
+    if ( !active )
       {
-      std::string sourceFile;
-      std::string gcovFile;
+      cmSystemTools::Delay(5);
+      }
+    }
 
-      cmCTestLog(this->CTest, DEBUG, "Line: [" << *line << "]"
-        << std::endl);
+  cmCTestCoverageHandlerWriteGCovCache(cacheFile, cont, newCache);
 
-      if ( line->size() == 0 )
+  double endTime = cmSystemTools::GetTime();
+  cmCTestLog(this->CTest, HANDLER_VERBOSE_OUTPUT, std::endl
+    << "   Used cached coverage for " << cached_count << " files in "
+    << (gcovTime - startTime) << " sec" << std::endl
+    << "   Ran gcov on " << (file_count - cached_count) << " files using "
+    << parallelLevel << " processes in "
+    << (endTime - gcovTime) << " sec, "
+    << parseTime << " sec of which parsing its output" << std::endl);
+
+  cmSystemTools::ChangeDirectory(currentDirectory.c_str());
+  return file_count;
+}
+
+//----------------------------------------------------------------------
+bool cmCTestCoverageHandler::HandleGCovJob(
+  cmCTestCoverageHandlerContainer* cont,
+  cmCTestCoverageHandlerGCovParser& parser,
+  cmCTestCoverageHandlerGCovJob& job)
+{
+  std::string fileDir = cmSystemTools::GetFilenamePath(job.File);
+  std::string const& output = job.Output;
+  std::string const& errors = job.Errors;
+  *cont->OFS << "* Run coverage for: " << fileDir << std::endl;
+  *cont->OFS << "  Command: " << job.Command << std::endl;
+  *cont->OFS << "  Output: " << output << std::endl;
+  *cont->OFS << "  Errors: " << errors << std::endl;
+  if ( ! job.Result )
+    {
+    cmCTestLog(this->CTest, ERROR_MESSAGE,
+      "Problem running coverage on file: " << job.File << std::endl);
+    cmCTestLog(this->CTest, ERROR_MESSAGE,
+      "Command produced error: " << errors << std::endl);
+    cont->Error ++;
+    return false;
+    }
+  if ( job.ExitValue != 0 )
+    {
+    cmCTestLog(this->CTest, ERROR_MESSAGE, "Coverage command returned: "
+      << job.ExitValue << " while processing: " << job.File << std::endl);
+    cmCTestLog(this->CTest, ERROR_MESSAGE,
+      "Command produced error: " << cont->Error << std::endl);
+    }
+  cmCTestLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
+    "--------------------------------------------------------------"
+    << std::endl
+    << output << std::endl
+    << "--------------------------------------------------------------"
+    << std::endl);
+
+  cmsys::RegularExpression& st1re1 = parser.st1re1;
+  cmsys::RegularExpression& st1re2 = parser.st1re2;
+  cmsys::RegularExpression& st2re1 = parser.st2re1;
+  cmsys::RegularExpression& st2re2 = parser.st2re2;
+  cmsys::RegularExpression& st2re3 = parser.st2re3;
+  cmsys::RegularExpression& st2re4 = parser.st2re4;
+  cmsys::RegularExpression& st2re5 = parser.st2re5;
+  cmsys::RegularExpression& st2re6 = parser.st2re6;
+  int& gcovStyle = parser.GCovStyle;
+  std::set<std::string>& missingFiles = parser.MissingFiles;
+
+  // Only a clean run is worth caching.
+  bool complete = job.ExitValue == 0;
+  int error = cont->Error;
+
+  std::string actualSourceFile = "";
+  std::vector<std::string> lines;
+  std::vector<std::string>::iterator line;
+
+  cmSystemTools::Split(output.c_str(), lines);
+
+  for ( line = lines.begin(); line != lines.end(); ++line)
+    {
+    std::string sourceFile;
+    std::string gcovFile;
+
+    cmCTestLog(this->CTest, DEBUG, "Line: [" << *line << "]"
+      << std::endl);
+
+    if ( line->size() == 0 )
+      {
+      // Ignore empty line; probably style 2
+      }
+    else if ( st1re1.find(line->c_str()) )
+      {
+      if ( gcovStyle == 0 )
         {
-        // Ignore empty line; probably style 2
+        gcovStyle = 1;
         }
-      else if ( st1re1.find(line->c_str()) )
+      if ( gcovStyle != 1 )
         {
-        if ( gcovStyle == 0 )
-          {
-          gcovStyle = 1;
-          }
-        if ( gcovStyle != 1 )
-          {
-          cmCTestLog(this->CTest, ERROR_MESSAGE, "Unknown gcov output style e1"
-            << std::endl);
-          cont->Error ++;
-          break;
-          }
+        cmCTestLog(this->CTest, ERROR_MESSAGE, "Unknown gcov output style e1"
+          << std::endl);
+        cont->Error ++;
+        break;
+        }
 
-        actualSourceFile = "";
-        sourceFile = st1re1.match(2);
+      actualSourceFile = "";
+      sourceFile = st1re1.match(2);
+      }
+    else if ( st1re2.find(line->c_str() ) )
+      {
+      if ( gcovStyle == 0 )
+        {
+        gcovStyle = 1;
         }
-      else if ( st1re2.find(line->c_str() ) )
+      if ( gcovStyle != 1 )
         {
-        if ( gcovStyle == 0 )
-          {
-          gcovStyle = 1;
-          }
-        if ( gcovStyle != 1 )
-          {
-          cmCTestLog(this->CTest, ERROR_MESSAGE, "Unknown gcov output style e2"
-            << std::endl);
-          cont->Error ++;
-          break;
-          }
+        cmCTestLog(this->CTest, ERROR_MESSAGE, "Unknown gcov output style e2"
+          << std::endl);
+        cont->Error ++;
+        break;
+        }
 
-        gcovFile = st1re2.match(1);
+      gcovFile = st1re2.match(1);
+      }
+    else if ( st2re1.find(line->c_str() ) )
+      {
+      if ( gcovStyle == 0 )
+        {
+        gcovStyle = 2;
         }
-      else if ( st2re1.find(line->c_str() ) )
+      if ( gcovStyle != 2 )
         {
-        if ( gcovStyle == 0 )
-          {
-          gcovStyle = 2;
-          }
-        if ( gcovStyle != 2 )
-          {
-          cmCTestLog(this->CTest, ERROR_MESSAGE, "Unknown gcov output style e3"
-            << std::endl);
-          cont->Error ++;
-          break;
-          }
+        cmCTestLog(this->CTest, ERROR_MESSAGE, "Unknown gcov output style e3"
+          << std::endl);
+        cont->Error ++;
+        break;
+        }
 
-        actualSourceFile = "";
-        sourceFile = st2re1.match(1);
+      actualSourceFile = "";
+      sourceFile = st2re1.match(1);
+      }
+    else if ( st2re2.find(line->c_str() ) )
+      {
+      if ( gcovStyle == 0 )
+        {
+        gcovStyle = 2;
         }
-      else if ( st2re2.find(line->c_str() ) )
+      if ( gcovStyle != 2 )
         {
-        if ( gcovStyle == 0 )
-          {
-          gcovStyle = 2;
-          }
-        if ( gcovStyle != 2 )
-          {
-          cmCTestLog(this->CTest, ERROR_MESSAGE, "Unknown gcov output style e4"
-            << std::endl);
-          cont->Error ++;
-          break;
-          }
+        cmCTestLog(this->CTest, ERROR_MESSAGE, "Unknown gcov output style e4"
+          << std::endl);
+        cont->Error ++;
+        break;
         }
-      else if ( st2re3.find(line->c_str() ) )
+      }
+    else if ( st2re3.find(line->c_str() ) )
+      {
+      if ( gcovStyle == 0 )
         {
-        if ( gcovStyle == 0 )
-          {
-          gcovStyle = 2;
-          }
-        if ( gcovStyle != 2 )
-          {
-          cmCTestLog(this->CTest, ERROR_MESSAGE, "Unknown gcov output style e5"
-            << std::endl);
-          cont->Error ++;
-          break;
-          }
-
-        gcovFile = st2re3.match(2);
+        gcovStyle = 2;
         }
-      else if ( st2re4.find(line->c_str() ) )
+      if ( gcovStyle != 2 )
         {
-        if ( gcovStyle == 0 )
-          {
-          gcovStyle = 2;
-          }
-        if ( gcovStyle != 2 )
-          {
-          cmCTestLog(this->CTest, ERROR_MESSAGE, "Unknown gcov output style e6"
-            << std::endl);
-          cont->Error ++;
-          break;
-          }
+        cmCTestLog(this->CTest, ERROR_MESSAGE, "Unknown gcov output style e5"
+          << std::endl);
+        cont->Error ++;
+        break;
+        }
 
-        cmCTestLog(this->CTest, WARNING, "Warning: " << st2re4.match(1)
-          << " had unexpected EOF" << std::endl);
+      gcovFile = st2re3.match(2);
+      }
+    else if ( st2re4.find(line->c_str() ) )
+      {
+      if ( gcovStyle == 0 )
+        {
+        gcovStyle = 2;
         }
-      else if ( st2re5.find(line->c_str() ) )
+      if ( gcovStyle != 2 )
         {
-        if ( gcovStyle == 0 )
-          {
-          gcovStyle = 2;
-          }
-        if ( gcovStyle != 2 )
-          {
-          cmCTestLog(this->CTest, ERROR_MESSAGE, "Unknown gcov output style e7"
-            << std::endl);
-          cont->Error ++;
-          break;
-          }
+        cmCTestLog(this->CTest, ERROR_MESSAGE, "Unknown gcov output style e6"
+          << std::endl);
+        cont->Error ++;
+        break;
+        }
 
-        cmCTestLog(this->CTest, WARNING, "Warning: Cannot open file: "
-          << st2re5.match(1) << std::endl);
+      cmCTestLog(this->CTest, WARNING, "Warning: " << st2re4.match(1)
+        << " had unexpected EOF" << std::endl);
+      }
+    else if ( st2re5.find(line->c_str() ) )
+      {
+      if ( gcovStyle == 0 )
+        {
+        gcovStyle = 2;
         }
-      else if ( st2re6.find(line->c_str() ) )
+      if ( gcovStyle != 2 )
         {
-        if ( gcovStyle == 0 )
-          {
-          gcovStyle = 2;
-          }
-        if ( gcovStyle != 2 )
-          {
-          cmCTestLog(this->CTest, ERROR_MESSAGE, "Unknown gcov output style e8"
-            << std::endl);
-          cont->Error ++;
-          break;
-          }
+        cmCTestLog(this->CTest, ERROR_MESSAGE, "Unknown gcov output style e7"
+          << std::endl);
+        cont->Error ++;
+        break;
+        }
 
-        cmCTestLog(this->CTest, WARNING, "Warning: File: " << st2re6.match(1)
-          << " is newer than " << st2re6.match(2) << std::endl);
+      cmCTestLog(this->CTest, WARNING, "Warning: Cannot open file: "
+        << st2re5.match(1) << std::endl);
+      }
+    else if ( st2re6.find(line->c_str() ) )
+      {
+      if ( gcovStyle == 0 )
+        {
+        gcovStyle = 2;
         }
-      else
+      if ( gcovStyle != 2 )
         {
-        // gcov 4.7 can have output lines saying "No executable lines" and
-        // "Removing 'filename.gcov'"... Don't log those as "errors."
-        if(*line != "No executable lines" &&
-           !cmSystemTools::StringStartsWith(line->c_str(), "Removing "))
-          {
-          cmCTestLog(this->CTest, ERROR_MESSAGE,
-            "Unknown gcov output line: [" << *line << "]"
-            << std::endl);
-          cont->Error ++;
-          //abort();
-          }
+        cmCTestLog(this->CTest, ERROR_MESSAGE, "Unknown gcov output style e8"
+          << std::endl);
+        cont->Error ++;
+        break;
         }
 
-
-      // If the last line of gcov output gave us a valid value for gcovFile,
-      // and we have an actualSourceFile, then insert a (or add to existing)
-      // SingleFileCoverageVector for actualSourceFile:
-      //
-      if ( !gcovFile.empty() && !actualSourceFile.empty() )
+      cmCTestLog(this->CTest, WARNING, "Warning: File: " << st2re6.match(1)
+        << " is newer than " << st2re6.match(2) << std::endl);
+      }
+    else
+      {
+      // gcov 4.7 can have output lines saying "No executable lines" and
+      // "Removing 'filename.gcov'"... Don't log those as "errors."
+      if(*line != "No executable lines" &&
+         !cmSystemTools::StringStartsWith(line->c_str(), "Removing "))
         {
-        cmCTestCoverageHandlerContainer::SingleFileCoverageVector& vec
-          = cont->TotalCoverage[actualSourceFile];
+        cmCTestLog(this->CTest, ERROR_MESSAGE,
+          "Unknown gcov output line: [" << *line << "]"
+          << std::endl);
+        cont->Error ++;
+        //abort();
+        }
+      }
 
-        cmCTestLog(this->CTest, HANDLER_VERBOSE_OUTPUT, "   in gcovFile: "
-          << gcovFile << std::endl);
 
-        cmsys::ifstream ifile(gcovFile.c_str());
-        if ( ! ifile )
-          {
-          cmCTestLog(this->CTest, ERROR_MESSAGE, "Cannot open file: "
-            << gcovFile << std::endl);
-          }
-        else
+    // If the last line of gcov output gave us a valid value for gcovFile,
+    // and we have an actualSourceFile, then read its line counts and merge
+    // them into the SingleFileCoverageVector for actualSourceFile:
+    //
+    if ( !gcovFile.empty() && !actualSourceFile.empty() )
+      {
+      job.Coverage.Files.push_back(
+        cmCTestCoverageHandlerGCovEntry::FileCoverageVector::value_type(
+          actualSourceFile,
+          cmCTestCoverageHandlerContainer::SingleFileCoverageVector()));
+      cmCTestCoverageHandlerContainer::SingleFileCoverageVector& vec
+        = job.Coverage.Files.back().second;
+
+      cmCTestLog(this->CTest, HANDLER_VERBOSE_OUTPUT, "   in gcovFile: "
+        << gcovFile << std::endl);
+
+      // gcov wrote the file relative to the directory it ran in.
+      std::string gcovPath = gcovFile;
+      if ( !cmSystemTools::FileIsFullPath(gcovPath.c_str()) )
+        {
+        gcovPath = job.Directory + "/" + gcovFile;
+        }
+      cmsys::ifstream ifile(gcovPath.c_str());
+      if ( ! ifile )
+        {
+        cmCTestLog(this->CTest, ERROR_MESSAGE, "Cannot open file: "
+          << gcovFile << std::endl);
+        complete = false;
+        }
+      else
+        {
+        long cnt = -1;
+        std::string nl;
+        while ( cmSystemTools::GetLineFromStream(ifile, nl) )
           {
-          long cnt = -1;
-          std::string nl;
-          while ( cmSystemTools::GetLineFromStream(ifile, nl) )
-            {
-            cnt ++;
+          cnt ++;
 
-            //TODO: Handle gcov 3.0 non-coverage lines
+          //TODO: Handle gcov 3.0 non-coverage lines
 
-            // Skip empty lines
-            if ( !nl.size() )
-              {
-              continue;
-              }
+          // Skip empty lines
+          if ( !nl.size() )
+            {
+            continue;
+            }
 
-            // Skip unused lines
-            if ( nl.size() < 12 )
-              {
-              continue;
-              }
+          // Skip unused lines
+          if ( nl.size() < 12 )
+            {
+            continue;
+            }
 
-            // Read the coverage count from the beginning of the gcov output
-            // line
-            std::string prefix = nl.substr(0, 12);
-            int cov = atoi(prefix.c_str());
+          // Read the coverage count from the beginning of the gcov output
+          // line
+          std::string prefix = nl.substr(0, 12);
+          int cov = atoi(prefix.c_str());
 
-            // Read the line number starting at the 10th character of the gcov
-            // output line
-            std::string lineNumber = nl.substr(10, 5);
+          // Read the line number starting at the 10th character of the gcov
+          // output line
+          std::string lineNumber = nl.substr(10, 5);
 
-            int lineIdx = atoi(lineNumber.c_str())-1;
-            if ( lineIdx >= 0 )
+          int lineIdx = atoi(lineNumber.c_str())-1;
+          if ( lineIdx >= 0 )
+            {
+            while ( vec.size() <= static_cast<size_t>(lineIdx) )
               {
-              while ( vec.size() <= static_cast<size_t>(lineIdx) )
-                {
-                vec.push_back(-1);
-                }
+              vec.push_back(-1);
+              }
 
-              // Initially all entries are -1 (not used). If we get coverage
-              // information, increment it to 0 first.
-              if ( vec[lineIdx] < 0 )
+            // Initially all entries are -1 (not used). If we get coverage
+            // information, increment it to 0 first.
+            if ( vec[lineIdx] < 0 )
+              {
+              if ( cov > 0 || prefix.find("#") != prefix.npos )
                 {
-                if ( cov > 0 || prefix.find("#") != prefix.npos )
-                  {
-                  vec[lineIdx] = 0;
-                  }
+                vec[lineIdx] = 0;
                 }
-
-              vec[lineIdx] += cov;
               }
+
+            vec[lineIdx] += cov;
             }
           }
-
-        actualSourceFile = "";
         }
+      cmCTestCoverageHandlerMerge(cont, actualSourceFile, vec);
+
+      actualSourceFile = "";
+      }
+
 
+    if ( !sourceFile.empty() && actualSourceFile.empty() )
+      {
+      gcovFile = "";
 
-      if ( !sourceFile.empty() && actualSourceFile.empty() )
+      // Is it in the source dir or the binary dir?
+      //
+      if ( IsFileInDir(sourceFile, cont->SourceDir) )
+        {
+        cmCTestLog(this->CTest, HANDLER_VERBOSE_OUTPUT, "   produced s: "
+          << sourceFile << std::endl);
+        *cont->OFS << "  produced in source dir: " << sourceFile
+          << std::endl;
+        actualSourceFile
+          = cmSystemTools::CollapseFullPath(sourceFile.c_str());
+        }
+      else if ( IsFileInDir(sourceFile, cont->BinaryDir) )
         {
-        gcovFile = "";
+        cmCTestLog(this->CTest, HANDLER_VERBOSE_OUTPUT, "   produced b: "
+          << sourceFile << std::endl);
+        *cont->OFS << "  produced in binary dir: " << sourceFile
+          << std::endl;
+        actualSourceFile
+          = cmSystemTools::CollapseFullPath(sourceFile.c_str());
+        }
 
-        // Is it in the source dir or the binary dir?
-        //
-        if ( IsFileInDir(sourceFile, cont->SourceDir) )
-          {
-          cmCTestLog(this->CTest, HANDLER_VERBOSE_OUTPUT, "   produced s: "
-            << sourceFile << std::endl);
-          *cont->OFS << "  produced in source dir: " << sourceFile
-            << std::endl;
-          actualSourceFile
-            = cmSystemTools::CollapseFullPath(sourceFile.c_str());
-          }
-        else if ( IsFileInDir(sourceFile, cont->BinaryDir) )
+      if ( actualSourceFile.empty() )
+        {
+        if ( missingFiles.find(sourceFile) == missingFiles.end() )
           {
-          cmCTestLog(this->CTest, HANDLER_VERBOSE_OUTPUT, "   produced b: "
-            << sourceFile << std::endl);
-          *cont->OFS << "  produced in binary dir: " << sourceFile
-            << std::endl;
-          actualSourceFile
-            = cmSystemTools::CollapseFullPath(sourceFile.c_str());
-          }
+          cmCTestLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
+            "Something went wrong" << std::endl);
+          cmCTestLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
+            "Cannot find file: ["
+            << sourceFile << "]" << std::endl);
+          cmCTestLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
+            " in source dir: ["
+            << cont->SourceDir << "]"
+            << std::endl);
+          cmCTestLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
+            " or binary dir: ["
+            << cont->BinaryDir.size() << "]"
+            << std::endl);
+          *cont->OFS << "  Something went wrong. Cannot find file: "
+            << sourceFile
+            << " in source dir: " << cont->SourceDir
+            << " or binary dir: " << cont->BinaryDir << std::endl;
 
-        if ( actualSourceFile.empty() )
-          {
-          if ( missingFiles.find(sourceFile) == missingFiles.end() )
-            {
-            cmCTestLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
-              "Something went wrong" << std::endl);
-            cmCTestLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
-              "Cannot find file: ["
-              << sourceFile << "]" << std::endl);
-            cmCTestLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
-              " in source dir: ["
-              << cont->SourceDir << "]"
-              << std::endl);
-            cmCTestLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
-              " or binary dir: ["
-              << cont->BinaryDir.size() << "]"
-              << std::endl);
-            *cont->OFS << "  Something went wrong. Cannot find file: "
-              << sourceFile
-              << " in source dir: " << cont->SourceDir
-              << " or binary dir: " << cont->BinaryDir << std::endl;
-
-            missingFiles.insert(sourceFile);
-            }
+          missingFiles.insert(sourceFile);
           }
         }
       }
-
-    file_count++;
-
-    if ( file_count % 50 == 0 )
-      {
-      cmCTestLog(this->CTest, HANDLER_OUTPUT, " processed: " << file_count
-        << " out of " << files.size() << std::endl);
-      cmCTestLog(this->CTest, HANDLER_OUTPUT, "    ");
-      }
     }
-
-  cmSystemTools::ChangeDirectory(currentDirectory.c_str());
-  return file_count;
+  return complete && cont->Error == error;
 }
 
 //----------------------------------------------------------------------
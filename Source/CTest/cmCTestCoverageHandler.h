@@ -20,6 +20,8 @@
 #include <cmsys/RegularExpression.hxx>
 
 class cmGeneratedFileStream;
+class cmCTestCoverageHandlerGCovParser;
+class cmCTestCoverageHandlerGCovJob;
 class cmCTestCoverageHandlerContainer
 {
 public:
@@ -66,6 +68,9 @@ private:
 
   //! Handle coverage using GCC's GCov
   int HandleGCovCoverage(cmCTestCoverageHandlerContainer* cont);
+  bool HandleGCovJob(cmCTestCoverageHandlerContainer* cont,
+                     cmCTestCoverageHandlerGCovParser& parser,
+                     cmCTestCoverageHandlerGCovJob& job);
   void FindGCovFiles(std::vector<std::string>& files);
 
   //! Handle coverage using Intel's LCov
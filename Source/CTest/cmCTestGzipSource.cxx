@@ -0,0 +1,128 @@
+/*============================================================================
+  CMake - Cross Platform Makefile Generator
+  Copyright 2000-2009 Kitware, Inc., Insight Software Consortium
+
+  Distributed under the OSI-approved BSD License (the "License");
+  see accompanying file Copyright.txt for details.
+
+  This software is distributed WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the License for more information.
+============================================================================*/
+#include "cmCTestGzipSource.h"
+
+//----------------------------------------------------------------------------
+cmCTestGzipSource::cmCTestGzipSource():
+  File(0), Initialized(false), Finished(false), BytesRead(0), BytesSent(0)
+{
+}
+
+//----------------------------------------------------------------------------
+cmCTestGzipSource::~cmCTestGzipSource()
+{
+  if(this->Initialized)
+    {
+    deflateEnd(&this->Stream);
+    }
+}
+
+//----------------------------------------------------------------------------
+bool cmCTestGzipSource::Start(FILE* file)
+{
+  this->File = file;
+  return this->Restart();
+}
+
+//----------------------------------------------------------------------------
+bool cmCTestGzipSource::Restart()
+{
+  if(!this->File || fseek(this->File, 0, SEEK_SET) != 0)
+    {
+    return false;
+    }
+  clearerr(this->File);
+  this->Finished = false;
+  this->BytesRead = 0;
+  this->BytesSent = 0;
+  if(this->Initialized)
+    {
+    this->Stream.next_in = Z_NULL;
+    this->Stream.avail_in = 0;
+    return deflateReset(&this->Stream) == Z_OK;
+    }
+  this->Stream.zalloc = Z_NULL;
+  this->Stream.zfree = Z_NULL;
+  this->Stream.opaque = Z_NULL;
+  this->Stream.next_in = Z_NULL;
+  this->Stream.avail_in = 0;
+  // A window size of 15 plus 16 selects the gzip format.
+  this->Initialized = (deflateInit2(&this->Stream, Z_DEFAULT_COMPRESSION,
+                                    Z_DEFLATED, 15 + 16, 8,
+                                    Z_DEFAULT_STRATEGY) == Z_OK);
+  return this->Initialized;
+}
+
+//----------------------------------------------------------------------------
+bool cmCTestGzipSource::Read(void* buffer, size_t size, size_t& produced)
+{
+  produced = 0;
+  if(!this->Initialized)
+    {
+    return false;
+    }
+  z_stream& strm = this->Stream;
+  strm.next_out = static_cast<unsigned char*>(buffer);
+  strm.avail_out = static_cast<uInt>(size);
+  while(strm.avail_out > 0 && !this->Finished)
+    {
+    if(strm.avail_in == 0 && !feof(this->File))
+      {
+      size_t n = fread(this->Input, 1, sizeof(this->Input), this->File);
+      if(ferror(this->File))
+        {
+        return false;
+        }
+      this->BytesRead += static_cast<unsigned long>(n);
+      strm.next_in = this->Input;
+      strm.avail_in = static_cast<uInt>(n);
+      }
+    int flush =
+      (strm.avail_in == 0 && feof(this->File))? Z_FINISH : Z_NO_FLUSH;
+    int ret = deflate(&strm, flush);
+    if(ret == Z_STREAM_END)
+      {
+      this->Finished = true;
+      }
+    else if(ret != Z_OK && ret != Z_BUF_ERROR)
+      {
+      return false;
+      }
+    }
+  produced = size - strm.avail_out;
+  this->BytesSent += static_cast<unsigned long>(produced);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+size_t cmCTestGzipSource::ReadCallback(void* ptr, size_t size, size_t nmemb,
+                                       void* data)
+{
+  cmCTestGzipSource* src = static_cast<cmCTestGzipSource*>(data);
+  size_t produced;
+  if(!src->Read(ptr, size * nmemb, produced))
+    {
+    return CURL_READFUNC_ABORT;
+    }
+  return produced;
+}
+
+//----------------------------------------------------------------------------
+curlioerr cmCTestGzipSource::IoctlCallback(CURL*, int cmd, void* data)
+{
+  if(cmd == CURLIOCMD_RESTARTREAD)
+    {
+    cmCTestGzipSource* src = static_cast<cmCTestGzipSource*>(data);
+    return src->Restart()? CURLIOE_OK : CURLIOE_FAILRESTART;
+    }
+  return CURLIOE_UNKNOWNCMD;
+}
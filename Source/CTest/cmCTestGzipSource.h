@@ -0,0 +1,71 @@
+/*============================================================================
+  CMake - Cross Platform Makefile Generator
+  Copyright 2000-2009 Kitware, Inc., Insight Software Consortium
+
+  Distributed under the OSI-approved BSD License (the "License");
+  see accompanying file Copyright.txt for details.
+
+  This software is distributed WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the License for more information.
+============================================================================*/
+#ifndef cmCTestGzipSource_h
+#define cmCTestGzipSource_h
+
+#include "cmStandardIncludes.h"
+
+#include "cm_curl.h"
+#include <cm_zlib.h>
+
+/** \class cmCTestGzipSource
+ * \brief Gzip a file while it is read for an upload.
+ *
+ * The compressed data is produced in pieces as large as the reader
+ * asks for, so that large result files are never stored compressed on
+ * disk or in memory.  The upload may be restarted from the beginning
+ * of the file, as curl does to resend a request body.
+ */
+class cmCTestGzipSource
+{
+public:
+  cmCTestGzipSource();
+  ~cmCTestGzipSource();
+
+  /** Start compressing the given open file from its beginning.
+      Returns false if the file cannot be rewound or the compressor
+      cannot be initialized.  */
+  bool Start(FILE* file);
+
+  /** Start compressing the current file again from its beginning.  */
+  bool Restart();
+
+  /** Store up to size bytes of compressed data in the buffer and set
+      produced to their number, which is zero at the end of the data.
+      Returns false if the file cannot be read or compressed.  */
+  bool Read(void* buffer, size_t size, size_t& produced);
+
+  /** Number of bytes read from the file and produced from them since
+      the last start.  */
+  unsigned long GetBytesRead() const { return this->BytesRead; }
+  unsigned long GetBytesSent() const { return this->BytesSent; }
+
+  /** Callbacks for CURLOPT_READFUNCTION and CURLOPT_IOCTLFUNCTION
+      with the source as their data.  */
+  static size_t ReadCallback(void* ptr, size_t size, size_t nmemb,
+                             void* data);
+  static curlioerr IoctlCallback(CURL*, int cmd, void* data);
+
+private:
+  FILE* File;
+  z_stream Stream;
+  bool Initialized;
+  bool Finished;
+  unsigned long BytesRead;
+  unsigned long BytesSent;
+  unsigned char Input[16384];
+
+  cmCTestGzipSource(cmCTestGzipSource const&);
+  void operator=(cmCTestGzipSource const&);
+};
+
+#endif
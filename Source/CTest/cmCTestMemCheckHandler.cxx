@@ -19,8 +19,10 @@
 #include <cmsys/RegularExpression.hxx>
 #include <cmsys/Base64.h>
 #include <cmsys/FStream.hxx>
+#include <cmsys/Glob.hxx>
 #include "cmMakefile.h"
 #include "cmXMLSafe.h"
+#include "cmXMLWriter.h"
 
 #include <stdlib.h>
 #include <math.h>
@@ -199,12 +201,36 @@ void cmCTestMemCheckHandler::Initialize()
   this->MemoryTesterOptions.clear();
   this->MemoryTesterStyle = UNKNOWN;
   this->MemoryTesterOutputFile = "";
-  int cc;
-  for ( cc = 0; cc < NO_MEMORY_FAULT; cc ++ )
+  this->MemoryTesterEnvironmentVariable = "";
+  this->MemoryTesterGlobalResults.clear();
+  this->ResultStrings.clear();
+  this->ResultStringsLong.clear();
+  this->TestDefects.clear();
+}
+
+//----------------------------------------------------------------------
+int cmCTestMemCheckHandler::GetIndexFromName(std::string const& name)
+{
+  for(std::vector<std::string>::size_type i = 0;
+      i < this->ResultStrings.size(); ++i)
     {
-    this->MemoryTesterGlobalResults[cc] = 0;
+    if(this->ResultStrings[i] == name)
+      {
+      return static_cast<int>(i);
+      }
     }
+  this->ResultStrings.push_back(name);
+  this->ResultStringsLong.push_back(name);
+  this->MemoryTesterGlobalResults.push_back(0);
+  return static_cast<int>(this->ResultStrings.size() - 1);
+}
 
+//----------------------------------------------------------------------
+bool cmCTestMemCheckHandler::IsSanitizer() const
+{
+  return (this->MemoryTesterStyle == ADDRESS_SANITIZER ||
+          this->MemoryTesterStyle == LEAK_SANITIZER ||
+          this->MemoryTesterStyle == THREAD_SANITIZER);
 }
 
 //----------------------------------------------------------------------
@@ -240,6 +266,11 @@ int cmCTestMemCheckHandler::PostProcessHandler()
 void cmCTestMemCheckHandler::GenerateTestCommand(
   std::vector<std::string>& args, int test)
 {
+  if ( this->IsSanitizer() )
+    {
+    // The test runs directly; see GenerateTestEnvironment.
+    return;
+    }
   std::vector<std::string>::size_type pp;
   std::string index;
   cmOStringStream stream;
@@ -271,6 +302,51 @@ void cmCTestMemCheckHandler::GenerateTestCommand(
     << memcheckcommand << std::endl);
 }
 
+//----------------------------------------------------------------------
+void cmCTestMemCheckHandler::GenerateTestEnvironment(
+  std::vector<std::string>& env, int test)
+{
+  if ( this->MemoryTesterEnvironmentVariable.empty() )
+    {
+    return;
+    }
+  cmOStringStream stream;
+  stream << test;
+  std::string var = this->MemoryTesterEnvironmentVariable;
+  std::string::size_type pos = var.find("??");
+  if ( pos != std::string::npos )
+    {
+    var.replace(pos, 2, stream.str());
+    }
+
+  // Options the test sets in its own environment come last so that
+  // the sanitizer lets them override ours.
+  std::string name = var.substr(0, var.find('=') + 1);
+  std::vector<std::string>::iterator ei = env.begin();
+  for ( ; ei != env.end(); ++ei )
+    {
+    if ( ei->compare(0, name.size(), name) == 0 )
+      {
+      break;
+      }
+    }
+  if ( ei != env.end() )
+    {
+    std::string value = ei->substr(name.size());
+    if ( !value.empty() )
+      {
+      var += ":" + value;
+      }
+    *ei = var;
+    }
+  else
+    {
+    env.push_back(var);
+    }
+  cmCTestLog(this->CTest, HANDLER_VERBOSE_OUTPUT, "Memory check environment: "
+    << var << std::endl);
+}
+
 //----------------------------------------------------------------------
 void cmCTestMemCheckHandler::PopulateCustomVectors(cmMakefile *mf)
 {
@@ -294,36 +370,44 @@ void cmCTestMemCheckHandler::GenerateDartOutput(std::ostream& os)
     }
 
   this->CTest->StartXML(os, this->AppendXML);
-  os << "<DynamicAnalysis Checker=\"";
+  cmXMLWriter xml(os);
+  xml.StartElement("DynamicAnalysis");
   switch ( this->MemoryTesterStyle )
     {
     case cmCTestMemCheckHandler::VALGRIND:
-      os << "Valgrind";
+      xml.Attribute("Checker", "Valgrind");
       break;
     case cmCTestMemCheckHandler::PURIFY:
-      os << "Purify";
+      xml.Attribute("Checker", "Purify");
       break;
     case cmCTestMemCheckHandler::BOUNDS_CHECKER:
-      os << "BoundsChecker";
+      xml.Attribute("Checker", "BoundsChecker");
+      break;
+    case cmCTestMemCheckHandler::ADDRESS_SANITIZER:
+      xml.Attribute("Checker", "AddressSanitizer");
+      break;
+    case cmCTestMemCheckHandler::LEAK_SANITIZER:
+      xml.Attribute("Checker", "LeakSanitizer");
+      break;
+    case cmCTestMemCheckHandler::THREAD_SANITIZER:
+      xml.Attribute("Checker", "ThreadSanitizer");
       break;
     default:
-      os << "Unknown";
+      xml.Attribute("Checker", "Unknown");
     }
-  os << "\">" << std::endl;
 
-  os << "\t<StartDateTime>" << this->StartTest << "</StartDateTime>\n"
-     << "\t<StartTestTime>" << this->StartTestTime << "</StartTestTime>\n"
-     << "\t<TestList>\n";
+  xml.Element("StartDateTime", this->StartTest);
+  xml.Element("StartTestTime", this->StartTestTime);
+  xml.StartElement("TestList");
   cmCTestMemCheckHandler::TestResultsVector::size_type cc;
   for ( cc = 0; cc < this->TestResults.size(); cc ++ )
     {
     cmCTestTestResult *result = &this->TestResults[cc];
     std::string testPath = result->Path + "/" + result->Name;
-    os << "\t\t<Test>" << cmXMLSafe(
-      this->CTest->GetShortPathToFile(testPath.c_str()))
-      << "</Test>" << std::endl;
+    xml.Element("Test",
+      this->CTest->GetShortPathToFile(testPath.c_str()));
     }
-  os << "\t</TestList>\n";
+  xml.EndElement(); // TestList
   cmCTestLog(this->CTest, HANDLER_OUTPUT,
     "-- Processing memory checking output: ");
   size_t total = this->TestResults.size();
@@ -333,46 +417,56 @@ void cmCTestMemCheckHandler::GenerateDartOutput(std::ostream& os)
     {
     cmCTestTestResult *result = &this->TestResults[cc];
     std::string memcheckstr;
-    int memcheckresults[cmCTestMemCheckHandler::NO_MEMORY_FAULT];
-    int kk;
-    bool res = this->ProcessMemCheckOutput(result->Output, memcheckstr,
-      memcheckresults);
+    std::vector<int> memcheckresults;
+    bool res;
+    std::map<int, TestDefectsEntry>::iterator td =
+      this->TestDefects.find(result->TestCount);
+    if ( td != this->TestDefects.end() )
+      {
+      // The output was already processed when the test finished.
+      memcheckstr = result->Output;
+      memcheckresults = td->second.Defects;
+      res = td->second.Processed;
+      }
+    else
+      {
+      res = this->ProcessMemCheckOutput(result->Output, memcheckstr,
+                                        memcheckresults);
+      }
+    memcheckresults.resize(this->ResultStrings.size(), 0);
     if ( res && result->Status == cmCTestMemCheckHandler::COMPLETED )
       {
       continue;
       }
     this->CleanTestOutput(memcheckstr,
       static_cast<size_t>(this->CustomMaximumFailedTestOutputSize));
-    this->WriteTestResultHeader(os, result);
-    os << "\t\t<Results>" << std::endl;
-    for ( kk = 0; cmCTestMemCheckResultLongStrings[kk]; kk ++ )
+    this->WriteTestResultHeader(xml, result);
+    xml.StartElement("Results");
+    for ( size_t kk = 0; kk < this->ResultStringsLong.size(); kk ++ )
       {
       if ( memcheckresults[kk] )
         {
-        os << "\t\t\t<Defect type=\"" << cmCTestMemCheckResultLongStrings[kk]
-          << "\">"
-           << memcheckresults[kk]
-           << "</Defect>" << std::endl;
+        xml.StartElement("Defect");
+        xml.Attribute("type", this->ResultStringsLong[kk]);
+        xml.Content(memcheckresults[kk]);
+        xml.EndElement(); // Defect
         }
       this->MemoryTesterGlobalResults[kk] += memcheckresults[kk];
       }
+    xml.EndElement(); // Results
 
-    std::string logTag;
+    xml.StartElement("Log");
     if(this->CTest->ShouldCompressMemCheckOutput())
       {
       this->CTest->CompressString(memcheckstr);
-      logTag = "\t<Log compression=\"gzip\" encoding=\"base64\">\n";
-      }
-    else
-      {
-      logTag = "\t<Log>\n";
+      xml.Attribute("compression", "gzip");
+      xml.Attribute("encoding", "base64");
       }
+    xml.Content(memcheckstr);
+    xml.EndElement(); // Log
 
-    os
-      << "\t\t</Results>\n"
-      << logTag << cmXMLSafe(memcheckstr) << std::endl
-      << "\t</Log>\n";
-    this->WriteTestResultFooter(os, result);
+    this->WriteTestResultFooter(xml, result);
+    xml.Flush();
     if ( current < cc )
       {
       cmCTestLog(this->CTest, HANDLER_OUTPUT, "#" << std::flush);
@@ -382,8 +476,8 @@ void cmCTestMemCheckHandler::GenerateDartOutput(std::ostream& os)
   cmCTestLog(this->CTest, HANDLER_OUTPUT, std::endl);
   cmCTestLog(this->CTest, HANDLER_OUTPUT, "Memory checking results:"
     << std::endl);
-  os << "\t<DefectList>" << std::endl;
-  for ( cc = 0; cmCTestMemCheckResultStrings[cc]; cc ++ )
+  xml.StartElement("DefectList");
+  for ( cc = 0; cc < this->ResultStrings.size(); cc ++ )
     {
     if ( this->MemoryTesterGlobalResults[cc] )
       {
@@ -393,32 +487,50 @@ void cmCTestMemCheckHandler::GenerateDartOutput(std::ostream& os)
       std::cerr.width(35);
 #define cerr no_cerr
       cmCTestLog(this->CTest, HANDLER_OUTPUT,
-        cmCTestMemCheckResultLongStrings[cc] << " - "
+        this->ResultStringsLong[cc] << " - "
         << this->MemoryTesterGlobalResults[cc] << std::endl);
-      os << "\t\t<Defect Type=\"" << cmCTestMemCheckResultLongStrings[cc]
-        << "\"/>" << std::endl;
+      xml.StartElement("Defect");
+      xml.Attribute("Type", this->ResultStringsLong[cc]);
+      xml.EndElement();
       }
     }
-  os << "\t</DefectList>" << std::endl;
+  xml.EndElement(); // DefectList
 
-  os << "\t<EndDateTime>" << this->EndTest << "</EndDateTime>" << std::endl;
-  os << "\t<EndTestTime>" << this->EndTestTime
-     << "</EndTestTime>" << std::endl;
-  os << "<ElapsedMinutes>"
-     << static_cast<int>(this->ElapsedTestingTime/6)/10.0
-     << "</ElapsedMinutes>\n";
+  xml.Element("EndDateTime", this->EndTest);
+  xml.Element("EndTestTime", this->EndTestTime);
+  xml.Element("ElapsedMinutes",
+    static_cast<int>(this->ElapsedTestingTime/6)/10.0);
 
-  os << "</DynamicAnalysis>" << std::endl;
+  xml.EndElement(); // DynamicAnalysis
+  xml.Flush();
   this->CTest->EndXML(os);
-
-
 }
 
 //----------------------------------------------------------------------
 bool cmCTestMemCheckHandler::InitializeMemoryChecking()
 {
   // Setup the command
-  if ( cmSystemTools::FileExists(this->CTest->GetCTestConfiguration(
+  std::string checkType =
+    this->CTest->GetCTestConfiguration("MemoryCheckType");
+  if ( checkType == "AddressSanitizer" )
+    {
+    this->MemoryTesterStyle = cmCTestMemCheckHandler::ADDRESS_SANITIZER;
+    }
+  else if ( checkType == "LeakSanitizer" )
+    {
+    this->MemoryTesterStyle = cmCTestMemCheckHandler::LEAK_SANITIZER;
+    }
+  else if ( checkType == "ThreadSanitizer" )
+    {
+    this->MemoryTesterStyle = cmCTestMemCheckHandler::THREAD_SANITIZER;
+    }
+  else if ( !checkType.empty() )
+    {
+    cmCTestLog(this->CTest, ERROR_MESSAGE,
+      "Do not understand memory check type: " << checkType << std::endl);
+    return false;
+    }
+  else if ( cmSystemTools::FileExists(this->CTest->GetCTestConfiguration(
         "MemoryCheckCommand").c_str()) )
     {
     this->MemoryTester
@@ -554,6 +666,34 @@ bool cmCTestMemCheckHandler::InitializeMemoryChecking()
       this->MemoryTesterDynamicOptions.push_back(outputFile);
       break;
       }
+    case cmCTestMemCheckHandler::ADDRESS_SANITIZER:
+    case cmCTestMemCheckHandler::LEAK_SANITIZER:
+    case cmCTestMemCheckHandler::THREAD_SANITIZER:
+      {
+      // The sanitizer runtime in the test reads its options from the
+      // environment and appends the process id to the log file name.
+      const char* envVar = "ASAN_OPTIONS";
+      if ( this->MemoryTesterStyle == cmCTestMemCheckHandler::LEAK_SANITIZER )
+        {
+        envVar = "LSAN_OPTIONS";
+        }
+      else if ( this->MemoryTesterStyle ==
+                cmCTestMemCheckHandler::THREAD_SANITIZER )
+        {
+        envVar = "TSAN_OPTIONS";
+        }
+      this->MemoryTesterOptions.clear();
+      this->MemoryTesterEnvironmentVariable = envVar;
+      this->MemoryTesterEnvironmentVariable += "=log_path=";
+      this->MemoryTesterEnvironmentVariable += this->MemoryTesterOutputFile;
+      std::string extraOptions = this->CTest->GetCTestConfiguration(
+        "MemoryCheckSanitizerOptions");
+      if ( !extraOptions.empty() )
+        {
+        this->MemoryTesterEnvironmentVariable += ":" + extraOptions;
+        }
+      break;
+      }
     case cmCTestMemCheckHandler::BOUNDS_CHECKER:
       {
       this->BoundsCheckerXMLFile = this->MemoryTesterOutputFile;
@@ -574,23 +714,26 @@ bool cmCTestMemCheckHandler::InitializeMemoryChecking()
       return false;
     }
 
-  std::vector<std::string>::size_type cc;
-  for ( cc = 0; cmCTestMemCheckResultStrings[cc]; cc ++ )
+  this->ResultStrings.clear();
+  this->ResultStringsLong.clear();
+  for ( int cc = 0; cmCTestMemCheckResultStrings[cc]; cc ++ )
     {
-    this->MemoryTesterGlobalResults[cc] = 0;
+    this->ResultStrings.push_back(cmCTestMemCheckResultStrings[cc]);
+    this->ResultStringsLong.push_back(cmCTestMemCheckResultLongStrings[cc]);
     }
+  this->MemoryTesterGlobalResults.clear();
+  this->MemoryTesterGlobalResults.resize(this->ResultStrings.size(), 0);
+  this->TestDefects.clear();
   return true;
 }
 
 //----------------------------------------------------------------------
 bool cmCTestMemCheckHandler::ProcessMemCheckOutput(const std::string& str,
-                                               std::string& log, int* results)
+                                                   std::string& log,
+                                                   std::vector<int>& results)
 {
-  std::string::size_type cc;
-  for ( cc = 0; cc < cmCTestMemCheckHandler::NO_MEMORY_FAULT; cc ++ )
-    {
-    results[cc] = 0;
-    }
+  results.clear();
+  results.resize(this->ResultStrings.size(), 0);
 
   if ( this->MemoryTesterStyle == cmCTestMemCheckHandler::VALGRIND )
     {
@@ -605,6 +748,10 @@ bool cmCTestMemCheckHandler::ProcessMemCheckOutput(const std::string& str,
     {
     return this->ProcessMemCheckBoundsCheckerOutput(str, log, results);
     }
+  else if ( this->IsSanitizer() )
+    {
+    return this->ProcessMemCheckSanitizerOutput(str, log, results);
+    }
   else
     {
     log.append("\nMemory checking style used was: ");
@@ -619,7 +766,7 @@ bool cmCTestMemCheckHandler::ProcessMemCheckOutput(const std::string& str,
 //----------------------------------------------------------------------
 bool cmCTestMemCheckHandler::ProcessMemCheckPurifyOutput(
   const std::string& str, std::string& log,
-  int* results)
+  std::vector<int>& results)
 {
   std::vector<std::string> lines;
   cmSystemTools::Split(str.c_str(), lines);
@@ -673,10 +820,8 @@ bool cmCTestMemCheckHandler::ProcessMemCheckPurifyOutput(
 //----------------------------------------------------------------------
 bool cmCTestMemCheckHandler::ProcessMemCheckValgrindOutput(
   const std::string& str, std::string& log,
-  int* results)
+  std::vector<int>& results)
 {
-  std::vector<std::string> lines;
-  cmSystemTools::Split(str.c_str(), lines);
   bool unlimitedOutput = false;
   if(str.find("CTEST_FULL_OUTPUT") != str.npos ||
     this->CustomMaximumFailedTestOutputSize == 0)
@@ -684,8 +829,6 @@ bool cmCTestMemCheckHandler::ProcessMemCheckValgrindOutput(
     unlimitedOutput = true;
     }
 
-  std::string::size_type cc;
-
   cmOStringStream ostr;
   log = "";
 
@@ -724,78 +867,95 @@ bool cmCTestMemCheckHandler::ProcessMemCheckValgrindOutput(
   cmsys::RegularExpression vgIPW("== .*Invalid write of size [0-9,]+");
   cmsys::RegularExpression vgABR("== .*pthread_mutex_unlock: mutex is "
     "locked by a different thread");
-  std::vector<std::string::size_type> nonValGrindOutput;
+  // Walk the output one line at a time without splitting it up front.
+  // Valgrind lines are reported first, so the other output is collected
+  // separately and only up to the size that will be reported.
+  std::string nonValGrindOutput;
+  std::string line;
   double sttime = cmSystemTools::GetTime();
-  cmCTestLog(this->CTest, DEBUG, "Start test: " << lines.size() << std::endl);
+  cmCTestLog(this->CTest, DEBUG, "Start test: " << str.size() << std::endl);
   std::string::size_type totalOutputSize = 0;
   bool outputFull = false;
-  for ( cc = 0; cc < lines.size(); cc ++ )
+  std::string::size_type pos = 0;
+  while ( pos < str.size() )
     {
+    std::string::size_type eol = str.find('\n', pos);
+    if ( eol == std::string::npos )
+      {
+      eol = str.size();
+      }
+    std::string::size_type len = eol - pos;
+    if ( len > 0 && str[eol - 1] == '\r' )
+      {
+      --len;
+      }
+    line.assign(str, pos, len);
+    pos = eol + 1;
     cmCTestLog(this->CTest, DEBUG, "test line "
-               << lines[cc] << std::endl);
+               << line << std::endl);
 
-    if ( valgrindLine.find(lines[cc]) )
+    if ( valgrindLine.find(line) )
       {
       cmCTestLog(this->CTest, DEBUG, "valgrind  line "
-                 << lines[cc] << std::endl);
+                 << line << std::endl);
       int failure = cmCTestMemCheckHandler::NO_MEMORY_FAULT;
-      if ( vgFIM.find(lines[cc]) )
+      if ( vgFIM.find(line) )
         {
         failure = cmCTestMemCheckHandler::FIM;
         }
-      else if ( vgFMM.find(lines[cc]) )
+      else if ( vgFMM.find(line) )
         {
         failure = cmCTestMemCheckHandler::FMM;
         }
-      else if ( vgMLK1.find(lines[cc]) )
+      else if ( vgMLK1.find(line) )
         {
         failure = cmCTestMemCheckHandler::MLK;
         }
-      else if ( vgMLK2.find(lines[cc]) )
+      else if ( vgMLK2.find(line) )
         {
         failure = cmCTestMemCheckHandler::MLK;
         }
-      else if ( vgPAR.find(lines[cc]) )
+      else if ( vgPAR.find(line) )
         {
         failure = cmCTestMemCheckHandler::PAR;
         }
-      else if ( vgMPK1.find(lines[cc]) )
+      else if ( vgMPK1.find(line) )
         {
         failure = cmCTestMemCheckHandler::MPK;
         }
-      else if ( vgMPK2.find(lines[cc]) )
+      else if ( vgMPK2.find(line) )
         {
         failure = cmCTestMemCheckHandler::MPK;
         }
-      else if ( vgUMC.find(lines[cc]) )
+      else if ( vgUMC.find(line) )
         {
         failure = cmCTestMemCheckHandler::UMC;
         }
-      else if ( vgUMR1.find(lines[cc]) )
+      else if ( vgUMR1.find(line) )
         {
         failure = cmCTestMemCheckHandler::UMR;
         }
-      else if ( vgUMR2.find(lines[cc]) )
+      else if ( vgUMR2.find(line) )
         {
         failure = cmCTestMemCheckHandler::UMR;
         }
-      else if ( vgUMR3.find(lines[cc]) )
+      else if ( vgUMR3.find(line) )
         {
         failure = cmCTestMemCheckHandler::UMR;
         }
-      else if ( vgUMR4.find(lines[cc]) )
+      else if ( vgUMR4.find(line) )
         {
         failure = cmCTestMemCheckHandler::UMR;
         }
-      else if ( vgUMR5.find(lines[cc]) )
+      else if ( vgUMR5.find(line) )
         {
         failure = cmCTestMemCheckHandler::UMR;
         }
-      else if ( vgIPW.find(lines[cc]) )
+      else if ( vgIPW.find(line) )
         {
         failure = cmCTestMemCheckHandler::IPW;
         }
-      else if ( vgABR.find(lines[cc]) )
+      else if ( vgABR.find(line) )
         {
         failure = cmCTestMemCheckHandler::ABR;
         }
@@ -806,37 +966,45 @@ bool cmCTestMemCheckHandler::ProcessMemCheckValgrindOutput(
         results[failure] ++;
         defects ++;
         }
-      totalOutputSize += lines[cc].size();
-      ostr << cmXMLSafe(lines[cc]) << std::endl;
+      totalOutputSize += line.size();
+      ostr << cmXMLSafe(line) << std::endl;
       }
-    else
+    else if ( !outputFull )
       {
-      nonValGrindOutput.push_back(cc);
+      // Keep the non valgrind output until the limit is reached.
+      nonValGrindOutput += line;
+      nonValGrindOutput += "\n";
+      if(!unlimitedOutput && nonValGrindOutput.size() >
+         static_cast<size_t>(this->CustomMaximumFailedTestOutputSize))
+        {
+        outputFull = true;
+        }
       }
     }
   // Now put all all the non valgrind output into the test output
-  if(!outputFull)
+  bool truncated = false;
+  pos = 0;
+  while ( pos < nonValGrindOutput.size() && !truncated )
     {
-    for(std::vector<std::string::size_type>::iterator i =
-          nonValGrindOutput.begin(); i != nonValGrindOutput.end(); ++i)
+    std::string::size_type eol = nonValGrindOutput.find('\n', pos);
+    line.assign(nonValGrindOutput, pos, eol - pos);
+    pos = eol + 1;
+    totalOutputSize += line.size();
+    cmCTestLog(this->CTest, DEBUG, "before xml safe "
+               << line << std::endl);
+    cmCTestLog(this->CTest, DEBUG, "after  xml safe "
+               <<  cmXMLSafe(line) << std::endl);
+
+    ostr << cmXMLSafe(line) << std::endl;
+    if(!unlimitedOutput && totalOutputSize >
+       static_cast<size_t>(this->CustomMaximumFailedTestOutputSize))
       {
-      totalOutputSize += lines[*i].size();
-      cmCTestLog(this->CTest, DEBUG, "before xml safe "
-                 << lines[*i] << std::endl);
-      cmCTestLog(this->CTest, DEBUG, "after  xml safe "
-                 <<  cmXMLSafe(lines[*i]) << std::endl);
-
-      ostr << cmXMLSafe(lines[*i]) << std::endl;
-      if(!unlimitedOutput && totalOutputSize >
-         static_cast<size_t>(this->CustomMaximumFailedTestOutputSize))
-        {
-        outputFull = true;
-        ostr << "....\n";
-        ostr << "Test Output for this test has been truncated see testing"
-          " machine logs for full output,\n";
-        ostr << "or put CTEST_FULL_OUTPUT in the output of "
-          "this test program.\n";
-        }
+      truncated = true;
+      ostr << "....\n";
+      ostr << "Test Output for this test has been truncated see testing"
+        " machine logs for full output,\n";
+      ostr << "or put CTEST_FULL_OUTPUT in the output of "
+        "this test program.\n";
       }
     }
   cmCTestLog(this->CTest, DEBUG, "End test (elapsed: "
@@ -851,10 +1019,75 @@ bool cmCTestMemCheckHandler::ProcessMemCheckValgrindOutput(
 
 
 
+//----------------------------------------------------------------------
+bool cmCTestMemCheckHandler::ProcessMemCheckSanitizerOutput(
+  const std::string& str, std::string& log,
+  std::vector<int>& results)
+{
+  std::string regex;
+  switch ( this->MemoryTesterStyle )
+    {
+    case cmCTestMemCheckHandler::ADDRESS_SANITIZER:
+      regex = "ERROR: AddressSanitizer: ([^ ]*)";
+      break;
+    case cmCTestMemCheckHandler::THREAD_SANITIZER:
+      regex = "WARNING: ThreadSanitizer: (.*) \\(pid=";
+      break;
+    default:
+      break;
+    }
+  cmsys::RegularExpression sanitizerWarning(regex.c_str());
+  cmsys::RegularExpression leakWarning("(Direct|Indirect) leak of ");
+
+  cmOStringStream ostr;
+  log = "";
+  int defects = 0;
+  std::string line;
+  std::string::size_type pos = 0;
+  while ( pos < str.size() )
+    {
+    std::string::size_type eol = str.find('\n', pos);
+    if ( eol == std::string::npos )
+      {
+      eol = str.size();
+      }
+    line.assign(str, pos, eol - pos);
+    pos = eol + 1;
+
+    std::string resultFound;
+    if ( leakWarning.find(line) )
+      {
+      resultFound = leakWarning.match(1) + " leak";
+      }
+    else if ( !regex.empty() && sanitizerWarning.find(line) )
+      {
+      resultFound = sanitizerWarning.match(1);
+      }
+    if ( !resultFound.empty() )
+      {
+      int idx = this->GetIndexFromName(resultFound);
+      if ( results.size() <= static_cast<size_t>(idx) )
+        {
+        results.resize(idx + 1, 0);
+        }
+      ostr << "<b>" << this->ResultStrings[idx] << "</b> ";
+      results[idx] ++;
+      defects ++;
+      }
+    ostr << cmXMLSafe(line) << std::endl;
+    }
+  log = ostr.str();
+  if ( defects )
+    {
+    return false;
+    }
+  return true;
+}
+
 //----------------------------------------------------------------------
 bool cmCTestMemCheckHandler::ProcessMemCheckBoundsCheckerOutput(
   const std::string& str, std::string& log,
-  int* results)
+  std::vector<int>& results)
 {
   log = "";
   double sttime = cmSystemTools::GetTime();
@@ -969,6 +1202,52 @@ cmCTestMemCheckHandler::PostProcessValgrindTest(cmCTestTestResult& res,
   appendMemTesterOutput(res, test);
 }
 
+void
+cmCTestMemCheckHandler::PostProcessSanitizerTest(cmCTestTestResult& res,
+                                                 int test)
+{
+  cmCTestLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
+             "PostProcessSanitizerTest for : "
+             << res.Name << std::endl);
+
+  // The sanitizer writes one log per process, and only if it found
+  // something to report.  Remove them once read so that a later run
+  // does not see them.
+  cmOStringStream stream;
+  stream << test;
+  std::string ofile = this->MemoryTesterOutputFile;
+  ofile.replace(ofile.find("??"), 2, stream.str());
+  ofile += ".*";
+  cmsys::Glob g;
+  g.FindFiles(ofile);
+  std::vector<std::string> const& files = g.GetFiles();
+  for(std::vector<std::string>::const_iterator fi = files.begin();
+      fi != files.end(); ++fi)
+    {
+    this->appendMemTesterOutputFile(res, *fi);
+    cmSystemTools::RemoveFile(fi->c_str());
+    }
+}
+
+void
+cmCTestMemCheckHandler::ProcessTestResult(cmCTestTestResult& res)
+{
+  // The BoundsChecker log is one XML document.  Parse it with the
+  // other results so that parse errors are reported there.
+  if ( this->MemoryTesterStyle == cmCTestMemCheckHandler::BOUNDS_CHECKER )
+    {
+    return;
+    }
+
+  // Parse the output now, while other tests may still be running,
+  // and keep only what will be reported.
+  std::string log;
+  TestDefectsEntry& entry = this->TestDefects[res.TestCount];
+  entry.Processed = this->ProcessMemCheckOutput(res.Output, log,
+                                                entry.Defects);
+  res.Output = log;
+}
+
 void
 cmCTestMemCheckHandler::appendMemTesterOutput(cmCTestTestResult& res,
                                               int test)
@@ -979,17 +1258,29 @@ cmCTestMemCheckHandler::appendMemTesterOutput(cmCTestTestResult& res,
     {
     return;
     }
-  cmsys::ifstream ifs(ofile.c_str());
+  this->appendMemTesterOutputFile(res, ofile);
+}
+
+void
+cmCTestMemCheckHandler::appendMemTesterOutputFile(cmCTestTestResult& res,
+                                                  std::string const& ofile)
+{
+  cmsys::ifstream ifs(ofile.c_str(), std::ios::in | std::ios::binary);
   if ( !ifs )
     {
     std::string log = "Cannot read memory tester output file: " + ofile;
     cmCTestLog(this->CTest, ERROR_MESSAGE, log.c_str() << std::endl);
     return;
     }
-  std::string line;
-  while ( cmSystemTools::GetLineFromStream(ifs, line) )
+  // Append the log in large blocks rather than line by line.
+  char buffer[32768];
+  while ( ifs )
+    {
+    ifs.read(buffer, sizeof(buffer));
+    res.Output.append(buffer, static_cast<size_t>(ifs.gcount()));
+    }
+  if ( !res.Output.empty() && res.Output[res.Output.size()-1] != '\n' )
     {
-    res.Output += line;
     res.Output += "\n";
     }
 }
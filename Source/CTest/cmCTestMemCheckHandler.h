@@ -45,7 +45,10 @@ private:
     UNKNOWN = 0,
     VALGRIND,
     PURIFY,
-    BOUNDS_CHECKER
+    BOUNDS_CHECKER,
+    ADDRESS_SANITIZER,
+    LEAK_SANITIZER,
+    THREAD_SANITIZER
   };
 public:
   enum { // Memory faults
@@ -93,7 +96,32 @@ private:
   std::vector<std::string> MemoryTesterOptions;
   int                      MemoryTesterStyle;
   std::string              MemoryTesterOutputFile;
-  int                      MemoryTesterGlobalResults[NO_MEMORY_FAULT];
+  std::string              MemoryTesterEnvironmentVariable;
+  std::vector<int>         MemoryTesterGlobalResults;
+
+  // Short and long names of the defect types.  The fixed memory faults
+  // come first; sanitizer report types are added as they are seen.
+  std::vector<std::string> ResultStrings;
+  std::vector<std::string> ResultStringsLong;
+
+  // Defects found in each test as its output was processed at the end
+  // of the test, and whether the output was processed successfully,
+  // indexed by test number.
+  struct TestDefectsEntry
+  {
+    bool Processed;
+    std::vector<int> Defects;
+  };
+  std::map<int, TestDefectsEntry> TestDefects;
+
+  ///! Return the index of a defect type, adding it if needed.
+  int GetIndexFromName(std::string const& name);
+
+  ///! Whether the memory checker is built into the test executable.
+  bool IsSanitizer() const;
+
+  ///! Add the memory checker settings to the environment of a test.
+  void GenerateTestEnvironment(std::vector<std::string>& env, int test);
 
   ///! Initialize memory checking subsystem.
   bool InitializeMemoryChecking();
@@ -110,21 +138,33 @@ private:
   //string. After running, log holds the output and results hold the
   //different memmory errors.
   bool ProcessMemCheckOutput(const std::string& str,
-                             std::string& log, int* results);
+                             std::string& log, std::vector<int>& results);
   bool ProcessMemCheckValgrindOutput(const std::string& str,
-                                     std::string& log, int* results);
+                                     std::string& log,
+                                     std::vector<int>& results);
   bool ProcessMemCheckPurifyOutput(const std::string& str,
-                                   std::string& log, int* results);
+                                   std::string& log,
+                                   std::vector<int>& results);
   bool ProcessMemCheckBoundsCheckerOutput(const std::string& str,
-                                          std::string& log, int* results);
+                                          std::string& log,
+                                          std::vector<int>& results);
+  bool ProcessMemCheckSanitizerOutput(const std::string& str,
+                                      std::string& log,
+                                      std::vector<int>& results);
 
   void PostProcessPurifyTest(cmCTestTestResult& res, int test);
   void PostProcessBoundsCheckerTest(cmCTestTestResult& res, int test);
   void PostProcessValgrindTest(cmCTestTestResult& res, int test);
+  void PostProcessSanitizerTest(cmCTestTestResult& res, int test);
+
+  ///! Parse the output of a finished test and keep only the result
+  void ProcessTestResult(cmCTestTestResult& res);
 
   ///! append MemoryTesterOutputFile to the test log
   void appendMemTesterOutput(cmCTestTestHandler::cmCTestTestResult& res,
                              int test);
+  void appendMemTesterOutputFile(cmCTestTestResult& res,
+                                 std::string const& ofile);
 
   ///! generate the output filename for the given test index
   std::string testOutputFileName(int test);
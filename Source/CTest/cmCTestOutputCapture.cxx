@@ -0,0 +1,270 @@
+/*============================================================================
+  CMake - Cross Platform Makefile Generator
+  Copyright 2000-2009 Kitware, Inc., Insight Software Consortium
+
+  Distributed under the OSI-approved BSD License (the "License");
+  see accompanying file Copyright.txt for details.
+
+  This software is distributed WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the License for more information.
+============================================================================*/
+#include "cmCTestOutputCapture.h"
+
+#include "cmSystemTools.h"
+
+#include <cmsys/Base64.h>
+#include <cmsys/FStream.hxx>
+
+//----------------------------------------------------------------------
+cmCTestOutputCapture::cmCTestOutputCapture()
+{
+  this->HeadSize = 0;
+  this->TailSize = 0;
+  this->TotalSize = 0;
+  this->Truncated = false;
+  this->Compress = false;
+  this->TailBegin = 0;
+  this->TailLength = 0;
+  this->Spill = 0;
+  this->StreamOpen = false;
+  this->StreamFailed = false;
+}
+
+//----------------------------------------------------------------------
+cmCTestOutputCapture::~cmCTestOutputCapture()
+{
+  delete this->Spill;
+  if(this->StreamOpen)
+    {
+    deflateEnd(&this->Stream);
+    }
+}
+
+//----------------------------------------------------------------------
+void cmCTestOutputCapture::SetLimits(size_t headSize, size_t tailSize)
+{
+  this->HeadSize = headSize;
+  this->TailSize = headSize? tailSize : 0;
+  this->Tail.resize(this->TailSize);
+}
+
+//----------------------------------------------------------------------
+void cmCTestOutputCapture::SetUnlimited()
+{
+  if(!this->Truncated)
+    {
+    this->SetLimits(0, 0);
+    }
+}
+
+//----------------------------------------------------------------------
+bool cmCTestOutputCapture::AppendLine(std::string const& line)
+{
+  this->TotalSize += line.size() + 1;
+  if(!this->Truncated &&
+     (this->HeadSize == 0 ||
+      this->Head.size() + line.size() + 1 <= this->HeadSize))
+    {
+    this->Head += line;
+    this->Head += "\n";
+    if(this->Compress)
+      {
+      this->Deflate(line.c_str(), line.size(), Z_NO_FLUSH);
+      this->Deflate("\n", 1, Z_NO_FLUSH);
+      }
+    return true;
+    }
+
+  if(!this->Truncated)
+    {
+    this->Truncated = true;
+    this->StartSpill();
+    }
+  if(this->Spill)
+    {
+    *this->Spill << line << "\n";
+    }
+  this->AppendTail(line.c_str(), line.size());
+  this->AppendTail("\n", 1);
+  return false;
+}
+
+//----------------------------------------------------------------------
+void cmCTestOutputCapture::StartSpill()
+{
+  if(this->SpillFileName.empty())
+    {
+    return;
+    }
+  cmsys::ofstream* fout = new cmsys::ofstream(this->SpillFileName.c_str(),
+                                              std::ios::out |
+                                              std::ios::binary);
+  if(!*fout)
+    {
+    delete fout;
+    this->SpillFileName = "";
+    return;
+    }
+  this->Spill = fout;
+  *this->Spill << this->Head;
+}
+
+//----------------------------------------------------------------------
+void cmCTestOutputCapture::AppendTail(const char* data, size_t length)
+{
+  size_t const size = this->TailSize;
+  if(size == 0)
+    {
+    return;
+    }
+  // Only the last 'size' bytes of the data can survive.
+  if(length > size)
+    {
+    data += length - size;
+    length = size;
+    }
+  // Copy into the ring in at most two pieces.
+  size_t end = (this->TailBegin + this->TailLength) % size;
+  size_t first = length < size - end ? length : size - end;
+  memcpy(&this->Tail[0] + end, data, first);
+  memcpy(&this->Tail[0], data + first, length - first);
+  this->TailLength += length;
+  if(this->TailLength > size)
+    {
+    this->TailBegin = (this->TailBegin + this->TailLength - size) % size;
+    this->TailLength = size;
+    }
+}
+
+//----------------------------------------------------------------------
+std::string cmCTestOutputCapture::GetTail() const
+{
+  std::string tail;
+  size_t const size = this->TailSize;
+  if(size == 0)
+    {
+    return tail;
+    }
+  tail.reserve(this->TailLength);
+  size_t first = this->TailLength < size - this->TailBegin ?
+    this->TailLength : size - this->TailBegin;
+  tail.append(&this->Tail[0] + this->TailBegin, first);
+  tail.append(&this->Tail[0], this->TailLength - first);
+
+  // Drop the partial line at the start of the ring.
+  if(this->TotalSize - this->Head.size() > this->TailLength)
+    {
+    std::string::size_type pos = tail.find('\n');
+    if(pos != tail.npos)
+      {
+      tail = tail.substr(pos + 1);
+      }
+    }
+  return tail;
+}
+
+//----------------------------------------------------------------------
+std::string cmCTestOutputCapture::GetTruncationNote() const
+{
+  cmOStringStream msg;
+  msg << "...\n"
+    "Test output of " << this->TotalSize << " bytes exceeds the capture "
+    "limit; only the first " << this->Head.size() << " and last "
+    << this->TailSize << " bytes were kept.\n";
+  if(!this->SpillFileName.empty())
+    {
+    msg << "Full output: " << this->SpillFileName << "\n";
+    }
+  msg << "...\n";
+  return msg.str();
+}
+
+//----------------------------------------------------------------------
+std::string cmCTestOutputCapture::GetOutput() const
+{
+  if(!this->Truncated)
+    {
+    return this->Head;
+    }
+  return this->Head + this->GetTruncationNote() + this->GetTail();
+}
+
+//----------------------------------------------------------------------
+bool cmCTestOutputCapture::Deflate(const char* data, size_t length,
+                                   int flush)
+{
+  if(this->StreamFailed)
+    {
+    return false;
+    }
+  if(!this->StreamOpen)
+    {
+    this->Stream.zalloc = Z_NULL;
+    this->Stream.zfree = Z_NULL;
+    this->Stream.opaque = Z_NULL;
+    if(deflateInit(&this->Stream, -1) != Z_OK) //default compression level
+      {
+      this->StreamFailed = true;
+      return false;
+      }
+    this->StreamOpen = true;
+    }
+
+  unsigned char out[16384];
+  this->Stream.next_in =
+    reinterpret_cast<unsigned char*>(const_cast<char*>(data));
+  this->Stream.avail_in = static_cast<uInt>(length);
+  int ret;
+  do
+    {
+    this->Stream.next_out = out;
+    this->Stream.avail_out = sizeof(out);
+    ret = deflate(&this->Stream, flush);
+    if(ret == Z_STREAM_ERROR)
+      {
+      this->StreamFailed = true;
+      return false;
+      }
+    this->Deflated.append(reinterpret_cast<char*>(out),
+                          sizeof(out) - this->Stream.avail_out);
+    }
+  while(this->Stream.avail_out == 0 ||
+        (flush == Z_FINISH && ret != Z_STREAM_END));
+  return true;
+}
+
+//----------------------------------------------------------------------
+bool cmCTestOutputCapture::GetCompressedOutput(std::string& out,
+                                               double& ratio)
+{
+  if(!this->Compress)
+    {
+    return false;
+    }
+  std::string rest;
+  if(this->Truncated)
+    {
+    rest = this->GetTruncationNote() + this->GetTail();
+    }
+  if(!this->Deflate(rest.c_str(), rest.size(), Z_FINISH))
+    {
+    return false;
+    }
+
+  std::vector<unsigned char> encoded(this->Deflated.size() * 3 / 2 + 4);
+  unsigned long rlen = cmsysBase64_Encode(
+    reinterpret_cast<const unsigned char*>(this->Deflated.c_str()),
+    static_cast<unsigned long>(this->Deflated.size()), &encoded[0], 1);
+  out.assign(reinterpret_cast<char*>(&encoded[0]), rlen);
+
+  if(this->Stream.total_in)
+    {
+    ratio = static_cast<double>(this->Stream.total_out) /
+            static_cast<double>(this->Stream.total_in);
+    }
+  deflateEnd(&this->Stream);
+  this->StreamOpen = false;
+  this->Deflated = "";
+  return true;
+}
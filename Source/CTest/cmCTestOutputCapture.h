@@ -0,0 +1,93 @@
+/*============================================================================
+  CMake - Cross Platform Makefile Generator
+  Copyright 2000-2009 Kitware, Inc., Insight Software Consortium
+
+  Distributed under the OSI-approved BSD License (the "License");
+  see accompanying file Copyright.txt for details.
+
+  This software is distributed WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the License for more information.
+============================================================================*/
+#ifndef cmCTestOutputCapture_h
+#define cmCTestOutputCapture_h
+
+#include "cmStandardIncludes.h"
+
+#include <cm_zlib.h>
+
+/** \class cmCTestOutputCapture
+ * \brief Bounded-memory storage of the output of a running test.
+ *
+ * The first HeadSize bytes of output are kept verbatim and the last
+ * TailSize bytes are kept in a ring buffer.  Everything in between is
+ * dropped from memory, optionally after being written to a spill file
+ * on disk.  The retained head may be deflated as it arrives so that the
+ * compressed dashboard output does not require a second copy.
+ */
+class cmCTestOutputCapture
+{
+public:
+  cmCTestOutputCapture();
+  ~cmCTestOutputCapture();
+
+  /** Set the number of bytes to keep from the beginning and end of
+      the output.  A head size of zero means no limit.  */
+  void SetLimits(size_t headSize, size_t tailSize);
+
+  /** Stop dropping output, if nothing has been dropped yet.  */
+  void SetUnlimited();
+
+  /** Write the full output to the given file once it has to be
+      truncated in memory.  */
+  void SetSpillFile(std::string const& fname)
+    { this->SpillFileName = fname; }
+  std::string const& GetSpillFile() const { return this->SpillFileName; }
+
+  /** Deflate the retained output while it is captured.  */
+  void SetCompress(bool b) { this->Compress = b; }
+
+  /** Store one line of output.  Returns false if the line is not part
+      of the retained head and may be dropped from memory later.  */
+  bool AppendLine(std::string const& line);
+
+  bool IsTruncated() const { return this->Truncated; }
+  size_t GetTotalSize() const { return this->TotalSize; }
+
+  /** Retained output: head, a truncation note, and the tail.  */
+  std::string GetOutput() const;
+
+  /** Finish compression of the retained output and return it base64
+      encoded along with the compression ratio.  Returns false if the
+      output could not be compressed.  */
+  bool GetCompressedOutput(std::string& out, double& ratio);
+
+private:
+  void StartSpill();
+  void AppendTail(const char* data, size_t length);
+  std::string GetTail() const;
+  std::string GetTruncationNote() const;
+  bool Deflate(const char* data, size_t length, int flush);
+
+  size_t HeadSize;
+  size_t TailSize;
+  size_t TotalSize;
+  bool Truncated;
+  bool Compress;
+  std::string Head;
+
+  // Ring buffer holding the most recent output past the head.
+  std::vector<char> Tail;
+  size_t TailBegin;
+  size_t TailLength;
+
+  std::string SpillFileName;
+  std::ostream* Spill;
+
+  z_stream Stream;
+  bool StreamOpen;
+  bool StreamFailed;
+  std::string Deflated;
+};
+
+#endif
@@ -0,0 +1,143 @@
+/*============================================================================
+  CMake - Cross Platform Makefile Generator
+  Copyright 2000-2009 Kitware, Inc., Insight Software Consortium
+
+  Distributed under the OSI-approved BSD License (the "License");
+  see accompanying file Copyright.txt for details.
+
+  This software is distributed WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the License for more information.
+============================================================================*/
+#include "cmCTestRegularExpression.h"
+
+//----------------------------------------------------------------------
+cmCTestRegularExpression::cmCTestRegularExpression()
+{
+  this->Kind = Invalid;
+  this->AnchorBegin = false;
+  this->AnchorEnd = false;
+}
+
+//----------------------------------------------------------------------
+static bool cmCTestRegularExpressionIsSpecial(char c)
+{
+  return strchr(".[]()*+?|^$\\", c) != 0;
+}
+
+//----------------------------------------------------------------------
+static bool cmCTestRegularExpressionIsRepeat(char c)
+{
+  return c == '*' || c == '+' || c == '?';
+}
+
+//----------------------------------------------------------------------
+bool cmCTestRegularExpression::compile(std::string const& pattern)
+{
+  this->Kind = Invalid;
+  this->Text = "";
+  this->Cache.clear();
+  if(!this->RegularExpression.compile(pattern.c_str()))
+    {
+    return false;
+    }
+
+  std::string::size_type begin = 0;
+  std::string::size_type end = pattern.size();
+  this->AnchorBegin = begin < end && pattern[begin] == '^';
+  if(this->AnchorBegin)
+    {
+    ++begin;
+    }
+
+  // Collect the literal text at the start of the expression.
+  std::string text;
+  std::string::size_type pos = begin;
+  while(pos < end)
+    {
+    char c = pattern[pos];
+    if(c == '\\' && pos + 1 < end)
+      {
+      c = pattern[pos + 1];
+      pos += 2;
+      }
+    else if(cmCTestRegularExpressionIsSpecial(c))
+      {
+      break;
+      }
+    else
+      {
+      ++pos;
+      }
+    // A repeat operator applies to the last character only.
+    if(pos < end && cmCTestRegularExpressionIsRepeat(pattern[pos]))
+      {
+      pos = std::string::npos;
+      break;
+      }
+    text += c;
+    }
+
+  this->AnchorEnd = pos + 1 == end && pattern[pos] == '$';
+  if(pos == end || this->AnchorEnd)
+    {
+    this->Kind = Literal;
+    this->Text = text;
+    }
+  else
+    {
+    this->Kind = Regex;
+    // With alternation no text is required for a match.
+    if(pattern.find('|') == pattern.npos)
+      {
+      this->Text = text;
+      }
+    this->AnchorEnd = false;
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------
+bool cmCTestRegularExpression::find(std::string const& s)
+{
+  std::string const& text = this->Text;
+  switch(this->Kind)
+    {
+    case Literal:
+      if(this->AnchorBegin && this->AnchorEnd)
+        {
+        return s == text;
+        }
+      else if(this->AnchorBegin)
+        {
+        return s.compare(0, text.size(), text) == 0;
+        }
+      else if(this->AnchorEnd)
+        {
+        return s.size() >= text.size() &&
+          s.compare(s.size() - text.size(), text.size(), text) == 0;
+        }
+      return s.find(text) != s.npos;
+    case Regex:
+      if(!text.empty() &&
+         (this->AnchorBegin ? s.compare(0, text.size(), text) != 0
+                            : s.find(text) == s.npos))
+        {
+        return false;
+        }
+      return this->RegularExpression.find(s);
+    default:
+      return false;
+    }
+}
+
+//----------------------------------------------------------------------
+bool cmCTestRegularExpression::find_cached(std::string const& s)
+{
+  std::map<std::string, bool>::iterator i = this->Cache.find(s);
+  if(i == this->Cache.end())
+    {
+    i = this->Cache.insert(std::make_pair(s, this->find(s))).first;
+    }
+  return i->second;
+}
@@ -0,0 +1,56 @@
+/*============================================================================
+  CMake - Cross Platform Makefile Generator
+  Copyright 2000-2009 Kitware, Inc., Insight Software Consortium
+
+  Distributed under the OSI-approved BSD License (the "License");
+  see accompanying file Copyright.txt for details.
+
+  This software is distributed WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the License for more information.
+============================================================================*/
+#ifndef cmCTestRegularExpression_h
+#define cmCTestRegularExpression_h
+
+#include "cmStandardIncludes.h"
+
+#include <cmsys/RegularExpression.hxx>
+
+/** \class cmCTestRegularExpression
+ * \brief Regular expression used to select tests by name or label.
+ *
+ * The expression is analyzed when compiled.  Expressions that are
+ * plain text, optionally anchored with ^ or $, are matched with string
+ * comparisons.  Other expressions are run through
+ * cmsys::RegularExpression, but only after checking for the literal
+ * text every match must start with.  Results may be memoized for
+ * strings that are matched repeatedly, such as labels.
+ */
+class cmCTestRegularExpression
+{
+public:
+  cmCTestRegularExpression();
+
+  /** Compile the given expression.  Returns false if it is invalid.  */
+  bool compile(std::string const& pattern);
+
+  /** Return whether the expression matches somewhere in the string.  */
+  bool find(std::string const& s);
+
+  /** Same as find, remembering the result for the string.  */
+  bool find_cached(std::string const& s);
+
+  bool is_valid() const { return this->Kind != Invalid; }
+
+private:
+  enum KindType { Invalid, Literal, Regex };
+  KindType Kind;
+  bool AnchorBegin;
+  bool AnchorEnd;
+  // Whole text of a Literal, or the required prefix of a Regex match.
+  std::string Text;
+  cmsys::RegularExpression RegularExpression;
+  std::map<std::string, bool> Cache;
+};
+
+#endif
@@ -16,9 +16,6 @@
 #include "cmSystemTools.h"
 #include "cm_curl.h"
 
-#include <cm_zlib.h>
-#include <cmsys/Base64.h>
-
 cmCTestRunTest::cmCTestRunTest(cmCTestTestHandler* handler)
 {
   this->CTest = handler->CTest;
@@ -32,6 +29,7 @@ cmCTestRunTest::cmCTestRunTest(cmCTestTestHandler* handler)
   this->ProcessOutput = "";
   this->CompressedOutput = "";
   this->CompressionRatio = 2;
+  this->DroppedRequiredFound = false;
   this->StopTimePassed = false;
 }
 
@@ -60,8 +58,14 @@ bool cmCTestRunTest::CheckOutput()
       // Store this line of output.
       cmCTestLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
                  this->GetIndex() << ": " << line << std::endl);
-      this->ProcessOutput += line;
-      this->ProcessOutput += "\n";
+      if(!this->OutputCapture.AppendLine(line))
+        {
+        this->CheckDroppedOutput(line);
+        }
+      else if(line.find("CTEST_FULL_OUTPUT") != line.npos)
+        {
+        this->OutputCapture.SetUnlimited();
+        }
       }
     else // if(p == cmsysProcess_Pipe_Timeout)
       {
@@ -72,75 +76,89 @@ bool cmCTestRunTest::CheckOutput()
 }
 
 //---------------------------------------------------------
-// Streamed compression of test output.  The compressed data
-// is appended to this->CompressedOutput
-void cmCTestRunTest::CompressOutput()
+void cmCTestRunTest::ConfigureOutputCapture()
 {
-  int ret;
-  z_stream strm;
-
-  unsigned char* in =
-    reinterpret_cast<unsigned char*>(
-    const_cast<char*>(this->ProcessOutput.c_str()));
-  //zlib makes the guarantee that this is the maximum output size
-  int outSize = static_cast<int>(
-    static_cast<double>(this->ProcessOutput.size()) * 1.001 + 13.0);
-  unsigned char* out = new unsigned char[outSize];
-
-  strm.zalloc = Z_NULL;
-  strm.zfree = Z_NULL;
-  strm.opaque = Z_NULL;
-  ret = deflateInit(&strm, -1); //default compression level
-  if (ret != Z_OK)
-    {
-    delete[] out;
-    return;
-    }
-
-  strm.avail_in = static_cast<uInt>(this->ProcessOutput.size());
-  strm.next_in = in;
-  strm.avail_out = outSize;
-  strm.next_out = out;
-  ret = deflate(&strm, Z_FINISH);
+  this->OutputCapture.SetCompress(!this->TestHandler->MemCheck &&
+                                  this->CTest->ShouldCompressTestOutput());
 
-  if(ret == Z_STREAM_ERROR || ret != Z_STREAM_END)
+  // MemCheck post-processing needs all of the output.
+  int limit = this->TestHandler->CustomMaximumCapturedTestOutputSize;
+  if(this->TestHandler->MemCheck || limit <= 0)
     {
-    cmCTestLog(this->CTest, ERROR_MESSAGE, "Error during output "
-      "compression. Sending uncompressed output." << std::endl);
-    delete[] out;
     return;
     }
 
-  (void)deflateEnd(&strm);
+  // Always keep at least as much as will be reported to the dashboard.
+  size_t tail = static_cast<size_t>(limit / 2);
+  size_t head = static_cast<size_t>(limit) - tail;
+  size_t passed = static_cast<size_t>(
+    this->TestHandler->CustomMaximumPassedTestOutputSize);
+  size_t failed = static_cast<size_t>(
+    this->TestHandler->CustomMaximumFailedTestOutputSize);
+  head = std::max(head, std::max(passed, failed));
+  this->OutputCapture.SetLimits(head, tail);
 
-  unsigned char *encoded_buffer
-    = new unsigned char[static_cast<int>(outSize * 1.5)];
-
-  unsigned long rlen
-    = cmsysBase64_Encode(out, strm.total_out, encoded_buffer, 1);
-
-  for(unsigned long i = 0; i < rlen; i++)
+  if(this->TestHandler->CustomTestOutputSpill)
     {
-    this->CompressedOutput += encoded_buffer[i];
+    cmOStringStream fname;
+    fname << this->CTest->GetBinaryDir()
+          << "/Testing/Temporary/TestOutput." << this->Index << ".log";
+    this->OutputCapture.SetSpillFile(fname.str());
     }
+}
 
-  if(strm.total_in)
+//---------------------------------------------------------
+void cmCTestRunTest::CheckDroppedOutput(std::string const& line)
+{
+  std::vector<std::pair<cmsys::RegularExpression,
+    std::string> >::iterator passIt;
+  if(!this->DroppedRequiredFound)
+    {
+    for ( passIt = this->TestProperties->RequiredRegularExpressions.begin();
+          passIt != this->TestProperties->RequiredRegularExpressions.end();
+          ++ passIt )
+      {
+      if ( passIt->first.find(line.c_str()) )
+        {
+        this->DroppedRequiredFound = true;
+        break;
+        }
+      }
+    }
+  if(this->DroppedErrorRegex.empty())
     {
-    this->CompressionRatio = static_cast<double>(strm.total_out) /
-                             static_cast<double>(strm.total_in);
+    for ( passIt = this->TestProperties->ErrorRegularExpressions.begin();
+          passIt != this->TestProperties->ErrorRegularExpressions.end();
+          ++ passIt )
+      {
+      if ( passIt->first.find(line.c_str()) )
+        {
+        this->DroppedErrorRegex = passIt->second;
+        break;
+        }
+      }
     }
+}
 
-  delete [] encoded_buffer;
-  delete [] out;
+//---------------------------------------------------------
+// The output is deflated as it is captured; finish the stream
+// and store the base64 encoded result in this->CompressedOutput
+void cmCTestRunTest::CompressOutput()
+{
+  if(!this->OutputCapture.GetCompressedOutput(this->CompressedOutput,
+                                              this->CompressionRatio))
+    {
+    cmCTestLog(this->CTest, ERROR_MESSAGE, "Error during output "
+      "compression. Sending uncompressed output." << std::endl);
+    }
 }
 
 //---------------------------------------------------------
 bool cmCTestRunTest::EndTest(size_t completed, size_t total, bool started)
 {
-  if ((!this->TestHandler->MemCheck &&
-      this->CTest->ShouldCompressTestOutput()) ||
-      (this->TestHandler->MemCheck &&
-      this->CTest->ShouldCompressMemCheckOutput()))
+  this->ProcessOutput = this->OutputCapture.GetOutput();
+  if (!this->TestHandler->MemCheck &&
+      this->CTest->ShouldCompressTestOutput())
     {
     this->CompressOutput();
     }
@@ -157,7 +175,11 @@ bool cmCTestRunTest::EndTest(size_t completed, size_t total, bool started)
   bool outputTestErrorsToConsole = false;
   if ( this->TestProperties->RequiredRegularExpressions.size() > 0 )
     {
-    bool found = false;
+    bool found = this->DroppedRequiredFound;
+    if ( found )
+      {
+      reason = "Required regular expression found.";
+      }
     for ( passIt = this->TestProperties->RequiredRegularExpressions.begin();
           passIt != this->TestProperties->RequiredRegularExpressions.end();
           ++ passIt )
@@ -200,6 +222,14 @@ bool cmCTestRunTest::EndTest(size_t completed, size_t total, bool started)
         break;
         }
       }
+    if ( !forceFail && !this->DroppedErrorRegex.empty() )
+      {
+      reason = "Error regular expression found in output.";
+      reason += " Regex=[";
+      reason += this->DroppedErrorRegex;
+      reason += "]";
+      forceFail = true;
+      }
     }
   if (res == cmsysProcess_State_Exited)
     {
@@ -403,9 +433,15 @@ void cmCTestRunTest::MemCheckPostProcess()
     case cmCTestMemCheckHandler::BOUNDS_CHECKER:
       handler->PostProcessBoundsCheckerTest(this->TestResult, this->Index);
       break;
+    case cmCTestMemCheckHandler::ADDRESS_SANITIZER:
+    case cmCTestMemCheckHandler::LEAK_SANITIZER:
+    case cmCTestMemCheckHandler::THREAD_SANITIZER:
+      handler->PostProcessSanitizerTest(this->TestResult, this->Index);
+      break;
     default:
       break;
     }
+  handler->ProcessTestResult(this->TestResult);
 }
 
 //----------------------------------------------------------------------
@@ -492,6 +528,7 @@ bool cmCTestRunTest::StartTest(size_t total)
     return false;
     }
   this->StartTime = this->CTest->CurrentTime();
+  this->ConfigureOutputCapture();
 
   double timeout = this->ResolveTimeout();
 
@@ -499,6 +536,15 @@ bool cmCTestRunTest::StartTest(size_t total)
     {
     return false;
     }
+  if(this->TestHandler->MemCheck)
+    {
+    cmCTestMemCheckHandler * handler = static_cast<cmCTestMemCheckHandler*>
+      (this->TestHandler);
+    std::vector<std::string> environment = this->TestProperties->Environment;
+    handler->GenerateTestEnvironment(environment, this->Index);
+    return this->ForkProcess(timeout, this->TestProperties->ExplicitTimeout,
+                             &environment);
+    }
   return this->ForkProcess(timeout, this->TestProperties->ExplicitTimeout,
                            &this->TestProperties->Environment);
 }
@@ -511,7 +557,8 @@ void cmCTestRunTest::ComputeArguments()
   ++j; // skip test name
 
   // find the test executable
-  if(this->TestHandler->MemCheck)
+  if(this->TestHandler->MemCheck &&
+     !static_cast<cmCTestMemCheckHandler*>(this->TestHandler)->IsSanitizer())
     {
     cmCTestMemCheckHandler * handler = static_cast<cmCTestMemCheckHandler*>
       (this->TestHandler);
@@ -15,6 +15,7 @@
 #include <cmStandardIncludes.h>
 #include <cmCTestTestHandler.h>
 #include <cmProcess.h>
+#include <cmCTestOutputCapture.h>
 
 /** \class cmRunTest
  * \brief represents a single test to be run
@@ -47,7 +48,7 @@ public:
   // Read and store output.  Returns true if it must be called again.
   bool CheckOutput();
 
-  // Compresses the output, writing to CompressedOutput
+  // Finishes the streamed compression, writing to CompressedOutput
   void CompressOutput();
 
   //launch the test process, return whether it started correctly
@@ -60,6 +61,10 @@ public:
   void ComputeWeightedCost();
 private:
   void DartProcessing();
+  // Set up the bounded capture of the test output
+  void ConfigureOutputCapture();
+  // Match pass/fail regular expressions against output not kept in memory
+  void CheckDroppedOutput(std::string const& line);
   void ExeNotFound(std::string exe);
   // Figures out a final timeout which is min(STOP_TIME, NOW+TIMEOUT)
   double ResolveTimeout();
@@ -82,8 +87,12 @@ private:
   bool UsePrefixCommand;
   std::string PrefixCommand;
 
+  cmCTestOutputCapture OutputCapture;
   std::string ProcessOutput;
   std::string CompressedOutput;
+  // Results of regular expression matching against dropped output
+  bool DroppedRequiredFound;
+  std::string DroppedErrorRegex;
   double CompressionRatio;
   //The test results
   cmCTestTestHandler::cmCTestTestResult TestResult;
@@ -66,6 +66,8 @@ cmCTestGenericHandler* cmCTestSubmitCommand::InitializeHandler()
     "DropSitePassword", "CTEST_DROP_SITE_PASSWORD");
   this->CTest->SetCTestConfigurationFromCMakeVariable(this->Makefile,
     "ScpCommand", "CTEST_SCP_COMMAND");
+  this->CTest->SetCTestConfigurationFromCMakeVariable(this->Makefile,
+    "SubmitCompression", "CTEST_SUBMIT_COMPRESSION");
 
   const char* notesFilesVariable
     = this->Makefile->GetDefinition("CTEST_NOTES_FILES");
@@ -26,6 +26,9 @@
 // For curl submission
 #include "cm_curl.h"
 
+// For compressed submission
+#include "cmCTestGzipSource.h"
+
 #include <sys/stat.h>
 
 #define SUBMIT_TIMEOUT_IN_SECONDS_DEFAULT 120
@@ -354,12 +357,36 @@ bool cmCTestSubmitHandler::SubmitUsingHTTP(const std::string& localprefix,
       verifyHostOff = true;
       }
     }
+
+  // Compress the files as they are uploaded.  This needs a chunked
+  // request body so it is not available with HTTP 1.0.
+  bool compress = cmSystemTools::IsOn(
+    this->CTest->GetCTestConfiguration("SubmitCompression").c_str());
+  if(compress && this->CTest->ShouldUseHTTP10())
+    {
+    cmCTestLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
+      "   Submission compression is not available with HTTP 1.0"
+      << std::endl);
+    compress = false;
+    }
+  struct curl_slist* headers = 0;
+  if(compress)
+    {
+    cmCTestLog(this->CTest, HANDLER_OUTPUT,
+      "   Compressing submitted files with gzip" << std::endl);
+    headers = ::curl_slist_append(headers, "Content-Encoding: gzip");
+    headers = ::curl_slist_append(headers, "Transfer-Encoding: chunked");
+    }
+  cmCTestGzipSource gzsrc;
+
+  /* get a curl handle, shared by all files so that the connection to
+     the server is reused */
+  curl = curl_easy_init();
+
   std::string::size_type kk;
   cmCTest::SetOfStrings::const_iterator file;
   for ( file = files.begin(); file != files.end(); ++file )
     {
-    /* get a curl handle */
-    curl = curl_easy_init();
     if(curl)
       {
       if(verifyPeerOff)
@@ -472,11 +499,25 @@ bool cmCTestSubmitHandler::SubmitUsingHTTP(const std::string& localprefix,
         cmCTestLog(this->CTest, ERROR_MESSAGE, "   Cannot find file: "
           << local_file << std::endl);
         ::curl_easy_cleanup(curl);
+        ::curl_slist_free_all(headers);
         ::curl_global_cleanup();
         return false;
         }
 
       ftpfile = cmsys::SystemTools::Fopen(local_file.c_str(), "rb");
+      if ( !ftpfile || (compress && !gzsrc.Start(ftpfile)) )
+        {
+        cmCTestLog(this->CTest, ERROR_MESSAGE, "   Cannot read file: "
+          << local_file << std::endl);
+        if ( ftpfile )
+          {
+          ::fclose(ftpfile);
+          }
+        ::curl_easy_cleanup(curl);
+        ::curl_slist_free_all(headers);
+        ::curl_global_cleanup();
+        return false;
+        }
       cmCTestLog(this->CTest, HANDLER_VERBOSE_OUTPUT, "   Upload file: "
         << local_file << " to "
         << upload_as << " Size: " << st.st_size << std::endl);
@@ -484,12 +525,27 @@ bool cmCTestSubmitHandler::SubmitUsingHTTP(const std::string& localprefix,
       // specify target
       ::curl_easy_setopt(curl,CURLOPT_URL, upload_as.c_str());
 
-      // now specify which file to upload
-      ::curl_easy_setopt(curl, CURLOPT_INFILE, ftpfile);
+      if(compress)
+        {
+        // upload the file through the compressor, size unknown
+        ::curl_easy_setopt(curl, CURLOPT_READFUNCTION,
+          cmCTestGzipSource::ReadCallback);
+        ::curl_easy_setopt(curl, CURLOPT_INFILE, &gzsrc);
+        ::curl_easy_setopt(curl, CURLOPT_IOCTLFUNCTION,
+          cmCTestGzipSource::IoctlCallback);
+        ::curl_easy_setopt(curl, CURLOPT_IOCTLDATA, &gzsrc);
+        ::curl_easy_setopt(curl, CURLOPT_INFILESIZE, -1L);
+        ::curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+        }
+      else
+        {
+        // now specify which file to upload
+        ::curl_easy_setopt(curl, CURLOPT_INFILE, ftpfile);
 
-      // and give the size of the upload (optional)
-      ::curl_easy_setopt(curl, CURLOPT_INFILESIZE,
-        static_cast<long>(st.st_size));
+        // and give the size of the upload (optional)
+        ::curl_easy_setopt(curl, CURLOPT_INFILESIZE,
+          static_cast<long>(st.st_size));
+        }
 
       // and give curl the buffer for errors
       ::curl_easy_setopt(curl, CURLOPT_ERRORBUFFER, &error_buffer);
@@ -567,7 +623,23 @@ bool cmCTestSubmitHandler::SubmitUsingHTTP(const std::string& localprefix,
 
           ::fclose(ftpfile);
           ftpfile = cmsys::SystemTools::Fopen(local_file.c_str(), "rb");
-          ::curl_easy_setopt(curl, CURLOPT_INFILE, ftpfile);
+          if ( !ftpfile || (compress && !gzsrc.Start(ftpfile)) )
+            {
+            cmCTestLog(this->CTest, ERROR_MESSAGE, "   Cannot read file: "
+              << local_file << std::endl);
+            if ( ftpfile )
+              {
+              ::fclose(ftpfile);
+              }
+            ::curl_easy_cleanup(curl);
+            ::curl_slist_free_all(headers);
+            ::curl_global_cleanup();
+            return false;
+            }
+          if(!compress)
+            {
+            ::curl_easy_setopt(curl, CURLOPT_INFILE, ftpfile);
+            }
 
           chunk.clear();
           chunkDebug.clear();
@@ -614,15 +686,26 @@ bool cmCTestSubmitHandler::SubmitUsingHTTP(const std::string& localprefix,
                      << std::endl);
           }
         ::curl_easy_cleanup(curl);
+        ::curl_slist_free_all(headers);
         ::curl_global_cleanup();
         return false;
         }
-      // always cleanup
-      ::curl_easy_cleanup(curl);
       cmCTestLog(this->CTest, HANDLER_OUTPUT, "   Uploaded: " + local_file
         << std::endl);
+      if(compress)
+        {
+        cmCTestLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
+          "   Compressed " << gzsrc.GetBytesRead() << " bytes to "
+          << gzsrc.GetBytesSent() << " bytes" << std::endl);
+        }
       }
     }
+  // always cleanup
+  if(curl)
+    {
+    ::curl_easy_cleanup(curl);
+    }
+  ::curl_slist_free_all(headers);
   ::curl_global_cleanup();
   return true;
 }
@@ -28,6 +28,8 @@
 #include "cmCommand.h"
 #include "cmSystemTools.h"
 #include "cmXMLSafe.h"
+#include "cmXMLWriter.h"
+#include "cmVersion.h"
 #include "cm_utf8.h"
 
 #include <stdlib.h>
@@ -391,11 +393,16 @@ cmCTestTestHandler::cmCTestTestHandler()
 
   this->CustomMaximumPassedTestOutputSize = 1 * 1024;
   this->CustomMaximumFailedTestOutputSize = 300 * 1024;
+  this->CustomMaximumCapturedTestOutputSize = 4 * 1024 * 1024;
+  this->CustomTestOutputSpill = false;
 
   this->MemCheck = false;
 
   this->LogFile = 0;
 
+  this->RecordTestfileCommands = false;
+  this->TestIndexSize = 0;
+
   // regex to detect <DartMeasurement>...</DartMeasurement>
   this->DartStuff.compile(
     "(<DartMeasurement.*/DartMeasurement[a-zA-Z]*>)");
@@ -421,6 +428,8 @@ void cmCTestTestHandler::Initialize()
   this->CustomPostTest.clear();
   this->CustomMaximumPassedTestOutputSize = 1 * 1024;
   this->CustomMaximumFailedTestOutputSize = 300 * 1024;
+  this->CustomMaximumCapturedTestOutputSize = 4 * 1024 * 1024;
+  this->CustomTestOutputSpill = false;
 
   this->TestsToRun.clear();
 
@@ -429,14 +438,17 @@ void cmCTestTestHandler::Initialize()
   this->UseIncludeRegExpFlag = false;
   this->UseExcludeRegExpFlag = false;
   this->UseExcludeRegExpFirst = false;
-  this->IncludeLabelRegularExpression = "";
-  this->ExcludeLabelRegularExpression = "";
+  this->IncludeLabelRegExp = "";
+  this->ExcludeLabelRegExp = "";
   this->IncludeRegExp = "";
   this->ExcludeRegExp = "";
 
   TestsToRunString = "";
   this->UseUnion = false;
   this->TestList.clear();
+  this->TestIndex.clear();
+  this->TestIndexSize = 0;
+  this->TestfileCommands.clear();
 }
 
 //----------------------------------------------------------------------
@@ -455,6 +467,13 @@ void cmCTestTestHandler::PopulateCustomVectors(cmMakefile *mf)
   this->CTest->PopulateCustomInteger(mf,
                              "CTEST_CUSTOM_MAXIMUM_FAILED_TEST_OUTPUT_SIZE",
                              this->CustomMaximumFailedTestOutputSize);
+  this->CTest->PopulateCustomInteger(mf,
+                             "CTEST_CUSTOM_MAXIMUM_TEST_OUTPUT_CAPTURE_SIZE",
+                             this->CustomMaximumCapturedTestOutputSize);
+  if(const char* spill = mf->GetDefinition("CTEST_CUSTOM_TEST_OUTPUT_SPILL"))
+    {
+    this->CustomTestOutputSpill = cmSystemTools::IsOn(spill);
+    }
 }
 
 //----------------------------------------------------------------------
@@ -509,7 +528,7 @@ int cmCTestTestHandler::ProcessHandler()
   if ( val )
     {
     this->UseExcludeLabelRegExpFlag = true;
-    this->ExcludeLabelRegularExpression = val;
+    this->ExcludeLabelRegExp = val;
     }
   val = this->GetOption("IncludeRegularExpression");
   if ( val )
@@ -749,9 +768,10 @@ void cmCTestTestHandler::CheckLabelFilterInclude(cmCTestTestProperties& it)
   for(std::vector<std::string>::iterator l = it.Labels.begin();
       l !=  it.Labels.end(); ++l)
     {
-    if(this->IncludeLabelRegularExpression.find(*l))
+    if(this->IncludeLabelRegularExpression.find_cached(*l))
       {
       found = true;
+      break;
       }
     }
   // if no match was found, exclude the test
@@ -782,9 +802,10 @@ void cmCTestTestHandler::CheckLabelFilterExclude(cmCTestTestProperties& it)
   for(std::vector<std::string>::iterator l = it.Labels.begin();
       l !=  it.Labels.end(); ++l)
     {
-    if(this->ExcludeLabelRegularExpression.find(*l))
+    if(this->ExcludeLabelRegularExpression.find_cached(*l))
       {
       found = true;
+      break;
       }
     }
   // if match was found, exclude the test
@@ -805,6 +826,8 @@ void cmCTestTestHandler::CheckLabelFilter(cmCTestTestProperties& it)
 void cmCTestTestHandler::ComputeTestList()
 {
   this->TestList.clear(); // clear list of test
+  this->TestIndex.clear();
+  this->TestIndexSize = 0;
   this->GetListOfTests();
 
   if (this->RerunFailed)
@@ -813,6 +836,8 @@ void cmCTestTestHandler::ComputeTestList()
     return;
     }
 
+  double startTime = cmSystemTools::GetTime();
+
   cmCTestTestHandler::ListOfTests::size_type tmsize = this->TestList.size();
   // how many tests are in based on RegExp?
   int inREcnt = 0;
@@ -834,6 +859,8 @@ void cmCTestTestHandler::ComputeTestList()
     {
     this->ExpandTestsToRunInformation(inREcnt);
     }
+  std::set<int> testsToRun(this->TestsToRun.begin(),
+                           this->TestsToRun.end());
   // Now create a final list of tests to run
   int cnt = 0;
   inREcnt = 0;
@@ -850,9 +877,9 @@ void cmCTestTestHandler::ComputeTestList()
     if (this->UseUnion)
       {
       // if it is not in the list and not in the regexp then skip
-      if ((this->TestsToRun.size() &&
-           std::find(this->TestsToRun.begin(), this->TestsToRun.end(), cnt)
-           == this->TestsToRun.end()) && !it->IsInBasedOnREOptions)
+      if ((!testsToRun.empty() &&
+           testsToRun.find(cnt) == testsToRun.end()) &&
+          !it->IsInBasedOnREOptions)
         {
         continue;
         }
@@ -860,10 +887,9 @@ void cmCTestTestHandler::ComputeTestList()
     else
       {
       // is this test in the list of tests to run? If not then skip it
-      if ((this->TestsToRun.size() &&
-           std::find(this->TestsToRun.begin(),
-                     this->TestsToRun.end(), inREcnt)
-           == this->TestsToRun.end()) || !it->IsInBasedOnREOptions)
+      if ((!testsToRun.empty() &&
+           testsToRun.find(inREcnt) == testsToRun.end()) ||
+          !it->IsInBasedOnREOptions)
         {
         continue;
         }
@@ -874,9 +900,15 @@ void cmCTestTestHandler::ComputeTestList()
   // Save the total number of tests before exclusions
   this->TotalNumberOfTests = this->TestList.size();
   // Set the TestList to the final list of all test
-  this->TestList = finalList;
+  this->TestList.swap(finalList);
+  this->TestIndex.clear();
+  this->TestIndexSize = 0;
 
   this->UpdateMaxTestNameWidth();
+  cmCTestLog(this->CTest, HANDLER_VERBOSE_OUTPUT, "Selected "
+    << this->TestList.size() << " of " << this->TotalNumberOfTests
+    << " tests in " << (cmSystemTools::GetTime() - startTime)
+    << " sec" << std::endl);
 }
 
 void cmCTestTestHandler::ComputeTestListForRerunFailed()
@@ -1152,46 +1184,38 @@ void cmCTestTestHandler::GenerateDartOutput(std::ostream& os)
     }
 
   this->CTest->StartXML(os, this->AppendXML);
-  os << "<Testing>\n"
-    << "\t<StartDateTime>" << this->StartTest << "</StartDateTime>\n"
-    << "\t<StartTestTime>" << this->StartTestTime << "</StartTestTime>\n"
-    << "\t<TestList>\n";
+  cmXMLWriter xml(os);
+  xml.StartElement("Testing");
+  xml.Element("StartDateTime", this->StartTest);
+  xml.Element("StartTestTime", this->StartTestTime);
+  xml.StartElement("TestList");
   cmCTestTestHandler::TestResultsVector::size_type cc;
   for ( cc = 0; cc < this->TestResults.size(); cc ++ )
     {
     cmCTestTestResult *result = &this->TestResults[cc];
     std::string testPath = result->Path + "/" + result->Name;
-    os << "\t\t<Test>" << cmXMLSafe(
-      this->CTest->GetShortPathToFile(testPath.c_str()))
-      << "</Test>" << std::endl;
+    xml.Element("Test",
+      this->CTest->GetShortPathToFile(testPath.c_str()));
     }
-  os << "\t</TestList>\n";
+  xml.EndElement(); // TestList
   for ( cc = 0; cc < this->TestResults.size(); cc ++ )
     {
     cmCTestTestResult *result = &this->TestResults[cc];
-    this->WriteTestResultHeader(os, result);
-    os << "\t\t<Results>" << std::endl;
+    this->WriteTestResultHeader(xml, result);
+    xml.StartElement("Results");
     if ( result->Status != cmCTestTestHandler::NOT_RUN )
       {
       if ( result->Status != cmCTestTestHandler::COMPLETED ||
         result->ReturnValue )
         {
-        os << "\t\t\t<NamedMeasurement type=\"text/string\" "
-          "name=\"Exit Code\"><Value>"
-          << cmXMLSafe(this->GetTestStatus(result->Status))
-          << "</Value>"
-          "</NamedMeasurement>\n"
-          << "\t\t\t<NamedMeasurement type=\"text/string\" "
-          "name=\"Exit Value\"><Value>"
-          << result->ReturnValue
-          << "</Value></NamedMeasurement>"
-          << std::endl;
+        this->WriteNamedMeasurement(xml, "text/string", "Exit Code",
+                                    this->GetTestStatus(result->Status));
+        this->WriteNamedMeasurement(xml, "text/string", "Exit Value",
+                                    result->ReturnValue);
         }
-      os << result->RegressionImages;
-      os << "\t\t\t<NamedMeasurement type=\"numeric/double\" "
-        << "name=\"Execution Time\"><Value>"
-        << result->ExecutionTime
-        << "</Value></NamedMeasurement>\n";
+      xml.Fragment(result->RegressionImages);
+      this->WriteNamedMeasurement(xml, "numeric/double", "Execution Time",
+                                  result->ExecutionTime);
       if(result->Reason.size())
         {
         const char* reasonType = "Pass Reason";
@@ -1200,109 +1224,107 @@ void cmCTestTestHandler::GenerateDartOutput(std::ostream& os)
           {
           reasonType = "Fail Reason";
           }
-        os << "\t\t\t<NamedMeasurement type=\"text/string\" "
-           << "name=\"" << reasonType << "\"><Value>"
-           << cmXMLSafe(result->Reason)
-           << "</Value></NamedMeasurement>\n";
+        this->WriteNamedMeasurement(xml, "text/string", reasonType,
+                                    result->Reason);
         }
-      os
-        << "\t\t\t<NamedMeasurement type=\"text/string\" "
-        << "name=\"Completion Status\"><Value>"
-        << cmXMLSafe(result->CompletionStatus)
-        << "</Value></NamedMeasurement>\n";
-      }
-    os
-      << "\t\t\t<NamedMeasurement type=\"text/string\" "
-      << "name=\"Command Line\"><Value>"
-      << cmXMLSafe(result->FullCommandLine)
-      << "</Value></NamedMeasurement>\n";
+      this->WriteNamedMeasurement(xml, "text/string", "Completion Status",
+                                  result->CompletionStatus);
+      }
+    this->WriteNamedMeasurement(xml, "text/string", "Command Line",
+                                result->FullCommandLine);
     std::map<std::string,std::string>::iterator measureIt;
     for ( measureIt = result->Properties->Measurements.begin();
       measureIt != result->Properties->Measurements.end();
       ++ measureIt )
       {
-      os
-        << "\t\t\t<NamedMeasurement type=\"text/string\" "
-        << "name=\"" << measureIt->first << "\"><Value>"
-        << cmXMLSafe(measureIt->second)
-        << "</Value></NamedMeasurement>\n";
-      }
-    os
-      << "\t\t\t<Measurement>\n"
-      << "\t\t\t\t<Value"
-      << (result->CompressOutput ?
-      " encoding=\"base64\" compression=\"gzip\">"
-      : ">");
-    os << cmXMLSafe(result->Output);
-    os
-      << "</Value>\n"
-      << "\t\t\t</Measurement>\n"
-      << "\t\t</Results>\n";
-
-    this->AttachFiles(os, result);
-    this->WriteTestResultFooter(os, result);
-    }
-
-  os << "\t<EndDateTime>" << this->EndTest << "</EndDateTime>\n"
-     << "\t<EndTestTime>" << this->EndTestTime << "</EndTestTime>\n"
-     << "<ElapsedMinutes>"
-     << static_cast<int>(this->ElapsedTestingTime/6)/10.0
-     << "</ElapsedMinutes>"
-    << "</Testing>" << std::endl;
+      this->WriteNamedMeasurement(xml, "text/string", measureIt->first,
+                                  measureIt->second);
+      }
+    xml.StartElement("Measurement");
+    xml.StartElement("Value");
+    if (result->CompressOutput)
+      {
+      xml.Attribute("encoding", "base64");
+      xml.Attribute("compression", "gzip");
+      }
+    xml.Content(result->Output);
+    xml.EndElement(); // Value
+    xml.EndElement(); // Measurement
+    xml.EndElement(); // Results
+
+    this->AttachFiles(xml, result);
+    this->WriteTestResultFooter(xml, result);
+    xml.Flush();
+    }
+
+  xml.Element("EndDateTime", this->EndTest);
+  xml.Element("EndTestTime", this->EndTestTime);
+  xml.Element("ElapsedMinutes",
+    static_cast<int>(this->ElapsedTestingTime/6)/10.0);
+  xml.EndElement(); // Testing
+  xml.Flush();
   this->CTest->EndXML(os);
 }
 
 //----------------------------------------------------------------------------
-void cmCTestTestHandler::WriteTestResultHeader(std::ostream& os,
+template <typename T>
+void cmCTestTestHandler::WriteNamedMeasurement(cmXMLWriter& xml,
+                                               const char* type,
+                                               std::string const& name,
+                                               T const& value)
+{
+  xml.StartElement("NamedMeasurement");
+  xml.Attribute("type", type);
+  xml.Attribute("name", name);
+  xml.Element("Value", value);
+  xml.EndElement();
+}
+
+//----------------------------------------------------------------------------
+void cmCTestTestHandler::WriteTestResultHeader(cmXMLWriter& xml,
                                                cmCTestTestResult* result)
 {
-  os << "\t<Test Status=\"";
+  xml.StartElement("Test");
   if ( result->Status == cmCTestTestHandler::COMPLETED )
     {
-    os << "passed";
+    xml.Attribute("Status", "passed");
     }
   else if ( result->Status == cmCTestTestHandler::NOT_RUN )
     {
-    os << "notrun";
+    xml.Attribute("Status", "notrun");
     }
   else
     {
-    os << "failed";
+    xml.Attribute("Status", "failed");
     }
   std::string testPath = result->Path + "/" + result->Name;
-  os << "\">\n"
-     << "\t\t<Name>" << cmXMLSafe(result->Name) << "</Name>\n"
-     << "\t\t<Path>" << cmXMLSafe(
-       this->CTest->GetShortPathToFile(result->Path.c_str())) << "</Path>\n"
-     << "\t\t<FullName>" << cmXMLSafe(
-       this->CTest->GetShortPathToFile(testPath.c_str())) << "</FullName>\n"
-     << "\t\t<FullCommandLine>"
-     << cmXMLSafe(result->FullCommandLine)
-     << "</FullCommandLine>\n";
+  xml.Element("Name", result->Name);
+  xml.Element("Path", this->CTest->GetShortPathToFile(result->Path.c_str()));
+  xml.Element("FullName", this->CTest->GetShortPathToFile(testPath.c_str()));
+  xml.Element("FullCommandLine", result->FullCommandLine);
 }
 
 //----------------------------------------------------------------------------
-void cmCTestTestHandler::WriteTestResultFooter(std::ostream& os,
+void cmCTestTestHandler::WriteTestResultFooter(cmXMLWriter& xml,
                                                cmCTestTestResult* result)
 {
   if(!result->Properties->Labels.empty())
     {
-    os << "\t\t<Labels>\n";
+    xml.StartElement("Labels");
     std::vector<std::string> const& labels = result->Properties->Labels;
     for(std::vector<std::string>::const_iterator li = labels.begin();
         li != labels.end(); ++li)
       {
-      os << "\t\t\t<Label>" << cmXMLSafe(*li) << "</Label>\n";
+      xml.Element("Label", *li);
       }
-    os << "\t\t</Labels>\n";
+    xml.EndElement(); // Labels
     }
 
-  os
-    << "\t</Test>" << std::endl;
+  xml.EndElement(); // Test
 }
 
 //----------------------------------------------------------------------
-void cmCTestTestHandler::AttachFiles(std::ostream& os,
+void cmCTestTestHandler::AttachFiles(cmXMLWriter& xml,
                                      cmCTestTestResult* result)
 {
   if(result->Status != cmCTestTestHandler::COMPLETED
@@ -1319,11 +1341,14 @@ void cmCTestTestHandler::AttachFiles(std::ostream& os,
     {
     std::string base64 = this->CTest->Base64GzipEncodeFile(*file);
     std::string fname = cmSystemTools::GetFilenameName(*file);
-    os << "\t\t<NamedMeasurement name=\"Attached File\" encoding=\"base64\" "
-      "compression=\"tar/gzip\" filename=\"" << fname << "\" type=\"file\">"
-      "\n\t\t\t<Value>\n\t\t\t"
-      << base64
-      << "\n\t\t\t</Value>\n\t\t</NamedMeasurement>\n";
+    xml.StartElement("NamedMeasurement");
+    xml.Attribute("name", "Attached File");
+    xml.Attribute("encoding", "base64");
+    xml.Attribute("compression", "tar/gzip");
+    xml.Attribute("filename", fname);
+    xml.Attribute("type", "file");
+    xml.Element("Value", base64);
+    xml.EndElement(); // NamedMeasurement
     }
 }
 
@@ -1555,22 +1580,52 @@ void cmCTestTestHandler::GetListOfTests()
 {
   if ( !this->IncludeLabelRegExp.empty() )
     {
-    this->IncludeLabelRegularExpression.
-      compile(this->IncludeLabelRegExp.c_str());
+    this->IncludeLabelRegularExpression.compile(this->IncludeLabelRegExp);
     }
-  if ( !this->IncludeLabelRegExp.empty() )
+  if ( !this->ExcludeLabelRegExp.empty() )
     {
-    this->ExcludeLabelRegularExpression.
-      compile(this->ExcludeLabelRegExp.c_str());
+    this->ExcludeLabelRegularExpression.compile(this->ExcludeLabelRegExp);
     }
   if ( !this->IncludeRegExp.empty() )
     {
-    this->IncludeTestsRegularExpression.compile(this->IncludeRegExp.c_str());
+    this->IncludeTestsRegularExpression.compile(this->IncludeRegExp);
     }
   if ( !this->ExcludeRegExp.empty() )
     {
-    this->ExcludeTestsRegularExpression.compile(this->ExcludeRegExp.c_str());
+    this->ExcludeTestsRegularExpression.compile(this->ExcludeRegExp);
+    }
+  const char* testFilename;
+  if( cmSystemTools::FileExists("CTestTestfile.cmake") )
+    {
+    // does the CTestTestfile.cmake exist ?
+    testFilename = "CTestTestfile.cmake";
+    }
+  else if( cmSystemTools::FileExists("DartTestfile.txt") )
+    {
+    // does the DartTestfile.txt exist ?
+    testFilename = "DartTestfile.txt";
     }
+  else
+    {
+    return;
+    }
+
+  // Replay the tests recorded by a previous run if no testfile changed.
+  // The environment variable CTEST_TESTFILE_CACHE may turn this off.
+  bool useCache = true;
+  if(const char* useCacheVar = cmSystemTools::GetEnv("CTEST_TESTFILE_CACHE"))
+    {
+    useCache = !cmSystemTools::IsOff(useCacheVar);
+    }
+  std::string cacheFile = cmSystemTools::GetCurrentWorkingDirectory();
+  cacheFile += "/CTestTestfile.cache";
+  if(useCache && this->ReadTestfileCache(cacheFile, testFilename))
+    {
+    cmCTestLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
+      "Done constructing a list of tests from " << cacheFile << std::endl);
+    return;
+    }
+
   cmCTestLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
     "Constructing a list of tests" << std::endl);
   cmake cm;
@@ -1604,32 +1659,263 @@ void cmCTestTestHandler::GetListOfTests()
   newCom4->TestHandler = this;
   cm.AddCommand(newCom4);
 
-  const char* testFilename;
-  if( cmSystemTools::FileExists("CTestTestfile.cmake") )
+  long startTime = static_cast<long>(time(0));
+  this->TestfileCommands.clear();
+  this->RecordTestfileCommands = true;
+  bool readit = mf->ReadListFile(0, testFilename);
+  this->RecordTestfileCommands = false;
+  if ( !readit )
     {
-    // does the CTestTestfile.cmake exist ?
-    testFilename = "CTestTestfile.cmake";
+    return;
     }
-  else if( cmSystemTools::FileExists("DartTestfile.txt") )
+  if ( cmSystemTools::GetErrorOccuredFlag() )
     {
-    // does the DartTestfile.txt exist ?
-    testFilename = "DartTestfile.txt";
+    return;
     }
-  else
+  if(useCache)
     {
-    return;
+    this->WriteTestfileCache(cacheFile, testFilename,
+                             mf->GetListFiles(), startTime);
     }
+  cmCTestLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
+    "Done constructing a list of tests" << std::endl);
+}
 
-  if ( !mf->ReadListFile(0, testFilename) )
+//----------------------------------------------------------------------
+// The test list cache is a sequence of length-prefixed strings:
+// a format tag, the ctest version, the configuration, the top-level
+// testfile name and the time the testfiles were read, followed by
+// the (path, mtime, size) of every file read and the recorded
+// add_test and set_tests_properties calls.
+static const char* cmCTestTestfileCacheTag = "CTestTestfileCache-1";
+
+//----------------------------------------------------------------------
+static void cmCTestTestfileCacheWrite(std::ostream& fout,
+                                      std::string const& s)
+{
+  fout << s.size() << ":" << s;
+}
+
+//----------------------------------------------------------------------
+template <typename T>
+static void cmCTestTestfileCacheWriteNumber(std::ostream& fout, T n)
+{
+  cmOStringStream str;
+  str << n;
+  cmCTestTestfileCacheWrite(fout, str.str());
+}
+
+//----------------------------------------------------------------------
+class cmCTestTestfileCacheParser
+{
+public:
+  cmCTestTestfileCacheParser(const char* begin, const char* end):
+    Begin(begin), End(end) {}
+  bool Read(std::string& s)
     {
-    return;
+    char* colon;
+    unsigned long length = strtoul(this->Begin, &colon, 10);
+    if(colon == this->Begin || colon >= this->End || *colon != ':' ||
+       static_cast<unsigned long>(this->End - colon - 1) < length)
+      {
+      return false;
+      }
+    s.assign(colon + 1, length);
+    this->Begin = colon + 1 + length;
+    return true;
     }
-  if ( cmSystemTools::GetErrorOccuredFlag() )
+  bool Read(unsigned long& n)
+    {
+    std::string s;
+    if(!this->Read(s) || s.empty())
+      {
+      return false;
+      }
+    char* end;
+    n = strtoul(s.c_str(), &end, 10);
+    return *end == 0;
+    }
+  bool AtEnd() const { return this->Begin == this->End; }
+private:
+  const char* Begin;
+  const char* End;
+};
+
+//----------------------------------------------------------------------
+static std::string cmCTestTestfileStamp(std::string const& fname)
+{
+  if(!cmSystemTools::FileExists(fname.c_str()))
+    {
+    return "";
+    }
+  cmOStringStream str;
+  str << cmSystemTools::ModifiedTime(fname.c_str()) << " "
+      << cmSystemTools::FileLength(fname.c_str());
+  return str.str();
+}
+
+//----------------------------------------------------------------------
+// Whether the file is a testfile generated by CMake.  These contain
+// only the commands recorded in the cache and includes of the
+// TEST_INCLUDE_FILE directory property.
+static bool cmCTestTestfileIsGenerated(std::string const& fname)
+{
+  cmsys::ifstream fin(fname.c_str());
+  std::string line;
+  return fin && cmSystemTools::GetLineFromStream(fin, line) &&
+    line == "# CMake generated Testfile for ";
+}
+
+//----------------------------------------------------------------------
+bool cmCTestTestHandler::ReadTestfileCache(std::string const& fname,
+                                           const char* testFilename)
+{
+  unsigned long length = cmSystemTools::FileLength(fname.c_str());
+  if(length == 0)
+    {
+    return false;
+    }
+  std::vector<char> data(length + 1, 0);
+  cmsys::ifstream fin(fname.c_str(), std::ios::in | std::ios::binary);
+  if(!fin || !fin.read(&data[0], length))
+    {
+    return false;
+    }
+  cmCTestTestfileCacheParser parser(&data[0], &data[0] + length);
+
+  std::string tag, version, config, testfile, time;
+  if(!parser.Read(tag) || tag != cmCTestTestfileCacheTag ||
+     !parser.Read(version) || version != cmVersion::GetCMakeVersion() ||
+     !parser.Read(config) || config != this->CTest->GetConfigType() ||
+     !parser.Read(testfile) || testfile != testFilename ||
+     !parser.Read(time))
+    {
+    return false;
+    }
+  long readTime = atol(time.c_str());
+
+  // Every file read by the testfiles must be unchanged since.
+  unsigned long numFiles;
+  if(!parser.Read(numFiles))
+    {
+    return false;
+    }
+  for(unsigned long i = 0; i < numFiles; ++i)
+    {
+    std::string file, stamp;
+    if(!parser.Read(file) || !parser.Read(stamp) ||
+       stamp != cmCTestTestfileStamp(file) ||
+       cmSystemTools::ModifiedTime(file.c_str()) >= readTime)
+      {
+      return false;
+      }
+    }
+
+  unsigned long numCommands;
+  if(!parser.Read(numCommands))
+    {
+    return false;
+    }
+  std::vector<std::vector<std::string> > commands(numCommands);
+  for(unsigned long i = 0; i < numCommands; ++i)
+    {
+    unsigned long numArgs;
+    if(!parser.Read(numArgs) || numArgs < 2)
+      {
+      return false;
+      }
+    commands[i].resize(numArgs);
+    for(unsigned long j = 0; j < numArgs; ++j)
+      {
+      if(!parser.Read(commands[i][j]))
+        {
+        return false;
+        }
+      }
+    if(commands[i][0] == "add_test" && numArgs < 4)
+      {
+      return false;
+      }
+    }
+  if(!parser.AtEnd())
+    {
+    return false;
+    }
+
+  // Replay the recorded commands.
+  for(std::vector<std::vector<std::string> >::iterator
+        ci = commands.begin(); ci != commands.end(); ++ci)
+    {
+    if((*ci)[0] == "add_test")
+      {
+      std::vector<std::string> args(ci->begin() + 2, ci->end());
+      this->AddTest(args, (*ci)[1]);
+      }
+    else
+      {
+      std::vector<std::string> args(ci->begin() + 1, ci->end());
+      this->SetTestsProperties(args);
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------
+void cmCTestTestHandler::WriteTestfileCache(std::string const& fname,
+  const char* testFilename, std::vector<std::string> const& listFiles,
+  long readTime)
+{
+  // Other files read by the testfiles may depend on the environment or
+  // on files that are not tracked, so only generated testfiles that
+  // include nothing else are cached.
+  std::set<std::string> files;
+  for(std::vector<std::string>::const_iterator fi = listFiles.begin();
+      fi != listFiles.end(); ++fi)
+    {
+    std::string file = cmSystemTools::CollapseFullPath(fi->c_str());
+    if(!cmCTestTestfileIsGenerated(file))
+      {
+      cmCTestLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
+        "Not caching the list of tests: " << file
+        << " is not a generated testfile" << std::endl);
+      cmSystemTools::RemoveFile(fname.c_str());
+      return;
+      }
+    files.insert(file);
+    }
+
+  cmGeneratedFileStream fout;
+  fout.Open(fname.c_str(), true, true);
+  if(!fout)
     {
     return;
     }
-  cmCTestLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
-    "Done constructing a list of tests" << std::endl);
+  cmCTestTestfileCacheWrite(fout, cmCTestTestfileCacheTag);
+  cmCTestTestfileCacheWrite(fout, cmVersion::GetCMakeVersion());
+  cmCTestTestfileCacheWrite(fout, this->CTest->GetConfigType());
+  cmCTestTestfileCacheWrite(fout, testFilename);
+  cmCTestTestfileCacheWriteNumber(fout, readTime);
+
+  cmCTestTestfileCacheWriteNumber(fout, files.size());
+  for(std::set<std::string>::const_iterator fi = files.begin();
+      fi != files.end(); ++fi)
+    {
+    cmCTestTestfileCacheWrite(fout, *fi);
+    cmCTestTestfileCacheWrite(fout, cmCTestTestfileStamp(*fi));
+    }
+
+  cmCTestTestfileCacheWriteNumber(fout, this->TestfileCommands.size());
+  for(std::vector<std::vector<std::string> >::const_iterator
+        ci = this->TestfileCommands.begin();
+      ci != this->TestfileCommands.end(); ++ci)
+    {
+    cmCTestTestfileCacheWriteNumber(fout, ci->size());
+    for(std::vector<std::string>::const_iterator ai = ci->begin();
+        ai != ci->end(); ++ai)
+      {
+      cmCTestTestfileCacheWrite(fout, *ai);
+      }
+    }
 }
 
 //----------------------------------------------------------------------
@@ -2111,6 +2397,13 @@ bool cmCTestTestHandler::CleanTestOutput(std::string& output, size_t length)
 bool cmCTestTestHandler::SetTestsProperties(
   const std::vector<std::string>& args)
 {
+  if(this->RecordTestfileCommands)
+    {
+    std::vector<std::string> command;
+    command.push_back("set_tests_properties");
+    command.insert(command.end(), args.begin(), args.end());
+    this->TestfileCommands.push_back(command);
+    }
   std::vector<std::string>::const_iterator it;
   std::vector<std::string> tests;
   bool found = false;
@@ -2140,11 +2433,12 @@ bool cmCTestTestHandler::SetTestsProperties(
     std::vector<std::string>::const_iterator tit;
     for ( tit = tests.begin(); tit != tests.end(); ++ tit )
       {
-      cmCTestTestHandler::ListOfTests::iterator rtit;
-      for ( rtit = this->TestList.begin();
-        rtit != this->TestList.end();
-        ++ rtit )
+      std::vector<ListOfTests::size_type> const& indices =
+        this->GetTestIndices(*tit);
+      std::vector<ListOfTests::size_type>::const_iterator ii;
+      for ( ii = indices.begin(); ii != indices.end(); ++ ii )
         {
+        cmCTestTestProperties* rtit = &this->TestList[*ii];
         if ( *tit == rtit->Name )
           {
           if ( key == "WILL_FAIL" )
@@ -2307,13 +2601,29 @@ bool cmCTestTestHandler::SetTestsProperties(
 
 //----------------------------------------------------------------------
 bool cmCTestTestHandler::AddTest(const std::vector<std::string>& args)
+{
+  std::string directory = cmSystemTools::GetCurrentWorkingDirectory();
+  if(this->RecordTestfileCommands)
+    {
+    std::vector<std::string> command;
+    command.push_back("add_test");
+    command.push_back(directory);
+    command.insert(command.end(), args.begin(), args.end());
+    this->TestfileCommands.push_back(command);
+    }
+  return this->AddTest(args, directory);
+}
+
+//----------------------------------------------------------------------
+bool cmCTestTestHandler::AddTest(const std::vector<std::string>& args,
+                                 std::string const& directory)
 {
   const std::string& testname = args[0];
   cmCTestLog(this->CTest, DEBUG, "Add test: " << args[0] << std::endl);
 
   if (this->UseExcludeRegExpFlag &&
     this->UseExcludeRegExpFirst &&
-    this->ExcludeTestsRegularExpression.find(testname.c_str()))
+    this->ExcludeTestsRegularExpression.find(testname))
     {
     return true;
     }
@@ -2361,7 +2671,7 @@ bool cmCTestTestHandler::AddTest(const std::vector<std::string>& args)
   cmCTestTestProperties test;
   test.Name = testname;
   test.Args = args;
-  test.Directory = cmSystemTools::GetCurrentWorkingDirectory();
+  test.Directory = directory;
   cmCTestLog(this->CTest, DEBUG, "Set test directory: "
     << test.Directory << std::endl);
 
@@ -2375,17 +2685,42 @@ bool cmCTestTestHandler::AddTest(const std::vector<std::string>& args)
   test.SkipReturnCode = -1;
   test.PreviousRuns = 0;
   if (this->UseIncludeRegExpFlag &&
-    !this->IncludeTestsRegularExpression.find(testname.c_str()))
+    !this->IncludeTestsRegularExpression.find(testname))
     {
     test.IsInBasedOnREOptions = false;
     }
   else if (this->UseExcludeRegExpFlag &&
     !this->UseExcludeRegExpFirst &&
-    this->ExcludeTestsRegularExpression.find(testname.c_str()))
+    this->ExcludeTestsRegularExpression.find(testname))
     {
     test.IsInBasedOnREOptions = false;
     }
   this->TestList.push_back(test);
+  if(this->TestIndexSize + 1 == this->TestList.size())
+    {
+    this->TestIndex[testname].push_back(this->TestIndexSize++);
+    }
   return true;
 }
 
+//----------------------------------------------------------------------
+std::vector<cmCTestTestHandler::ListOfTests::size_type> const&
+cmCTestTestHandler::GetTestIndices(std::string const& name)
+{
+  // Rebuild the index if the list was changed behind our back.
+  if(this->TestIndexSize != this->TestList.size())
+    {
+    this->TestIndex.clear();
+    for(this->TestIndexSize = 0;
+        this->TestIndexSize != this->TestList.size(); ++this->TestIndexSize)
+      {
+      this->TestIndex[this->TestList[this->TestIndexSize].Name]
+        .push_back(this->TestIndexSize);
+      }
+    }
+  static std::vector<ListOfTests::size_type> const noTests;
+  std::map<std::string, std::vector<ListOfTests::size_type> >::iterator
+    i = this->TestIndex.find(name);
+  return i != this->TestIndex.end()? i->second : noTests;
+}
+
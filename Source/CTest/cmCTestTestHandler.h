@@ -15,9 +15,11 @@
 
 
 #include "cmCTestGenericHandler.h"
+#include "cmCTestRegularExpression.h"
 #include <cmsys/RegularExpression.hxx>
 
 class cmMakefile;
+class cmXMLWriter;
 
 /** \class cmCTestTestHandler
  * \brief A class that handles ctest -S invocations
@@ -164,10 +166,13 @@ protected:
   virtual void GenerateTestCommand(std::vector<std::string>& args, int test);
   int ExecuteCommands(std::vector<std::string>& vec);
 
-  void WriteTestResultHeader(std::ostream& os, cmCTestTestResult* result);
-  void WriteTestResultFooter(std::ostream& os, cmCTestTestResult* result);
+  void WriteTestResultHeader(cmXMLWriter& xml, cmCTestTestResult* result);
+  void WriteTestResultFooter(cmXMLWriter& xml, cmCTestTestResult* result);
   // Write attached test files into the xml
-  void AttachFiles(std::ostream& os, cmCTestTestResult* result);
+  void AttachFiles(cmXMLWriter& xml, cmCTestTestResult* result);
+  template <typename T>
+  void WriteNamedMeasurement(cmXMLWriter& xml, const char* type,
+                             std::string const& name, T const& value);
 
   //! Clean test output to specified length
   bool CleanTestOutput(std::string& output, size_t length);
@@ -185,7 +190,19 @@ protected:
   bool MemCheck;
   int CustomMaximumPassedTestOutputSize;
   int CustomMaximumFailedTestOutputSize;
+  // Bytes of output held in memory per running test (0 for no limit)
+  int CustomMaximumCapturedTestOutputSize;
+  // Write the full output of truncated tests to Testing/Temporary
+  bool CustomTestOutputSpill;
   int MaxIndex;
+
+  // add_test and set_tests_properties calls made by the testfiles
+  std::vector<std::vector<std::string> > TestfileCommands;
+  bool RecordTestfileCommands;
+
+  // index of TestList by test name, covering its first TestIndexSize tests
+  std::map<std::string, std::vector<ListOfTests::size_type> > TestIndex;
+  ListOfTests::size_type TestIndexSize;
 public:
   enum { // Program statuses
     NOT_RUN = 0,
@@ -227,6 +244,20 @@ private:
 
   void UpdateMaxTestNameWidth();
 
+  // add a test found in the given directory
+  bool AddTest(const std::vector<std::string>& args,
+               std::string const& directory);
+
+  // positions in TestList of the tests with the given name
+  std::vector<ListOfTests::size_type> const&
+  GetTestIndices(std::string const& name);
+
+  // replay the tests recorded in the test list cache if it is up to date
+  bool ReadTestfileCache(std::string const& fname, const char* testFilename);
+  void WriteTestfileCache(std::string const& fname, const char* testFilename,
+                          std::vector<std::string> const& listFiles,
+                          long readTime);
+
   bool GetValue(const char* tag,
                 std::string& value,
                 std::istream& fin);
@@ -265,10 +296,10 @@ private:
   std::string ExcludeLabelRegExp;
   std::string IncludeRegExp;
   std::string ExcludeRegExp;
-  cmsys::RegularExpression IncludeLabelRegularExpression;
-  cmsys::RegularExpression ExcludeLabelRegularExpression;
-  cmsys::RegularExpression IncludeTestsRegularExpression;
-  cmsys::RegularExpression ExcludeTestsRegularExpression;
+  cmCTestRegularExpression IncludeLabelRegularExpression;
+  cmCTestRegularExpression ExcludeLabelRegularExpression;
+  cmCTestRegularExpression IncludeTestsRegularExpression;
+  cmCTestRegularExpression ExcludeTestsRegularExpression;
 
   std::string GenerateRegressionImages(const std::string& xml);
   cmsys::RegularExpression DartStuff1;
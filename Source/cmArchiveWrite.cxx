@@ -15,8 +15,17 @@
 #include <cmsys/ios/iostream>
 #include <cmsys/Directory.hxx>
 #include <cmsys/FStream.hxx>
+#include <cmsys/MD5.h>
 #include <cm_libarchive.h>
 
+#if !defined(_WIN32) || defined(__CYGWIN__)
+# include <errno.h>
+# include <fcntl.h>
+# include <poll.h>
+# include <unistd.h>
+# define CM_ARCHIVE_WRITE_PIPE_COMPRESSOR
+#endif
+
 //----------------------------------------------------------------------------
 static std::string cm_archive_error_string(struct archive* a)
 {
@@ -42,9 +51,18 @@ struct cmArchiveWrite::Callback
                             const void *b, size_t n)
     {
     cmArchiveWrite* self = static_cast<cmArchiveWrite*>(cd);
+    if(self->CompressProcess)
+      {
+      if(self->WriteCompressor(static_cast<const char*>(b), n))
+        {
+        return static_cast<__LA_SSIZE_T>(n);
+        }
+      return static_cast<__LA_SSIZE_T>(-1);
+      }
     if(self->Stream.write(static_cast<const char*>(b),
                           static_cast<cmsys_ios::streamsize>(n)))
       {
+      self->BytesOut += n;
       return static_cast<__LA_SSIZE_T>(n);
       }
     else
@@ -55,12 +73,28 @@ struct cmArchiveWrite::Callback
 };
 
 //----------------------------------------------------------------------------
-cmArchiveWrite::cmArchiveWrite(std::ostream& os, Compress c, Type t):
+cmArchiveWrite::cmArchiveWrite(std::ostream& os, Compress c, Type t,
+                               unsigned int jobs):
   Stream(os),
   Archive(archive_write_new()),
   Disk(archive_read_disk_new()),
-  Verbose(false)
+  Verbose(false),
+  Closed(false),
+  UID(-1),
+  GID(-1),
+  ComputeMD5(false),
+  CompressProcess(0),
+  CompressIn(-1),
+  CompressOut(-1),
+  BytesIn(0),
+  BytesOut(0)
 {
+  // Hand the compression to an external program if it can use more
+  // than one processor.  The archive itself is then written plain.
+  if(t == TypeTAR && jobs > 1 && this->StartCompressor(c, jobs))
+    {
+    c = CompressNone;
+    }
   switch (c)
     {
     case CompressNone:
@@ -162,10 +196,254 @@ cmArchiveWrite::cmArchiveWrite(std::ostream& os, Compress c, Type t):
 //----------------------------------------------------------------------------
 cmArchiveWrite::~cmArchiveWrite()
 {
+  this->Close();
   archive_read_finish(this->Disk);
   archive_write_finish(this->Archive);
 }
 
+//----------------------------------------------------------------------------
+bool cmArchiveWrite::Close()
+{
+  if(this->Closed)
+    {
+    return this->Okay();
+    }
+  this->Closed = true;
+  if(archive_write_close(this->Archive) != ARCHIVE_OK && this->Okay())
+    {
+    this->Error = "archive_write_close: ";
+    this->Error += cm_archive_error_string(this->Archive);
+    }
+  this->BytesIn =
+    static_cast<cmIML_INT_uint64_t>(archive_filter_bytes(this->Archive, 0));
+  if(this->CompressProcess)
+    {
+    this->FinishCompressor();
+    }
+  return this->Okay();
+}
+
+#if defined(CM_ARCHIVE_WRITE_PIPE_COMPRESSOR)
+//----------------------------------------------------------------------------
+bool cmArchiveWrite::StartCompressor(Compress c, unsigned int jobs)
+{
+  // Programs compressing in parallel to a format the standard tools
+  // read, and how to tell them the number of jobs.
+  const char* program = 0;
+  const char* jobsFlag = 0;
+  bool jobsSeparate = false;
+  switch (c)
+    {
+    case CompressGZip: program = "pigz"; jobsFlag = "-p";
+      jobsSeparate = true; break;
+    case CompressBZip2: program = "pbzip2"; jobsFlag = "-p"; break;
+    case CompressXZ: program = "xz"; jobsFlag = "-T"; break;
+    default: return false;
+    }
+  std::string exe = cmSystemTools::FindProgram(program);
+  if(exe.empty())
+    {
+    return false;
+    }
+  cmOStringStream jobsArg;
+  jobsArg << jobs;
+  std::vector<std::string> args;
+  args.push_back(exe);
+  if(jobsSeparate)
+    {
+    args.push_back(jobsFlag);
+    args.push_back(jobsArg.str());
+    }
+  else
+    {
+    args.push_back(jobsFlag + jobsArg.str());
+    }
+  args.push_back("-c");
+  std::vector<const char*> cmd;
+  for(std::vector<std::string>::const_iterator a = args.begin();
+      a != args.end(); ++a)
+    {
+    cmd.push_back(a->c_str());
+    }
+  cmd.push_back(0);
+
+  int in[2];
+  int out[2];
+  if(pipe(in) < 0)
+    {
+    return false;
+    }
+  if(pipe(out) < 0)
+    {
+    close(in[0]);
+    close(in[1]);
+    return false;
+    }
+  this->CompressProcess = cmsysProcess_New();
+  cmsysProcess_SetCommand(this->CompressProcess, &*cmd.begin());
+  cmsysProcess_SetPipeNative(this->CompressProcess,
+                             cmsysProcess_Pipe_STDIN, in);
+  cmsysProcess_SetPipeNative(this->CompressProcess,
+                             cmsysProcess_Pipe_STDOUT, out);
+  cmsysProcess_SetPipeShared(this->CompressProcess,
+                             cmsysProcess_Pipe_STDERR, 1);
+  cmsysProcess_Execute(this->CompressProcess);
+  if(cmsysProcess_GetState(this->CompressProcess) !=
+     cmsysProcess_State_Executing)
+    {
+    // The child ends of the pipes are closed by kwsys.
+    close(in[1]);
+    close(out[0]);
+    cmsysProcess_Delete(this->CompressProcess);
+    this->CompressProcess = 0;
+    return false;
+    }
+
+  // Both ends are polled so a full pipe in one direction does not
+  // dead-lock with the compressor waiting on the other.
+  this->CompressIn = in[1];
+  this->CompressOut = out[0];
+  fcntl(this->CompressIn, F_SETFL,
+        fcntl(this->CompressIn, F_GETFL) | O_NONBLOCK);
+  fcntl(this->CompressOut, F_SETFL,
+        fcntl(this->CompressOut, F_GETFL) | O_NONBLOCK);
+  this->Compressor = cmSystemTools::PrintSingleCommand(args);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool cmArchiveWrite::WriteCompressor(const char* data, size_t size)
+{
+  // With no data to write, read the compressed output until the
+  // compressor closes it.
+  bool finish = (this->CompressIn < 0);
+  char buffer[16384];
+  while(size > 0 || (finish && this->CompressOut >= 0))
+    {
+    struct pollfd fds[2];
+    nfds_t nfds = 0;
+    if(!finish)
+      {
+      fds[nfds].fd = this->CompressIn;
+      fds[nfds].events = POLLOUT;
+      ++nfds;
+      }
+    fds[nfds].fd = this->CompressOut;
+    fds[nfds].events = POLLIN;
+    ++nfds;
+    if(poll(fds, nfds, -1) < 0)
+      {
+      if(errno == EINTR)
+        {
+        continue;
+        }
+      this->Error = "poll: ";
+      this->Error += cmSystemTools::GetLastSystemError();
+      return false;
+      }
+    for(nfds_t i = 0; i < nfds; ++i)
+      {
+      if(fds[i].fd == this->CompressOut && fds[i].revents)
+        {
+        ssize_t n = read(this->CompressOut, buffer, sizeof(buffer));
+        if(n > 0)
+          {
+          this->BytesOut += n;
+          if(!this->Stream.write(buffer, n))
+            {
+            this->Error = "Error writing compressed archive";
+            return false;
+            }
+          }
+        else if(n == 0)
+          {
+          close(this->CompressOut);
+          this->CompressOut = -1;
+          }
+        else if(errno != EAGAIN && errno != EINTR)
+          {
+          this->Error = "Error reading from " + this->Compressor + ": ";
+          this->Error += cmSystemTools::GetLastSystemError();
+          return false;
+          }
+        }
+      else if(fds[i].fd == this->CompressIn && fds[i].revents)
+        {
+        if(fds[i].revents & (POLLERR | POLLHUP))
+          {
+          this->Error = this->Compressor + " closed its input early";
+          return false;
+          }
+        ssize_t n = write(this->CompressIn, data, size);
+        if(n > 0)
+          {
+          data += n;
+          size -= static_cast<size_t>(n);
+          }
+        else if(n < 0 && errno != EAGAIN && errno != EINTR)
+          {
+          this->Error = "Error writing to " + this->Compressor + ": ";
+          this->Error += cmSystemTools::GetLastSystemError();
+          return false;
+          }
+        }
+      }
+    if(!finish && size > 0 && this->CompressOut < 0)
+      {
+      this->Error = this->Compressor + " closed its output early";
+      return false;
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void cmArchiveWrite::FinishCompressor()
+{
+  if(this->CompressIn >= 0)
+    {
+    close(this->CompressIn);
+    this->CompressIn = -1;
+    }
+  if(this->Okay())
+    {
+    this->WriteCompressor(0, 0);
+    }
+  if(this->CompressOut >= 0)
+    {
+    close(this->CompressOut);
+    this->CompressOut = -1;
+    }
+  cmsysProcess_WaitForExit(this->CompressProcess, 0);
+  if(this->Okay() &&
+     (cmsysProcess_GetState(this->CompressProcess) !=
+      cmsysProcess_State_Exited ||
+      cmsysProcess_GetExitValue(this->CompressProcess) != 0))
+    {
+    this->Error = this->Compressor + " failed";
+    }
+  cmsysProcess_Delete(this->CompressProcess);
+  this->CompressProcess = 0;
+}
+#else
+//----------------------------------------------------------------------------
+bool cmArchiveWrite::StartCompressor(Compress, unsigned int)
+{
+  return false;
+}
+
+//----------------------------------------------------------------------------
+bool cmArchiveWrite::WriteCompressor(const char*, size_t)
+{
+  return false;
+}
+
+//----------------------------------------------------------------------------
+void cmArchiveWrite::FinishCompressor()
+{
+}
+#endif
+
 //----------------------------------------------------------------------------
 bool cmArchiveWrite::Add(std::string path, size_t skip, const char* prefix)
 {
@@ -249,6 +527,23 @@ bool cmArchiveWrite::AddFile(const char* file,
   archive_entry_acl_clear(e);
   archive_entry_xattr_clear(e);
   archive_entry_set_fflags(e, 0, 0);
+  // Replace the owner if requested.
+  if(this->UID >= 0)
+    {
+    archive_entry_set_uid(e, this->UID);
+    }
+  if(this->GID >= 0)
+    {
+    archive_entry_set_gid(e, this->GID);
+    }
+  if(!this->UNAME.empty())
+    {
+    archive_entry_set_uname(e, this->UNAME.c_str());
+    }
+  if(!this->GNAME.empty())
+    {
+    archive_entry_set_gname(e, this->GNAME.c_str());
+    }
   if(archive_write_header(this->Archive, e) != ARCHIVE_OK)
     {
     this->Error = "archive_write_header: ";
@@ -260,16 +555,28 @@ bool cmArchiveWrite::AddFile(const char* file,
   if (!archive_entry_symlink(e))
     {
     // Content.
-    if(size_t size = static_cast<size_t>(archive_entry_size(e)))
+    size_t size = static_cast<size_t>(archive_entry_size(e));
+    if(this->ComputeMD5 && archive_entry_filetype(e) == AE_IFREG)
       {
-      return this->AddData(file, size);
+      cmsysMD5* md5 = cmsysMD5_New();
+      cmsysMD5_Initialize(md5);
+      bool okay = size == 0 || this->AddData(file, size, md5);
+      char hex[32];
+      cmsysMD5_FinalizeHex(md5, hex);
+      cmsysMD5_Delete(md5);
+      this->MD5Sums.push_back(std::make_pair(dest, std::string(hex, 32)));
+      return okay;
+      }
+    if(size)
+      {
+      return this->AddData(file, size, 0);
       }
     }
   return true;
 }
 
 //----------------------------------------------------------------------------
-bool cmArchiveWrite::AddData(const char* file, size_t size)
+bool cmArchiveWrite::AddData(const char* file, size_t size, cmsysMD5* md5)
 {
   cmsys::ifstream fin(file, std::ios::in | cmsys_ios_binary);
   if(!fin)
@@ -302,6 +609,11 @@ bool cmArchiveWrite::AddData(const char* file, size_t size)
       this->Error += cm_archive_error_string(this->Archive);
       return false;
       }
+    if(md5)
+      {
+      cmsysMD5_Append(md5, reinterpret_cast<unsigned char*>(buffer),
+                      static_cast<int>(nnext));
+      }
     nleft -= nnext;
     }
   if(nleft > 0)
@@ -14,6 +14,8 @@
 
 #include "cmStandardIncludes.h"
 
+#include <cmsys/Process.h>
+
 #if !defined(CMAKE_BUILD_WITH_CMAKE)
 # error "cmArchiveWrite not allowed during bootstrap build!"
 #endif
@@ -45,8 +47,15 @@ public:
     TypeZIP
   };
 
-  /** Construct with output stream to which to write archive.  */
-  cmArchiveWrite(std::ostream& os, Compress c = CompressNone, Type = TypeTAR);
+  /**
+   * Construct with output stream to which to write archive.  If "jobs"
+   * is greater than one and a parallel compressor for the compression
+   * type is found in the PATH (pigz, pbzip2 or xz) a tar archive is
+   * piped through it using that many jobs.  Otherwise the built-in
+   * compression is used.
+   */
+  cmArchiveWrite(std::ostream& os, Compress c = CompressNone, Type = TypeTAR,
+                 unsigned int jobs = 1);
   ~cmArchiveWrite();
 
   /**
@@ -73,11 +82,45 @@ public:
   // std::cout.
   void SetVerbose(bool v) { this->Verbose = v; }
 
+  /** Store the given owner in all entries added after this call instead
+      of the owner of the files on disk.  A negative id or an empty name
+      keeps the value from disk.  */
+  void SetUIDAndGID(int uid, int gid)
+    { this->UID = uid; this->GID = gid; }
+  void SetUNAMEAndGNAME(std::string const& uname, std::string const& gname)
+    { this->UNAME = uname; this->GNAME = gname; }
+
+  /** Compute the MD5 sum of each regular file while its content is
+      added, saving a second read of the file.  */
+  void SetComputeMD5(bool b) { this->ComputeMD5 = b; }
+
+  /** Pairs of archive entry name and MD5 sum in hex of the regular
+      files added so far, in the order they were added.  */
+  typedef std::vector<std::pair<std::string, std::string> > MD5SumsType;
+  MD5SumsType const& GetMD5Sums() const { return this->MD5Sums; }
+
+  /** Finish writing the archive, including the compression.  Returns
+      true if there has been no error.  The destructor calls this if it
+      has not been called already.  */
+  bool Close();
+
+  /** The external compressor command line, empty if the built-in
+      compression is used.  */
+  std::string const& GetCompressor() const { return this->Compressor; }
+
+  /** Number of bytes of archive data before and after compression.
+      Valid after Close().  */
+  cmIML_INT_uint64_t GetBytesIn() const { return this->BytesIn; }
+  cmIML_INT_uint64_t GetBytesOut() const { return this->BytesOut; }
+
 private:
   bool Okay() const { return this->Error.empty(); }
   bool AddPath(const char* path, size_t skip, const char* prefix);
   bool AddFile(const char* file, size_t skip, const char* prefix);
-  bool AddData(const char* file, size_t size);
+  bool AddData(const char* file, size_t size, struct cmsysMD5_s* md5);
+  bool StartCompressor(Compress c, unsigned int jobs);
+  bool WriteCompressor(const char* data, size_t size);
+  void FinishCompressor();
 
   struct Callback;
   friend struct Callback;
@@ -88,7 +131,23 @@ private:
   struct archive* Archive;
   struct archive* Disk;
   bool Verbose;
+  bool Closed;
   std::string Error;
+
+  int UID;
+  int GID;
+  std::string UNAME;
+  std::string GNAME;
+  bool ComputeMD5;
+  MD5SumsType MD5Sums;
+
+  // External compressor process and our ends of its stdin/stdout pipes.
+  cmsysProcess* CompressProcess;
+  int CompressIn;
+  int CompressOut;
+  std::string Compressor;
+  cmIML_INT_uint64_t BytesIn;
+  cmIML_INT_uint64_t BytesOut;
 };
 
 #endif
@@ -102,6 +102,19 @@ bool cmDepends::Check(const char *makeFile, const char *internalFile,
     cmSystemTools::ChangeDirectory(this->CompileDirectory.c_str());
     }
 
+  // Note the time before looking at any dependee.  A dependee changed
+  // after this time is not covered by the result of this check.
+  std::string verifiedFile = this->GetVerifiedFile(internalFile);
+  long verifiedTime[2];
+  bool haveVerifiedTime = false;
+  {
+  cmsys::ofstream vout(verifiedFile.c_str());
+  }
+  {
+  cmFileTimeComparison ftc;
+  haveVerifiedTime = ftc.GetFileTime(verifiedFile.c_str(), verifiedTime);
+  }
+
   // Check whether dependencies must be regenerated.
   bool okay = true;
   cmsys::ifstream fin(internalFile);
@@ -110,8 +123,62 @@ bool cmDepends::Check(const char *makeFile, const char *internalFile,
     // Clear all dependencies so they will be regenerated.
     this->Clear(makeFile);
     cmSystemTools::RemoveFile(internalFile);
+    cmSystemTools::RemoveFile(verifiedFile.c_str());
     okay = false;
     }
+  else if(haveVerifiedTime)
+    {
+    // Record the files just checked so that the next check need only
+    // look at each of them once.
+    std::set<std::string> dependees;
+    cmsys::ofstream vout(verifiedFile.c_str());
+    vout << "# CMAKE generated file: DO NOT EDIT!\n"
+         << "# Files checked against " << internalFile << "\n"
+         << "#time " << verifiedTime[0] << " " << verifiedTime[1] << "\n";
+    for(std::map<std::string, DependencyVector>::const_iterator
+          vi = validDeps.begin(); vi != validDeps.end(); ++vi)
+      {
+      vout << vi->first << "\n";
+      dependees.insert(vi->second.begin(), vi->second.end());
+      }
+    for(std::set<std::string>::const_iterator di = dependees.begin();
+        di != dependees.end(); ++di)
+      {
+      vout << " " << *di << "\n";
+      }
+    }
+
+  // Restore working directory.
+  if(oldcwd != ".")
+    {
+    cmSystemTools::ChangeDirectory(oldcwd.c_str());
+    }
+
+  return okay;
+}
+
+//----------------------------------------------------------------------------
+std::string cmDepends::GetVerifiedFile(const char* internalFile)
+{
+  std::string verifiedFile = cmSystemTools::GetFilenamePath(internalFile);
+  verifiedFile += "/depend.verified";
+  return verifiedFile;
+}
+
+//----------------------------------------------------------------------------
+bool cmDepends::CheckVerified(const char* internalFile)
+{
+  // Dependency checks must be done in proper working directory.
+  std::string oldcwd = ".";
+  if(this->CompileDirectory != ".")
+    {
+    // Get the CWD but do not call CollapseFullPath because
+    // we only need it to cd back, and the form does not matter
+    oldcwd = cmSystemTools::GetCurrentWorkingDirectory(false);
+    cmSystemTools::ChangeDirectory(this->CompileDirectory.c_str());
+    }
+
+  bool okay = this->CheckVerifiedFile(internalFile);
 
   // Restore working directory.
   if(oldcwd != ".")
@@ -122,6 +189,86 @@ bool cmDepends::Check(const char *makeFile, const char *internalFile,
   return okay;
 }
 
+//----------------------------------------------------------------------------
+bool cmDepends::CheckVerifiedFile(const char* internalFile)
+{
+  // The record of the last check must be newer than the dependencies
+  // it was made for.
+  std::string verifiedFile = this->GetVerifiedFile(internalFile);
+  cmsys::ifstream fin(verifiedFile.c_str());
+  if(!fin)
+    {
+    return false;
+    }
+  long verifiedTime[2];
+  long internalTime[2];
+  bool haveVerifiedTime = false;
+  if(!this->FileComparison->GetFileTime(internalFile, internalTime))
+    {
+    return false;
+    }
+
+  // The dependencies are still up to date if every depender still
+  // exists and no dependee has changed since they were last checked.
+  std::string line;
+  while(cmSystemTools::GetLineFromStream(fin, line))
+    {
+    if(line.empty())
+      {
+      continue;
+      }
+    if(line[0] == '#')
+      {
+      if(line.compare(0, 6, "#time ") == 0)
+        {
+        cmIStringStream time(line.substr(6));
+        haveVerifiedTime =
+          (time >> verifiedTime[0] >> verifiedTime[1])? true : false;
+        if(!haveVerifiedTime ||
+           cmFileTimeComparison::CompareFileTimes(verifiedTime,
+                                                  internalTime) <= 0)
+          {
+          return false;
+          }
+        }
+      continue;
+      }
+    if(!haveVerifiedTime)
+      {
+      return false;
+      }
+    long fileTime[2];
+    if(!this->FileComparison->GetFileTime(line.c_str() +
+                                          (line[0] == ' '? 1 : 0),
+                                          fileTime))
+      {
+      if(this->Verbose)
+        {
+        cmOStringStream msg;
+        msg << "File \"" << line.substr(line[0] == ' '? 1 : 0)
+            << "\" checked for \"" << internalFile
+            << "\" does not exist." << std::endl;
+        cmSystemTools::Stdout(msg.str().c_str());
+        }
+      return false;
+      }
+    if(line[0] == ' ' &&
+       cmFileTimeComparison::CompareFileTimes(fileTime, verifiedTime) >= 0)
+      {
+      if(this->Verbose)
+        {
+        cmOStringStream msg;
+        msg << "Dependee \"" << line.substr(1)
+            << "\" changed since \"" << internalFile
+            << "\" was last checked." << std::endl;
+        cmSystemTools::Stdout(msg.str().c_str());
+        }
+      return false;
+      }
+    }
+  return haveVerifiedTime;
+}
+
 //----------------------------------------------------------------------------
 void cmDepends::Clear(const char *file)
 {
@@ -159,6 +306,14 @@ bool cmDepends::CheckDependencies(std::istream& internalDepends,
   // regenerated.
   bool okay = true;
   bool dependerExists = false;
+  bool dependerOutOfDate = false;
+  long dependerTime[2];
+  long internalTime[2];
+  if(!this->FileComparison->GetFileTime(internalDependsFileName,
+                                        internalTime))
+    {
+    return false;
+    }
   DependencyVector* currentDependencies = 0;
 
   while(internalDepends.getline(this->Dependee, this->MaxPath))
@@ -177,11 +332,10 @@ bool cmDepends::CheckDependencies(std::istream& internalDepends,
     if ( this->Dependee[0] != ' ' )
       {
       memcpy(this->Depender, this->Dependee, len+1);
-      // Calling FileExists() for the depender here saves in many cases 50%
-      // of the calls to FileExists() further down in the loop. E.g. for
-      // kdelibs/khtml this reduces the number of calls from 184k down to 92k,
-      // or the time for cmake -E cmake_depends from 0.3 s down to 0.21 s.
-      dependerExists = cmSystemTools::FileExists(this->Depender);
+      // Look up the time of the depender once for all its dependees.
+      dependerExists =
+        this->FileComparison->GetFileTime(this->Depender, dependerTime);
+      dependerOutOfDate = false;
       // If we erase validDeps[this->Depender] by overwriting it with an empty
       // vector, we lose dependencies for dependers that have multiple
       // entries. No need to initialize the entry, std::map will do so on first
@@ -189,19 +343,21 @@ bool cmDepends::CheckDependencies(std::istream& internalDepends,
       currentDependencies = &validDeps[this->Depender];
       continue;
       }
-    /*
-    // Parse the dependency line.
-    if(!this->ParseDependency(line.c_str()))
+
+    // Once one dependee of the depender is out of date the remaining
+    // ones need not be looked at.  The depender will be rescanned.
+    if(dependerOutOfDate)
       {
       continue;
       }
-      */
 
     // Dependencies must be regenerated
     // * if the dependee does not exist
     // * if the depender exists and is older than the dependee.
     // * if the depender does not exist, but the dependee is newer than the
     //   depends file
+    // The file comparison object stats each file only once, so a
+    // dependee shared by many dependers costs one stat.
     bool regenerate = false;
     const char* dependee = this->Dependee+1;
     const char* depender = this->Depender;
@@ -210,7 +366,8 @@ bool cmDepends::CheckDependencies(std::istream& internalDepends,
       currentDependencies->push_back(dependee);
       }
 
-    if(!cmSystemTools::FileExists(dependee))
+    long dependeeTime[2];
+    if(!this->FileComparison->GetFileTime(dependee, dependeeTime))
       {
       // The dependee does not exist.
       regenerate = true;
@@ -225,49 +382,44 @@ bool cmDepends::CheckDependencies(std::istream& internalDepends,
         cmSystemTools::Stdout(msg.str().c_str());
         }
       }
-    else
+    else if(dependerExists)
       {
-      if(dependerExists)
+      // The dependee and depender both exist.  Compare file times.
+      if(cmFileTimeComparison::CompareFileTimes(dependerTime,
+                                                dependeeTime) < 0)
         {
-        // The dependee and depender both exist.  Compare file times.
-        int result = 0;
-        if((!this->FileComparison->FileTimeCompare(depender, dependee,
-                                              &result) || result < 0))
+        // The depender is older than the dependee.
+        regenerate = true;
+
+        // Print verbose output.
+        if(this->Verbose)
           {
-          // The depender is older than the dependee.
-          regenerate = true;
-
-          // Print verbose output.
-          if(this->Verbose)
-            {
-            cmOStringStream msg;
-            msg << "Dependee \"" << dependee
-                << "\" is newer than depender \""
-                << depender << "\"." << std::endl;
-            cmSystemTools::Stdout(msg.str().c_str());
-            }
+          cmOStringStream msg;
+          msg << "Dependee \"" << dependee
+              << "\" is newer than depender \""
+              << depender << "\"." << std::endl;
+          cmSystemTools::Stdout(msg.str().c_str());
           }
         }
-      else
+      }
+    else
+      {
+      // The dependee exists, but the depender doesn't. Regenerate if the
+      // internalDepends file is older than the dependee.
+      if(cmFileTimeComparison::CompareFileTimes(internalTime,
+                                                dependeeTime) < 0)
         {
-        // The dependee exists, but the depender doesn't. Regenerate if the
-        // internalDepends file is older than the dependee.
-        int result = 0;
-        if((!this->FileComparison->FileTimeCompare(internalDependsFileName,
-                                             dependee, &result) || result < 0))
+        // The depends-file is older than the dependee.
+        regenerate = true;
+
+        // Print verbose output.
+        if(this->Verbose)
           {
-          // The depends-file is older than the dependee.
-          regenerate = true;
-
-          // Print verbose output.
-          if(this->Verbose)
-            {
-            cmOStringStream msg;
-            msg << "Dependee \"" << dependee
-                << "\" is newer than depends file \""
-                << internalDependsFileName << "\"." << std::endl;
-            cmSystemTools::Stdout(msg.str().c_str());
-            }
+          cmOStringStream msg;
+          msg << "Dependee \"" << dependee
+              << "\" is newer than depends file \""
+              << internalDependsFileName << "\"." << std::endl;
+          cmSystemTools::Stdout(msg.str().c_str());
           }
         }
       }
@@ -275,6 +427,7 @@ bool cmDepends::CheckDependencies(std::istream& internalDepends,
       {
       // Dependencies must be regenerated.
       okay = false;
+      dependerOutOfDate = true;
 
       // Remove the information of this depender from the map, it needs
       // to be rescanned
@@ -323,3 +476,28 @@ void cmDepends::SetIncludePathFromLanguage(const std::string& lang)
       }
     }
 }
+
+//----------------------------------------------------------------------------
+bool cmDepends::ReadSourceCacheField(std::string const& line,
+                                     const char* key, std::string& value)
+{
+  std::string::size_type n = strlen(key);
+  if(line.size() < n + 2 || line[0] != ' ' ||
+     line.compare(1, n, key) != 0 || line[n+1] != ' ')
+    {
+    return false;
+    }
+  value = line.substr(n+2);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void cmDepends::WriteSourceCacheField(std::ostream& fout, const char* key,
+                                      std::set<std::string> const& values)
+{
+  for(std::set<std::string>::const_iterator i = values.begin();
+      i != values.end(); ++i)
+    {
+    fout << " " << key << " " << *i << "\n";
+    }
+}
@@ -65,6 +65,11 @@ public:
   bool Check(const char *makeFile, const char* internalFile,
              std::map<std::string, DependencyVector>& validDeps);
 
+  /** Check dependencies for the target file against the record of the
+      last successful Check.  Returns true if no file listed in it has
+      changed since, so the full check can be skipped.  */
+  bool CheckVerified(const char* internalFile);
+
   /** Clear dependencies for the target file so they will be regenerated.  */
   void Clear(const char *file);
 
@@ -116,6 +121,24 @@ protected:
 
   void SetIncludePathFromLanguage(const std::string& lang);
 
+  // The file recording the last successful check of the given file.
+  static std::string GetVerifiedFile(const char* internalFile);
+
+  // Check the record of the last successful check from the compile
+  // directory.
+  bool CheckVerifiedFile(const char* internalFile);
+
+  // Subclasses may keep the scan results of each source in a cache
+  // file in the target directory.  An entry of the cache is the full
+  // path of a source followed by lines " <key> <value>" of its fields.
+  // Get the value of a field line with the given key, or return false.
+  static bool ReadSourceCacheField(std::string const& line, const char* key,
+                                   std::string& value);
+
+  // Write a field line with the given key for each value.
+  static void WriteSourceCacheField(std::ostream& fout, const char* key,
+                                    std::set<std::string> const& values);
+
 private:
   cmDepends(cmDepends const&); // Purposely not implemented.
   void operator=(cmDepends const&); // Purposely not implemented.
@@ -0,0 +1,272 @@
+/*============================================================================
+  CMake - Cross Platform Makefile Generator
+  Copyright 2000-2009 Kitware, Inc., Insight Software Consortium
+
+  Distributed under the OSI-approved BSD License (the "License");
+  see accompanying file Copyright.txt for details.
+
+  This software is distributed WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the License for more information.
+============================================================================*/
+#include "cmDependsCompiler.h"
+
+#include "cmFileTimeComparison.h"
+#include "cmGeneratedFileStream.h"
+#include "cmLocalUnixMakefileGenerator3.h"
+#include "cmMakefile.h"
+#include "cmSystemTools.h"
+
+#include <cmsys/FStream.hxx>
+
+#include <ctype.h>
+
+//----------------------------------------------------------------------------
+cmDependsCompiler::cmDependsCompiler(cmLocalUnixMakefileGenerator3* lg,
+                                     const char* targetDir):
+  LocalGenerator(lg),
+  TargetDirectory(targetDir),
+  Verbose(false),
+  FileComparison(0)
+{
+}
+
+//----------------------------------------------------------------------------
+bool cmDependsCompiler::Update(bool force)
+{
+  cmMakefile* mf = this->LocalGenerator->GetMakefile();
+  std::vector<std::string> pairs;
+  cmSystemTools::ExpandListArgument(
+    mf->GetSafeDefinition("CMAKE_DEPENDS_COMPILER_FILES"), pairs);
+
+  std::string makeFile = this->TargetDirectory + "/compiler_depend.make";
+  std::string internalFile =
+    this->TargetDirectory + "/compiler_depend.internal";
+
+  // Find the dependency files written since the last merge.  This is
+  // the common case of a build in which nothing was compiled, so it
+  // must not read any file.
+  bool haveInternal = cmSystemTools::FileExists(internalFile.c_str());
+  std::set<std::string> changed;
+  for(std::vector<std::string>::const_iterator pi = pairs.begin();
+      pi != pairs.end() && (pi+1) != pairs.end(); pi += 2)
+    {
+    std::string const& depFile = *(pi+1);
+    int result;
+    if(haveInternal?
+       (this->FileComparison->FileTimeCompare(internalFile.c_str(),
+                                              depFile.c_str(), &result) &&
+        result < 0) :
+       cmSystemTools::FileExists(depFile.c_str()))
+      {
+      changed.insert(depFile);
+      }
+    }
+  if(haveInternal && !force && changed.empty())
+    {
+    return true;
+    }
+
+  DependMapType depends;
+  if(haveInternal)
+    {
+    this->ReadInternal(internalFile.c_str(), depends);
+    }
+
+  // Relative paths in the dependency files are relative to the
+  // directory in which the compiler ran.
+  std::string workDir = mf->GetStartOutputDirectory();
+  DependMapType merged;
+  for(std::vector<std::string>::const_iterator pi = pairs.begin();
+      pi != pairs.end() && (pi+1) != pairs.end(); pi += 2)
+    {
+    std::string const& obj = *pi;
+    std::string const& depFile = *(pi+1);
+    std::vector<std::string> deps;
+    if(changed.find(depFile) != changed.end() &&
+       this->ReadDependencyFile(depFile.c_str(), deps))
+      {
+      if(this->Verbose)
+        {
+        cmOStringStream msg;
+        msg << "Merging dependencies of \"" << obj << "\" from \""
+            << depFile << "\"." << std::endl;
+        cmSystemTools::Stdout(msg.str().c_str());
+        }
+      std::vector<std::string>& objDeps = merged[obj];
+      for(std::vector<std::string>::const_iterator di = deps.begin();
+          di != deps.end(); ++di)
+        {
+        objDeps.push_back(
+          cmSystemTools::CollapseFullPath(di->c_str(), workDir.c_str()));
+        }
+      }
+    else
+      {
+      DependMapType::iterator di = depends.find(obj);
+      if(di != depends.end())
+        {
+        merged[obj].swap(di->second);
+        }
+      }
+    }
+
+  // The make dependencies file should be copy-if-different because the
+  // make tool may try to reload it needlessly otherwise.
+  cmGeneratedFileStream makeStream(makeFile.c_str());
+  makeStream.SetCopyIfDifferent(true);
+  cmGeneratedFileStream internalStream(internalFile.c_str());
+  if(!makeStream || !internalStream)
+    {
+    return false;
+    }
+  this->LocalGenerator->WriteDisclaimer(makeStream);
+  this->LocalGenerator->WriteDisclaimer(internalStream);
+
+  // Write the dependencies relative to the home output directory as
+  // the rules of the target do.
+  std::set<std::string> dependees;
+  for(DependMapType::const_iterator mi = merged.begin();
+      mi != merged.end(); ++mi)
+    {
+    std::string obj =
+      this->LocalGenerator->Convert(mi->first,
+                                    cmLocalGenerator::HOME_OUTPUT,
+                                    cmLocalGenerator::MAKEFILE);
+    internalStream << mi->first << "\n";
+    for(std::vector<std::string>::const_iterator di = mi->second.begin();
+        di != mi->second.end(); ++di)
+      {
+      std::string dep =
+        this->LocalGenerator->Convert(*di,
+                                      cmLocalGenerator::HOME_OUTPUT,
+                                      cmLocalGenerator::MAKEFILE);
+      makeStream << obj << ": " << dep << "\n";
+      internalStream << " " << *di << "\n";
+      dependees.insert(dep);
+      }
+    makeStream << "\n";
+    }
+
+  // A dependency that has been removed since the object was compiled
+  // makes the object out of date instead of stopping the build.
+  if(!dependees.empty())
+    {
+    makeStream << "\n";
+    for(std::set<std::string>::const_iterator di = dependees.begin();
+        di != dependees.end(); ++di)
+      {
+      makeStream << *di << ":\n";
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool cmDependsCompiler::ReadInternal(const char* fname,
+                                     DependMapType& depends)
+{
+  cmsys::ifstream fin(fname);
+  if(!fin)
+    {
+    return false;
+    }
+  std::vector<std::string>* objDeps = 0;
+  std::string line;
+  while(cmSystemTools::GetLineFromStream(fin, line))
+    {
+    if(line.empty() || line[0] == '#')
+      {
+      continue;
+      }
+    if(line[0] == ' ')
+      {
+      if(objDeps)
+        {
+        objDeps->push_back(line.substr(1));
+        }
+      }
+    else
+      {
+      objDeps = &depends[line];
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool
+cmDependsCompiler::ReadDependencyFile(const char* fname,
+                                      std::vector<std::string>& deps)
+{
+  cmsys::ifstream fin(fname, std::ios::in | std::ios::binary);
+  if(!fin)
+    {
+    return false;
+    }
+  std::string content;
+  char buffer[16384];
+  while(fin.read(buffer, sizeof(buffer)), fin.gcount() > 0)
+    {
+    content.append(buffer,
+                   static_cast<std::string::size_type>(fin.gcount()));
+    }
+
+  // Compilers escape spaces and '#' with a backslash and '$' by
+  // doubling it.  Any other backslash is part of the path, as in a
+  // Windows path.  A colon ends the targets only if followed by space.
+  std::string::size_type const n = content.size();
+  bool inTargets = true;
+  std::string token;
+  for(std::string::size_type i = 0; i < n; ++i)
+    {
+    char c = content[i];
+    if(c == '\\' && i+1 < n && (content[i+1] == '\n' ||
+                                content[i+1] == '\r'))
+      {
+      // A continuation line separates tokens like a space.
+      i += (content[i+1] == '\r' && i+2 < n && content[i+2] == '\n')? 2:1;
+      c = ' ';
+      }
+    else if(c == '\\' && i+1 < n && (content[i+1] == ' ' ||
+                                     content[i+1] == '#'))
+      {
+      token += content[++i];
+      continue;
+      }
+    else if(c == '$' && i+1 < n && content[i+1] == '$')
+      {
+      token += content[++i];
+      continue;
+      }
+
+    if(c == ' ' || c == '\t' || c == '\r' || c == '\n')
+      {
+      if(!token.empty() && !inTargets)
+        {
+        deps.push_back(token);
+        }
+      token = "";
+      if(c == '\n' && !inTargets)
+        {
+        // Only the first rule names the dependencies of the object.
+        return true;
+        }
+      }
+    else if(c == ':' && inTargets &&
+            (i+1 == n || isspace(static_cast<unsigned char>(content[i+1]))))
+      {
+      token = "";
+      inTargets = false;
+      }
+    else
+      {
+      token += c;
+      }
+    }
+  if(!token.empty() && !inTargets)
+    {
+    deps.push_back(token);
+    }
+  return true;
+}
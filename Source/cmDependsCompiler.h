@@ -0,0 +1,67 @@
+/*============================================================================
+  CMake - Cross Platform Makefile Generator
+  Copyright 2000-2009 Kitware, Inc., Insight Software Consortium
+
+  Distributed under the OSI-approved BSD License (the "License");
+  see accompanying file Copyright.txt for details.
+
+  This software is distributed WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the License for more information.
+============================================================================*/
+#ifndef cmDependsCompiler_h
+#define cmDependsCompiler_h
+
+#include "cmStandardIncludes.h"
+
+class cmFileTimeComparison;
+class cmLocalUnixMakefileGenerator3;
+
+/** \class cmDependsCompiler
+ * \brief Merge dependency files written by the compiler.
+ *
+ * Compilers that support it write a make-syntax dependency file for
+ * each object file as a side effect of compiling it.  This class folds
+ * those files into the compiler_depend.make file of a target so that
+ * the sources need not be scanned separately.  The merged dependencies
+ * are kept in compiler_depend.internal and only dependency files
+ * written since the last merge are read again.
+ */
+class cmDependsCompiler
+{
+public:
+  /** The local generator must be set up to do relative path
+      conversions for the directory of the target.  */
+  cmDependsCompiler(cmLocalUnixMakefileGenerator3* lg,
+                    const char* targetDir);
+
+  /** should this be verbose in its output */
+  void SetVerbose(bool verb) { this->Verbose = verb; }
+
+  /** Set the file comparison object */
+  void SetFileComparison(cmFileTimeComparison* fc)
+    { this->FileComparison = fc; }
+
+  /** Merge the dependency files listed in the
+      CMAKE_DEPENDS_COMPILER_FILES variable of the local generator's
+      makefile.  When 'force' is true, merged dependencies of objects
+      that are no longer listed are dropped even if no dependency file
+      changed.  Returns false on failure.  */
+  bool Update(bool force);
+
+  /** Read the prerequisites of the first rule in a make-syntax
+      dependency file.  Relative paths are returned as written.  */
+  static bool ReadDependencyFile(const char* fname,
+                                 std::vector<std::string>& deps);
+
+private:
+  typedef std::map<std::string, std::vector<std::string> > DependMapType;
+  bool ReadInternal(const char* fname, DependMapType& depends);
+
+  cmLocalUnixMakefileGenerator3* LocalGenerator;
+  std::string TargetDirectory;
+  bool Verbose;
+  cmFileTimeComparison* FileComparison;
+};
+
+#endif
@@ -39,6 +39,32 @@ public:
 
   // Set of files included in the translation unit.
   std::set<std::string> Includes;
+
+  // Set of paths at which an included file was looked for but did
+  // not exist, including those searched before the file was found.
+  std::set<std::string> MissingIncludes;
+};
+
+//----------------------------------------------------------------------------
+// Information about a single source file as of the last scan.
+struct cmDependsFortranCachedSource
+{
+  cmDependsFortranCachedSource(): Used(false) {}
+
+  // The content hash of the source and of each included file.
+  std::string Hash;
+  std::map<std::string, std::string> IncludeHashes;
+
+  // The paths at which included files were looked for but did not
+  // exist.
+  std::set<std::string> MissingIncludes;
+
+  // Set of provided and required modules.
+  std::set<std::string> Provides;
+  std::set<std::string> Requires;
+
+  // Whether the source is still scanned for the target.
+  bool Used;
 };
 
 //----------------------------------------------------------------------------
@@ -108,6 +134,35 @@ public:
   typedef std::map<std::string, cmDependsFortranSourceInfo> ObjectInfoMap;
   ObjectInfoMap ObjectInfo;
 
+  // The scan results of each source keyed by its full path.
+  typedef std::map<std::string, cmDependsFortranCachedSource> SourceCacheMap;
+  SourceCacheMap SourceCache;
+  bool SourceCacheLoaded;
+
+  // The content hash of each file looked at so far.
+  std::map<std::string, std::string> FileHashes;
+
+  cmDependsFortranInternals(): SourceCacheLoaded(false) {}
+
+  bool GetFileHash(std::string const& file, std::string& hash)
+    {
+    std::map<std::string, std::string>::iterator i =
+      this->FileHashes.find(file);
+    if(i == this->FileHashes.end())
+      {
+      char md5[32];
+      std::string value;
+      if(cmSystemTools::ComputeFileMD5(file, md5))
+        {
+        value.assign(md5, 32);
+        }
+      i = this->FileHashes.insert(
+        std::map<std::string, std::string>::value_type(file, value)).first;
+      }
+    hash = i->second;
+    return !hash.empty();
+    }
+
   cmDependsFortranSourceInfo& CreateObjectInfo(const char* obj,
                                                const char* src)
     {
@@ -195,31 +250,255 @@ bool cmDependsFortran::WriteDependencies(
     cmDependsFortranSourceInfo& info =
       this->Internal->CreateObjectInfo(obj.c_str(), src.c_str());
 
-    // Make a copy of the macros defined via ADD_DEFINITIONS
-    std::set<std::string> ppDefines(this->PPDefinitions.begin(),
-                                    this->PPDefinitions.end());
+    // Parse only sources that changed since the last scan.
+    cmDependsFortranSourceInfo srcInfo;
+    if(!this->ReadCachedSource(src, srcInfo))
+      {
+      // Make a copy of the macros defined via ADD_DEFINITIONS
+      std::set<std::string> ppDefines(this->PPDefinitions.begin(),
+                                      this->PPDefinitions.end());
 
-    // Create the parser object. The constructor takes ppMacro and info per
-    // reference, so we may look into the resulting objects later.
-    cmDependsFortranParser parser(this, ppDefines, info);
+      // Create the parser object. The constructor takes ppMacro and info
+      // per reference, so we may look into the resulting objects later.
+      cmDependsFortranParser parser(this, ppDefines, srcInfo);
 
-    // Push on the starting file.
-    cmDependsFortranParser_FilePush(&parser, src.c_str());
+      // Push on the starting file.
+      cmDependsFortranParser_FilePush(&parser, src.c_str());
 
-    // Parse the translation unit.
-    if(cmDependsFortran_yyparse(parser.Scanner) != 0)
-      {
-      // Failed to parse the file.  Report failure to write dependencies.
-      okay = false;
+      // Parse the translation unit.
+      if(cmDependsFortran_yyparse(parser.Scanner) != 0)
+        {
+        // Failed to parse the file.  Report failure to write dependencies.
+        okay = false;
+        }
+      else
+        {
+        this->StoreCachedSource(src, srcInfo);
+        }
       }
+
+    info.Provides.insert(srcInfo.Provides.begin(), srcInfo.Provides.end());
+    info.Requires.insert(srcInfo.Requires.begin(), srcInfo.Requires.end());
+    info.Includes.insert(srcInfo.Includes.begin(), srcInfo.Includes.end());
     }
   return okay;
 }
 
+//----------------------------------------------------------------------------
+std::string cmDependsFortran::GetSourceCacheKey() const
+{
+  // The scan of a source depends on the preprocessor definitions and
+  // the include file search path.
+  std::string key = "#definitions";
+  for(std::vector<std::string>::const_iterator
+        i = this->PPDefinitions.begin(); i != this->PPDefinitions.end(); ++i)
+    {
+    key += " ";
+    key += *i;
+    }
+  key += "\n#include-path";
+  for(std::vector<std::string>::const_iterator
+        i = this->IncludePath.begin(); i != this->IncludePath.end(); ++i)
+    {
+    key += " ";
+    key += *i;
+    }
+  return key;
+}
+
+//----------------------------------------------------------------------------
+bool cmDependsFortran::ReadCachedSource(std::string const& src,
+                                        cmDependsFortranSourceInfo& info)
+{
+  if(!this->Internal->SourceCacheLoaded)
+    {
+    this->Internal->SourceCacheLoaded = true;
+    this->ReadSourceCache();
+    }
+
+  typedef cmDependsFortranInternals::SourceCacheMap SourceCacheMap;
+  SourceCacheMap::iterator ci = this->Internal->SourceCache.find(src);
+  if(ci == this->Internal->SourceCache.end())
+    {
+    return false;
+    }
+
+  // The entry is valid only if no file it was computed from changed.
+  cmDependsFortranCachedSource& entry = ci->second;
+  std::string hash;
+  if(!this->Internal->GetFileHash(src, hash) || hash != entry.Hash)
+    {
+    return false;
+    }
+  for(std::map<std::string, std::string>::const_iterator
+        i = entry.IncludeHashes.begin(); i != entry.IncludeHashes.end(); ++i)
+    {
+    if(!this->Internal->GetFileHash(i->first, hash) || hash != i->second)
+      {
+      return false;
+      }
+    }
+
+  // An included file that was not found before, or that was found
+  // later in the search path, may resolve to another file now.
+  for(std::set<std::string>::const_iterator
+        i = entry.MissingIncludes.begin(); i != entry.MissingIncludes.end();
+      ++i)
+    {
+    if(cmSystemTools::FileExists(i->c_str(), true))
+      {
+      return false;
+      }
+    }
+
+  entry.Used = true;
+  info.Provides = entry.Provides;
+  info.Requires = entry.Requires;
+  for(std::map<std::string, std::string>::const_iterator
+        i = entry.IncludeHashes.begin(); i != entry.IncludeHashes.end(); ++i)
+    {
+    info.Includes.insert(i->first);
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void cmDependsFortran::StoreCachedSource(std::string const& src,
+                                         cmDependsFortranSourceInfo const&
+                                         info)
+{
+  cmDependsFortranCachedSource entry;
+  if(!this->Internal->GetFileHash(src, entry.Hash))
+    {
+    return;
+    }
+  for(std::set<std::string>::const_iterator i = info.Includes.begin();
+      i != info.Includes.end(); ++i)
+    {
+    if(!this->Internal->GetFileHash(*i, entry.IncludeHashes[*i]))
+      {
+      return;
+      }
+    }
+  entry.MissingIncludes = info.MissingIncludes;
+  entry.Provides = info.Provides;
+  entry.Requires = info.Requires;
+  entry.Used = true;
+  this->Internal->SourceCache[src] = entry;
+}
+
+//----------------------------------------------------------------------------
+void cmDependsFortran::ReadSourceCache()
+{
+  std::string fname = this->TargetDirectory;
+  fname += "/fortran.sourcecache";
+  cmsys::ifstream fin(fname.c_str());
+  if(!fin)
+    {
+    return;
+    }
+
+  // Discard the whole cache if the scan settings changed.
+  std::string definitions;
+  std::string includePath;
+  if(!cmSystemTools::GetLineFromStream(fin, definitions) ||
+     !cmSystemTools::GetLineFromStream(fin, includePath) ||
+     definitions + "\n" + includePath != this->GetSourceCacheKey())
+    {
+    return;
+    }
+
+  std::string line;
+  std::string value;
+
+  cmDependsFortranCachedSource* entry = 0;
+  while(cmSystemTools::GetLineFromStream(fin, line))
+    {
+    if(line.empty())
+      {
+      entry = 0;
+      }
+    else if(line[0] != ' ')
+      {
+      entry = &this->Internal->SourceCache[line];
+      }
+    else if(!entry)
+      {
+      continue;
+      }
+    else if(this->ReadSourceCacheField(line, "hash", value))
+      {
+      entry->Hash = value;
+      }
+    else if(this->ReadSourceCacheField(line, "include", value))
+      {
+      // The hash of the included file precedes its path.
+      if(value.size() > 33)
+        {
+        entry->IncludeHashes[value.substr(33)] = value.substr(0, 32);
+        }
+      }
+    else if(this->ReadSourceCacheField(line, "missing", value))
+      {
+      entry->MissingIncludes.insert(value);
+      }
+    else if(this->ReadSourceCacheField(line, "provides", value))
+      {
+      entry->Provides.insert(value);
+      }
+    else if(this->ReadSourceCacheField(line, "requires", value))
+      {
+      entry->Requires.insert(value);
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+void cmDependsFortran::WriteSourceCache()
+{
+  std::string fname = this->TargetDirectory;
+  fname += "/fortran.sourcecache";
+  cmGeneratedFileStream fout(fname.c_str());
+  if(!fout)
+    {
+    return;
+    }
+  fout << this->GetSourceCacheKey() << "\n";
+
+  // Drop the entries of sources no longer in the target.
+  typedef cmDependsFortranInternals::SourceCacheMap SourceCacheMap;
+  SourceCacheMap const& cache = this->Internal->SourceCache;
+  for(SourceCacheMap::const_iterator ci = cache.begin();
+      ci != cache.end(); ++ci)
+    {
+    cmDependsFortranCachedSource const& entry = ci->second;
+    if(!entry.Used)
+      {
+      continue;
+      }
+    fout << "\n" << ci->first << "\n";
+    fout << " hash " << entry.Hash << "\n";
+    for(std::map<std::string, std::string>::const_iterator
+          i = entry.IncludeHashes.begin(); i != entry.IncludeHashes.end(); ++i)
+      {
+      fout << " include " << i->second << " " << i->first << "\n";
+      }
+    this->WriteSourceCacheField(fout, "missing", entry.MissingIncludes);
+    this->WriteSourceCacheField(fout, "provides", entry.Provides);
+    this->WriteSourceCacheField(fout, "requires", entry.Requires);
+    }
+}
+
 //----------------------------------------------------------------------------
 bool cmDependsFortran::Finalize(std::ostream& makeDepends,
                                 std::ostream& internalDepends)
 {
+  // Keep the scan results of the sources for the next scan.
+  if(this->Internal->SourceCacheLoaded)
+    {
+    this->WriteSourceCache();
+    }
+
   // Prepare the module search process.
   this->LocateModules();
 
@@ -873,13 +1152,22 @@ bool cmDependsFortran::ModulesDiffer(const char* modFile,
 //----------------------------------------------------------------------------
 bool cmDependsFortran::FindIncludeFile(const char* dir,
                                        const char* includeName,
-                                       std::string& fileName)
+                                       std::string& fileName,
+                                       std::set<std::string>* missing)
 {
   // If the file is a full path, include it directly.
   if(cmSystemTools::FileIsFullPath(includeName))
     {
     fileName = includeName;
-    return cmSystemTools::FileExists(fileName.c_str(), true);
+    if(cmSystemTools::FileExists(fileName.c_str(), true))
+      {
+      return true;
+      }
+    if(missing)
+      {
+      missing->insert(fileName);
+      }
+    return false;
     }
   else
     {
@@ -893,6 +1181,10 @@ bool cmDependsFortran::FindIncludeFile(const char* dir,
       fileName = fullName;
       return true;
       }
+    if(missing)
+      {
+      missing->insert(fullName);
+      }
 
     // Search the include path for the file.
     for(std::vector<std::string>::const_iterator i =
@@ -906,6 +1198,10 @@ bool cmDependsFortran::FindIncludeFile(const char* dir,
         fileName = fullName;
         return true;
         }
+      if(missing)
+        {
+        missing->insert(fullName);
+        }
       }
     }
   return false;
@@ -1085,8 +1381,11 @@ void cmDependsFortranParser_RuleInclude(cmDependsFortranParser* parser,
   // Find the included file.  If it cannot be found just ignore the
   // problem because either the source will not compile or the user
   // does not care about depending on this included source.
+  // Remember where it was looked for so that a cached scan result is
+  // not used after a file appears there.
   std::string fullName;
-  if(parser->Self->FindIncludeFile(dir.c_str(), name, fullName))
+  if(parser->Self->FindIncludeFile(dir.c_str(), name, fullName,
+                                   &parser->Info.MissingIncludes))
     {
     // Found the included file.  Save it in the set of included files.
     parser->Info.Includes.insert(fullName);
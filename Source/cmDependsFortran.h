@@ -48,9 +48,11 @@ public:
 
   /** Method to find an included file in the include path.  Fortran
       always searches the directory containing the including source
-      first.  */
+      first.  The paths tried at which no file exists are added to
+      the optional missing set.  */
   bool FindIncludeFile(const char* dir, const char* includeName,
-                       std::string& fileName);
+                       std::string& fileName,
+                       std::set<std::string>* missing = 0);
 
 protected:
   // Finalize the dependency information for the target.
@@ -76,6 +78,16 @@ protected:
                              std::ostream& makeDepends,
                              std::ostream& internalDepends);
 
+  // Reuse the scan results of sources that did not change.  They are
+  // kept in fortran.sourcecache keyed by the content of the files.
+  std::string GetSourceCacheKey() const;
+  bool ReadCachedSource(std::string const& src,
+                        cmDependsFortranSourceInfo& info);
+  void StoreCachedSource(std::string const& src,
+                         cmDependsFortranSourceInfo const& info);
+  void ReadSourceCache();
+  void WriteSourceCache();
+
   // The source file from which to start scanning.
   std::string SourceFile;
 
@@ -11,22 +11,45 @@
 ============================================================================*/
 #include "cmDependsJava.h"
 
-#include "cmDependsJavaParserHelper.h"
+#include "cmGeneratedFileStream.h"
+#include "cmLocalGenerator.h"
 #include "cmSystemTools.h"
 
+#include <cmsys/FStream.hxx>
+
+#include <ctype.h>
+
+//----------------------------------------------------------------------------
+class cmDependsJavaInternals
+{
+public:
+  // The sources scanned now or before, by full path.
+  typedef std::map<std::string, cmDependsJavaSourceInfo> SourceCacheMap;
+  SourceCacheMap SourceCache;
+  bool SourceCacheLoaded;
+
+  // The sources compiled into each class file.
+  typedef std::map<std::string, std::set<std::string> > ObjectSourcesMap;
+  ObjectSourcesMap ObjectSources;
+
+  cmDependsJavaInternals(): SourceCacheLoaded(false) {}
+};
+
 //----------------------------------------------------------------------------
-cmDependsJava::cmDependsJava()
+cmDependsJava::cmDependsJava():
+  Internal(new cmDependsJavaInternals)
 {
 }
 
 //----------------------------------------------------------------------------
 cmDependsJava::~cmDependsJava()
 {
+  delete this->Internal;
 }
 
 //----------------------------------------------------------------------------
 bool cmDependsJava::WriteDependencies(const std::set<std::string>& sources,
-    const std::string&, std::ostream&, std::ostream&)
+    const std::string& obj, std::ostream&, std::ostream&)
 {
   // Make sure this is a scanning instance.
   if(sources.empty() || sources.begin()->empty())
@@ -34,12 +57,426 @@ bool cmDependsJava::WriteDependencies(const std::set<std::string>& sources,
     cmSystemTools::Error("Cannot scan dependencies without an source file.");
     return false;
     }
+  if(obj.empty())
+    {
+    cmSystemTools::Error("Cannot scan dependencies without an object file.");
+    return false;
+    }
+
+  // The dependencies between sources are known only once all of them
+  // are scanned.  They are written by Finalize.
+  std::set<std::string>& objSources = this->Internal->ObjectSources[obj];
+  for(std::set<std::string>::const_iterator it = sources.begin();
+      it != sources.end(); ++it)
+    {
+    cmDependsJavaSourceInfo* info;
+    if(this->GetSourceInfo(*it, info))
+      {
+      objSources.insert(*it);
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool cmDependsJava::Finalize(std::ostream& makeDepends,
+                             std::ostream& internalDepends)
+{
+  typedef cmDependsJavaInternals::SourceCacheMap SourceCacheMap;
+  typedef cmDependsJavaInternals::ObjectSourcesMap ObjectSourcesMap;
+  SourceCacheMap& cache = this->Internal->SourceCache;
+  ObjectSourcesMap const& objects = this->Internal->ObjectSources;
+
+  // Map each type declared in the target to the sources declaring it.
+  typedef std::multimap<std::string, SourceCacheMap::const_iterator>
+    TypeSourcesMap;
+  TypeSourcesMap typeSources;
+  for(ObjectSourcesMap::const_iterator oi = objects.begin();
+      oi != objects.end(); ++oi)
+    {
+    for(std::set<std::string>::const_iterator si = oi->second.begin();
+        si != oi->second.end(); ++si)
+      {
+      SourceCacheMap::const_iterator ci = cache.find(*si);
+      for(std::set<std::string>::const_iterator ti =
+            ci->second.Types.begin(); ti != ci->second.Types.end(); ++ti)
+        {
+        typeSources.insert(TypeSourcesMap::value_type(*ti, ci));
+        }
+      }
+    }
+
+  // The class file of a source depends on the sources declaring the
+  // types it uses.
+  for(ObjectSourcesMap::const_iterator oi = objects.begin();
+      oi != objects.end(); ++oi)
+    {
+    std::set<std::string> dependencies;
+    for(std::set<std::string>::const_iterator si = oi->second.begin();
+        si != oi->second.end(); ++si)
+      {
+      cmDependsJavaSourceInfo const& info = cache.find(*si)->second;
+      for(std::set<std::string>::const_iterator ni = info.Names.begin();
+          ni != info.Names.end(); ++ni)
+        {
+        std::pair<TypeSourcesMap::const_iterator,
+                  TypeSourcesMap::const_iterator> range =
+          typeSources.equal_range(*ni);
+        for(TypeSourcesMap::const_iterator ti = range.first;
+            ti != range.second; ++ti)
+          {
+          SourceCacheMap::const_iterator ci = ti->second;
+          if(ci->first != *si &&
+             this->UsesType(info, ci->second.Package, *ni))
+            {
+            dependencies.insert(ci->first);
+            }
+          }
+        }
+      }
+
+    internalDepends << oi->first << std::endl;
+    for(std::set<std::string>::const_iterator si = oi->second.begin();
+        si != oi->second.end(); ++si)
+      {
+      internalDepends << " " << *si << std::endl;
+      }
+    for(std::set<std::string>::const_iterator di = dependencies.begin();
+        di != dependencies.end(); ++di)
+      {
+      makeDepends << oi->first << ": " <<
+        this->LocalGenerator->Convert(*di,
+                                      cmLocalGenerator::HOME_OUTPUT,
+                                      cmLocalGenerator::MAKEFILE)
+                  << std::endl;
+      internalDepends << " " << *di << std::endl;
+      }
+    makeDepends << std::endl;
+    }
 
+  // Save the sources for the next scan to skip those not edited.
+  if(this->Internal->SourceCacheLoaded)
+    {
+    this->WriteSourceCache();
+    }
   return true;
 }
 
-bool cmDependsJava::CheckDependencies(std::istream&, const char*,
-                             std::map<std::string, DependencyVector >&)
+//----------------------------------------------------------------------------
+bool cmDependsJava::UsesType(cmDependsJavaSourceInfo const& user,
+                             std::string const& package,
+                             std::string const& type)
+{
+  // A type is visible by its simple name in its own package and where
+  // it or its package is imported.
+  if(user.Package == package)
+    {
+    return true;
+    }
+  std::string full = package.empty()? type : package + "." + type;
+  if(user.Imports.find(full) != user.Imports.end() ||
+     (!package.empty() &&
+      user.Imports.find(package + ".*") != user.Imports.end()))
+    {
+    return true;
+    }
+
+  // Otherwise it must be named by its qualified name, possibly followed
+  // by the name of a member or nested type.
+  for(std::set<std::string>::const_iterator qi =
+        user.QualifiedNames.lower_bound(full);
+      qi != user.QualifiedNames.end() &&
+        qi->compare(0, full.size(), full) == 0; ++qi)
+    {
+    if(qi->size() == full.size() || (*qi)[full.size()] == '.')
+      {
+      return true;
+      }
+    }
+  return false;
+}
+
+//----------------------------------------------------------------------------
+bool cmDependsJava::GetSourceInfo(std::string const& src,
+                                  cmDependsJavaSourceInfo*& info)
 {
+  if(!this->Internal->SourceCacheLoaded)
+    {
+    this->Internal->SourceCacheLoaded = true;
+    this->ReadSourceCache();
+    }
+
+  char md5[32];
+  if(!cmSystemTools::ComputeFileMD5(src, md5))
+    {
+    return false;
+    }
+  std::string hash(md5, 32);
+
+  // Scan the source only if it changed since the last scan.
+  info = &this->Internal->SourceCache[src];
+  if(info->Hash != hash)
+    {
+    cmsys::ifstream fin(src.c_str(), std::ios::in | std::ios::binary);
+    if(!fin)
+      {
+      return false;
+      }
+    std::string content;
+    char buffer[16384];
+    while(fin.read(buffer, sizeof(buffer)), fin.gcount() > 0)
+      {
+      content.append(buffer,
+                     static_cast<std::string::size_type>(fin.gcount()));
+      }
+    *info = cmDependsJavaSourceInfo();
+    info->Hash = hash;
+    this->ScanSource(content, *info);
+    }
+  info->Used = true;
   return true;
 }
+
+//----------------------------------------------------------------------------
+static bool cmDependsJavaIsNameChar(char c)
+{
+  return (isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '$' ||
+          (static_cast<unsigned char>(c) & 0x80));
+}
+
+//----------------------------------------------------------------------------
+void cmDependsJava::ScanSource(std::string const& content,
+                               cmDependsJavaSourceInfo& info)
+{
+  // Split the source into possibly qualified names and punctuation.
+  // Comments and literals are skipped.
+  std::vector<std::string> words;
+  std::string::size_type const n = content.size();
+  std::string::size_type i = 0;
+  while(i < n)
+    {
+    char c = content[i];
+    if(isspace(static_cast<unsigned char>(c)))
+      {
+      ++i;
+      }
+    else if(c == '/' && i+1 < n && content[i+1] == '/')
+      {
+      i = content.find('\n', i);
+      }
+    else if(c == '/' && i+1 < n && content[i+1] == '*')
+      {
+      i = content.find("*/", i+2);
+      i = (i == std::string::npos)? i : i+2;
+      }
+    else if(c == '"' || c == '\'')
+      {
+      for(++i; i < n && content[i] != c && content[i] != '\n'; ++i)
+        {
+        if(content[i] == '\\')
+          {
+          ++i;
+          }
+        }
+      ++i;
+      }
+    else if(isdigit(static_cast<unsigned char>(c)))
+      {
+      while(i < n && (cmDependsJavaIsNameChar(content[i]) ||
+                      content[i] == '.'))
+        {
+        ++i;
+        }
+      }
+    else if(cmDependsJavaIsNameChar(c))
+      {
+      std::string::size_type start = i;
+      while(i < n && cmDependsJavaIsNameChar(content[i]))
+        {
+        ++i;
+        }
+      std::string name = content.substr(start, i-start);
+
+      // Continue a qualified name.
+      if(!words.empty() && words.back() == "." && words.size() > 1 &&
+         cmDependsJavaIsNameChar(words[words.size()-2][0]))
+        {
+        words.pop_back();
+        words.back() += ".";
+        words.back() += name;
+        }
+      else
+        {
+        words.push_back(name);
+        }
+      }
+    else if(c == '*' && !words.empty() && words.back() == "." &&
+            words.size() > 1 &&
+            cmDependsJavaIsNameChar(words[words.size()-2][0]))
+      {
+      // The end of an on-demand import.
+      words.pop_back();
+      words.back() += ".*";
+      ++i;
+      }
+    else
+      {
+      words.push_back(std::string(1, c));
+      ++i;
+      }
+    }
+
+  int depth = 0;
+  for(std::vector<std::string>::const_iterator wi = words.begin();
+      wi != words.end(); ++wi)
+    {
+    std::string const& word = *wi;
+    if(word == "{")
+      {
+      ++depth;
+      }
+    else if(word == "}")
+      {
+      depth -= depth > 0? 1 : 0;
+      }
+    else if(!cmDependsJavaIsNameChar(word[0]))
+      {
+      continue;
+      }
+    else if(word == "package" && (wi+1) != words.end())
+      {
+      info.Package = *++wi;
+      }
+    else if(word == "import" && (wi+1) != words.end())
+      {
+      std::string import = *++wi;
+      if(import == "static" && (wi+1) != words.end())
+        {
+        // A static import names members of a type.  Keep the type.
+        import = *++wi;
+        std::string::size_type pos = import.rfind('.');
+        import = import.substr(0, pos);
+        }
+      info.Imports.insert(import);
+      }
+    else if((word == "class" || word == "interface" || word == "enum") &&
+            (wi+1) != words.end() && cmDependsJavaIsNameChar((*(wi+1))[0]))
+      {
+      // Only top-level types have a source of their own.
+      ++wi;
+      if(depth == 0)
+        {
+        info.Types.insert(*wi);
+        }
+      }
+    else
+      {
+      // Any component of a qualified name may be a type.
+      std::string::size_type start = 0;
+      std::string::size_type pos;
+      while((pos = word.find('.', start)) != std::string::npos)
+        {
+        info.Names.insert(word.substr(start, pos-start));
+        start = pos+1;
+        }
+      info.Names.insert(word.substr(start));
+      if(start > 0)
+        {
+        info.QualifiedNames.insert(word);
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+void cmDependsJava::ReadSourceCache()
+{
+  std::string fname = this->TargetDirectory;
+  fname += "/java.sourcecache";
+  cmsys::ifstream fin(fname.c_str());
+  if(!fin)
+    {
+    return;
+    }
+
+  // Fields of an entry follow the path of its source.
+  cmDependsJavaSourceInfo* entry = 0;
+  std::string line;
+  std::string value;
+  while(cmSystemTools::GetLineFromStream(fin, line))
+    {
+    if(line.empty() || line[0] == '#')
+      {
+      entry = 0;
+      }
+    else if(line[0] != ' ')
+      {
+      entry = &this->Internal->SourceCache[line];
+      }
+    else if(!entry)
+      {
+      continue;
+      }
+    else if(this->ReadSourceCacheField(line, "hash", value))
+      {
+      entry->Hash = value;
+      }
+    else if(this->ReadSourceCacheField(line, "package", value))
+      {
+      entry->Package = value;
+      }
+    else if(this->ReadSourceCacheField(line, "type", value))
+      {
+      entry->Types.insert(value);
+      }
+    else if(this->ReadSourceCacheField(line, "import", value))
+      {
+      entry->Imports.insert(value);
+      }
+    else if(this->ReadSourceCacheField(line, "name", value))
+      {
+      entry->Names.insert(value);
+      }
+    else if(this->ReadSourceCacheField(line, "qualified", value))
+      {
+      entry->QualifiedNames.insert(value);
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+void cmDependsJava::WriteSourceCache()
+{
+  std::string fname = this->TargetDirectory;
+  fname += "/java.sourcecache";
+  cmGeneratedFileStream fout(fname.c_str());
+  if(!fout)
+    {
+    return;
+    }
+  fout << "# The scan results of the Java sources of this target.\n";
+
+  // Write only the sources scanned this time; the others were removed
+  // from the target.
+  typedef cmDependsJavaInternals::SourceCacheMap SourceCacheMap;
+  SourceCacheMap const& cache = this->Internal->SourceCache;
+  for(SourceCacheMap::const_iterator ci = cache.begin();
+      ci != cache.end(); ++ci)
+    {
+    cmDependsJavaSourceInfo const& entry = ci->second;
+    if(!entry.Used)
+      {
+      continue;
+      }
+    fout << "\n" << ci->first << "\n";
+    fout << " hash " << entry.Hash << "\n";
+    if(!entry.Package.empty())
+      {
+      fout << " package " << entry.Package << "\n";
+      }
+    this->WriteSourceCacheField(fout, "type", entry.Types);
+    this->WriteSourceCacheField(fout, "import", entry.Imports);
+    this->WriteSourceCacheField(fout, "name", entry.Names);
+    this->WriteSourceCacheField(fout, "qualified", entry.QualifiedNames);
+    }
+}
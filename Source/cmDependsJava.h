@@ -14,8 +14,41 @@
 
 #include "cmDepends.h"
 
+class cmDependsJavaInternals;
+
+/** Information about a single Java source file.  */
+struct cmDependsJavaSourceInfo
+{
+  // The content hash of the source.
+  std::string Hash;
+
+  // The package of the source.
+  std::string Package;
+
+  // The top-level types declared by the source.
+  std::set<std::string> Types;
+
+  // The imported types and packages, the latter ending in ".*".
+  std::set<std::string> Imports;
+
+  // The simple names and the qualified names used by the source.
+  std::set<std::string> Names;
+  std::set<std::string> QualifiedNames;
+
+  // Whether the source was scanned for the target this time.
+  bool Used;
+
+  cmDependsJavaSourceInfo(): Used(false) {}
+};
+
 /** \class cmDependsJava
  * \brief Dependency scanner for Java class files.
+ *
+ * Each source is scanned for its package, the top-level types it
+ * declares, its imports and the names it uses.  The class file of a
+ * source then depends on the sources in the same target that declare a
+ * type it uses.  The scan results are kept in java.sourcecache in the
+ * target directory so only sources that changed are scanned again.
  */
 class cmDependsJava: public cmDepends
 {
@@ -27,14 +60,33 @@ public:
   /** Virtual destructor to cleanup subclasses properly.  */
   virtual ~cmDependsJava();
 
+  /** Scan Java source text for the information used to compute
+      dependencies.  */
+  static void ScanSource(std::string const& content,
+                         cmDependsJavaSourceInfo& info);
+
 protected:
   // Implement writing/checking methods required by superclass.
   virtual bool WriteDependencies(
     const std::set<std::string>& sources, const std::string& file,
     std::ostream& makeDepends, std::ostream& internalDepends);
-  virtual bool CheckDependencies(std::istream& internalDepends,
-                                 const char* internalDependsFileName,
-                           std::map<std::string, DependencyVector>& validDeps);
+
+  // Write the dependencies once all sources are known.
+  virtual bool Finalize(std::ostream& makeDepends,
+                        std::ostream& internalDepends);
+
+  // Get the scan results of a source, scanning it only if it changed.
+  bool GetSourceInfo(std::string const& src, cmDependsJavaSourceInfo*& info);
+
+  // Whether a source uses a type declared by another source.
+  static bool UsesType(cmDependsJavaSourceInfo const& user,
+                       std::string const& package, std::string const& type);
+
+  void ReadSourceCache();
+  void WriteSourceCache();
+
+  // Internal implementation details.
+  cmDependsJavaInternals* Internal;
 
 private:
   cmDependsJava(cmDependsJava const&); // Purposely not implemented.
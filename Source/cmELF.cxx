@@ -461,13 +461,17 @@ private:
       {
       return false;
       }
+    this->IdentifySection(i);
+    return true;
+    }
 
+  void IdentifySection(ELF_Half i)
+    {
     // Identify some important sections.
     if(this->SectionHeaders[i].sh_type == SHT_DYNAMIC)
       {
       this->DynamicSectionIndex = i;
       }
-    return true;
     }
 
   bool LoadDynamicSection();
@@ -541,6 +545,27 @@ cmELFInternalImpl<Types>
 
   // Load the section headers.
   this->SectionHeaders.resize(this->ELFHeader.e_shnum);
+  if(this->ELFHeader.e_shnum > 0 &&
+     this->ELFHeader.e_shentsize == sizeof(ELF_Shdr))
+    {
+    // The table is contiguous so read it with a single request.
+    this->Stream.seekg(this->ELFHeader.e_shoff);
+    if(!this->Stream.read(reinterpret_cast<char*>(&this->SectionHeaders[0]),
+                          sizeof(ELF_Shdr) * this->ELFHeader.e_shnum))
+      {
+      this->SetErrorMessage("Failed to load section headers.");
+      return;
+      }
+    for(ELF_Half i=0; i < this->ELFHeader.e_shnum; ++i)
+      {
+      if(this->NeedSwap)
+        {
+        ByteSwap(this->SectionHeaders[i]);
+        }
+      this->IdentifySection(i);
+      }
+    return;
+    }
   for(ELF_Half i=0; i < this->ELFHeader.e_shnum; ++i)
     {
     if(!this->LoadSectionHeader(i))
@@ -572,6 +597,29 @@ bool cmELFInternalImpl<Types>::LoadDynamicSection()
   int n = static_cast<int>(sec.sh_size / sec.sh_entsize);
   this->DynamicSectionEntries.resize(n);
 
+  // Read the whole section at once when entries are packed.
+  if(n > 0 && sec.sh_entsize == sizeof(ELF_Dyn))
+    {
+    this->Stream.seekg(sec.sh_offset);
+    if(!this->Stream.read(
+         reinterpret_cast<char*>(&this->DynamicSectionEntries[0]),
+         sizeof(ELF_Dyn) * n))
+      {
+      this->SetErrorMessage("Error reading entry from DYNAMIC section.");
+      this->DynamicSectionIndex = -1;
+      this->DynamicSectionEntries.clear();
+      return false;
+      }
+    if(this->NeedSwap)
+      {
+      for(int j=0; j < n; ++j)
+        {
+        ByteSwap(this->DynamicSectionEntries[j]);
+        }
+      }
+    return true;
+    }
+
   // Read each entry.
   for(int j=0; j < n; ++j)
     {
@@ -690,23 +738,45 @@ cmELFInternalImpl<Types>::GetDynamicSectionString(unsigned int tag)
       // the string.  This assumes that the next string in the table
       // is non-empty, but the "chrpath" tool makes the same
       // assumption.
+      // Read in blocks rather than one character at a time.
       bool terminated = false;
-      char c;
-      while(last != end && this->Stream.get(c) && !(terminated && c))
+      bool done = false;
+      bool ok = true;
+      char buf[512];
+      while(!done && last != end)
         {
-        ++last;
-        if(c)
+        unsigned long n = end - last;
+        if(n > sizeof(buf))
+          {
+          n = sizeof(buf);
+          }
+        if(!this->Stream.read(buf, static_cast<std::streamsize>(n)))
           {
-          se.Value += c;
+          ok = false;
+          break;
           }
-        else
+        for(unsigned long k=0; k < n; ++k)
           {
-          terminated = true;
+          char c = buf[k];
+          if(terminated && c)
+            {
+            done = true;
+            break;
+            }
+          ++last;
+          if(c)
+            {
+            se.Value += c;
+            }
+          else
+            {
+            terminated = true;
+            }
           }
         }
 
       // Make sure the whole value was read.
-      if(!this->Stream)
+      if(!ok)
         {
         this->SetErrorMessage("Dynamic section specifies unreadable RPATH.");
         se.Value = "";
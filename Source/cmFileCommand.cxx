@@ -15,6 +15,7 @@
 #include "cmHexFileConverter.h"
 #include "cmInstallType.h"
 #include "cmFileTimeComparison.h"
+#include "cmFileHashCache.h"
 #include "cmCryptoHash.h"
 
 #include "cmTimestamp.h"
@@ -33,6 +34,7 @@
 #include <cmsys/Glob.hxx>
 #include <cmsys/RegularExpression.hxx>
 #include <cmsys/FStream.hxx>
+#include <cmsys/Process.h>
 
 // Table of permissions flags.
 #if defined(_WIN32) && !defined(__CYGWIN__)
@@ -957,6 +959,13 @@ struct cmFileCopier
     Makefile(command->GetMakefile()),
     Name(name),
     Always(false),
+    Reflink(false),
+    Jobs(1),
+    HashCache(0),
+    CopiedFiles(0),
+    SkippedFiles(0),
+    CopiedBytes(0),
+    SkippedBytes(0),
     MatchlessFiles(true),
     FilePermissions(0),
     DirPermissions(0),
@@ -978,6 +987,38 @@ protected:
   bool Always;
   cmFileTimeComparison FileTimes;
 
+  // Whether to try cloning files (reflink) before copying them.
+  bool Reflink;
+
+  // Number of processes copying file contents.  With more than one the
+  // copies are planned during the traversal and executed at the end,
+  // followed by the file times and permissions in the original order.
+  unsigned int Jobs;
+  struct PlannedFile
+  {
+    std::string From;
+    std::string To;
+    bool Copy;
+    bool Touch;
+    mode_t Permissions;
+  };
+  std::vector<PlannedFile> PlannedFiles;
+  std::set<std::string> PlannedDestinations;
+  std::vector<std::pair<std::string, mode_t> > PlannedDirPermissions;
+  bool CanPlanFile(const char* fromFile, const char* toFile);
+  bool ExecutePlan();
+  bool CopyPlannedFiles(std::vector<PlannedFile> const& files);
+
+  // Recorded content hashes to skip files whose time changed but whose
+  // content did not, and the amount of data copied and skipped.
+  cmFileHashCache* HashCache;
+  unsigned long CopiedFiles;
+  unsigned long SkippedFiles;
+  double CopiedBytes;
+  double SkippedBytes;
+  bool ContentUnchanged(const char* fromFile, const char* toFile);
+  void RecordInstalled(const char* fromFile, const char* toFile);
+
   // Whether to install a file not matching any expression.
   bool MatchlessFiles;
 
@@ -1452,7 +1493,7 @@ bool cmFileCopier::Run(std::vector<std::string> const& args)
       return false;
       }
     }
-  return true;
+  return this->ExecutePlan();
 }
 
 //----------------------------------------------------------------------------
@@ -1497,6 +1538,12 @@ bool cmFileCopier::Install(const char* fromFile, const char* toFile)
 //----------------------------------------------------------------------------
 bool cmFileCopier::InstallSymlink(const char* fromFile, const char* toFile)
 {
+  // Replace a file planned to be copied to the same destination.
+  if(this->PlannedDestinations.count(toFile) && !this->ExecutePlan())
+    {
+    return false;
+    }
+
   // Read the original symlink.
   std::string symlinkTarget;
   if(!cmSystemTools::ReadSymlink(fromFile, symlinkTarget))
@@ -1549,8 +1596,20 @@ bool cmFileCopier::InstallSymlink(const char* fromFile, const char* toFile)
 bool cmFileCopier::InstallFile(const char* fromFile, const char* toFile,
                                MatchProperties const& match_properties)
 {
+  // Install the planned files first if this one cannot join them.
+  bool plan = this->Jobs > 1;
+  if(plan && !this->CanPlanFile(fromFile, toFile))
+    {
+    plan = false;
+    if(!this->ExecutePlan())
+      {
+      return false;
+      }
+    }
+
   // Determine whether we will copy the file.
   bool copy = true;
+  bool touch = false;
   if(!this->Always)
     {
     // If both files exist with the same time do not copy.
@@ -1558,13 +1617,63 @@ bool cmFileCopier::InstallFile(const char* fromFile, const char* toFile,
       {
       copy = false;
       }
+    // If both files have the same content only copy the time.
+    else if(this->ContentUnchanged(fromFile, toFile))
+      {
+      copy = false;
+      touch = true;
+      }
     }
 
   // Inform the user about this file installation.
   this->ReportCopy(toFile, TypeFile, copy);
+  if(this->HashCache)
+    {
+    double size = static_cast<double>(cmSystemTools::FileLength(fromFile));
+    if(copy)
+      {
+      ++this->CopiedFiles;
+      this->CopiedBytes += size;
+      }
+    else
+      {
+      ++this->SkippedFiles;
+      this->SkippedBytes += size;
+      }
+    }
+
+  // Compute the permissions of the destination file.
+  mode_t permissions = (match_properties.Permissions?
+                        match_properties.Permissions : this->FilePermissions);
+  if(!permissions)
+    {
+    // No permissions were explicitly provided but the user requested
+    // that the source file permissions be used.
+    cmSystemTools::GetPermissions(fromFile, permissions);
+    }
+
+  // Leave the copy to the worker processes if there are any.
+  if(plan)
+    {
+    PlannedFile pf;
+    pf.From = fromFile;
+    pf.To = toFile;
+    pf.Copy = copy;
+    pf.Touch = touch;
+    pf.Permissions = permissions;
+    this->PlannedFiles.push_back(pf);
+    this->PlannedDestinations.insert(pf.To);
+    return true;
+    }
 
-  // Copy the file.
-  if(copy && !cmSystemTools::CopyAFile(fromFile, toFile, true))
+  // Clone the file if possible, or copy it.
+  bool cloned = false;
+  if(copy && this->Reflink)
+    {
+    cmSystemTools::RemoveFile(toFile);
+    cloned = cmSystemTools::CloneFile(fromFile, toFile);
+    }
+  if(copy && !cloned && !cmSystemTools::CopyAFile(fromFile, toFile, true))
     {
     cmOStringStream e;
     e << this->Name << " cannot copy file \"" << fromFile
@@ -1574,7 +1683,7 @@ bool cmFileCopier::InstallFile(const char* fromFile, const char* toFile,
     }
 
   // Set the file modification time of the destination file.
-  if(copy && !this->Always)
+  if((copy && !this->Always) || touch)
     {
     // Add write permission so we can set the file time.
     // Permissions are set unconditionally below anyway.
@@ -1591,18 +1700,45 @@ bool cmFileCopier::InstallFile(const char* fromFile, const char* toFile,
       this->FileCommand->SetError(e.str());
       return false;
       }
+    this->RecordInstalled(fromFile, toFile);
     }
 
   // Set permissions of the destination file.
-  mode_t permissions = (match_properties.Permissions?
-                        match_properties.Permissions : this->FilePermissions);
-  if(!permissions)
+  return this->SetPermissions(toFile, permissions);
+}
+
+//----------------------------------------------------------------------------
+bool cmFileCopier::ContentUnchanged(const char* fromFile, const char* toFile)
+{
+#if defined(CMAKE_BUILD_WITH_CMAKE)
+  // Hash the source even if the destination is unknown so that it can
+  // be recorded once copied.
+  std::string fromHash;
+  std::string toHash;
+  return (this->HashCache &&
+          this->HashCache->Hash(fromFile, fromHash) &&
+          this->HashCache->Lookup(toFile, toHash) &&
+          fromHash == toHash);
+#else
+  (void)fromFile;
+  (void)toFile;
+  return false;
+#endif
+}
+
+//----------------------------------------------------------------------------
+void cmFileCopier::RecordInstalled(const char* fromFile, const char* toFile)
+{
+#if defined(CMAKE_BUILD_WITH_CMAKE)
+  std::string hash;
+  if(this->HashCache && this->HashCache->Lookup(fromFile, hash))
     {
-    // No permissions were explicitly provided but the user requested
-    // that the source file permissions be used.
-    cmSystemTools::GetPermissions(fromFile, permissions);
+    this->HashCache->Record(toFile, hash);
     }
-  return this->SetPermissions(toFile, permissions);
+#else
+  (void)fromFile;
+  (void)toFile;
+#endif
 }
 
 //----------------------------------------------------------------------------
@@ -1684,10 +1820,204 @@ bool cmFileCopier::InstallDirectory(const char* source,
       }
     }
 
-  // Set the requested permissions of the destination directory.
+  // Set the requested permissions of the destination directory.  Files
+  // still to be copied by worker processes need the directory writable.
+  if(this->Jobs > 1)
+    {
+    this->PlannedDirPermissions.push_back(
+      std::make_pair(std::string(destination), permissions_after));
+    return true;
+    }
   return this->SetPermissions(destination, permissions_after);
 }
 
+//----------------------------------------------------------------------------
+bool cmFileCopier::CanPlanFile(const char* fromFile, const char* toFile)
+{
+  // The workers read one path per line and copy their files in any
+  // order.  A path containing a newline would break the list, and two
+  // files copied to the same destination must be copied in order for
+  // the last one to win as when installing serially.
+  return (!strchr(fromFile, '\n') && !strchr(toFile, '\n') &&
+          this->PlannedDestinations.find(toFile) ==
+          this->PlannedDestinations.end());
+}
+
+//----------------------------------------------------------------------------
+bool cmFileCopier::ExecutePlan()
+{
+  if(this->PlannedFiles.empty() && this->PlannedDirPermissions.empty())
+    {
+    return true;
+    }
+
+  // Copy the file contents in worker processes.
+  std::vector<PlannedFile> copies;
+  for(std::vector<PlannedFile>::const_iterator i = this->PlannedFiles.begin();
+      i != this->PlannedFiles.end(); ++i)
+    {
+    if(i->Copy)
+      {
+      copies.push_back(*i);
+      }
+    }
+  if(!this->CopyPlannedFiles(copies))
+    {
+    return false;
+    }
+
+  // Set file times and permissions in the order the files were visited.
+  for(std::vector<PlannedFile>::const_iterator i = this->PlannedFiles.begin();
+      i != this->PlannedFiles.end(); ++i)
+    {
+    if((i->Copy && !this->Always) || i->Touch)
+      {
+      // Add write permission so we can set the file time.
+      mode_t perm = 0;
+      if(cmSystemTools::GetPermissions(i->To.c_str(), perm))
+        {
+        cmSystemTools::SetPermissions(i->To.c_str(), perm | mode_owner_write);
+        }
+      if(!cmSystemTools::CopyFileTime(i->From.c_str(), i->To.c_str()))
+        {
+        cmOStringStream e;
+        e << this->Name << " cannot set modification time on \""
+          << i->To << "\"";
+        this->FileCommand->SetError(e.str());
+        return false;
+        }
+      this->RecordInstalled(i->From.c_str(), i->To.c_str());
+      }
+    if(!this->SetPermissions(i->To.c_str(), i->Permissions))
+      {
+      return false;
+      }
+    }
+  for(std::vector<std::pair<std::string, mode_t> >::const_iterator i =
+        this->PlannedDirPermissions.begin();
+      i != this->PlannedDirPermissions.end(); ++i)
+    {
+    if(!this->SetPermissions(i->first.c_str(), i->second))
+      {
+      return false;
+      }
+    }
+  this->PlannedFiles.clear();
+  this->PlannedDestinations.clear();
+  this->PlannedDirPermissions.clear();
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool cmFileCopier::CopyPlannedFiles(std::vector<PlannedFile> const& files)
+{
+  // Starting processes is not worth it for a few files.
+  unsigned int jobs = this->Jobs;
+  if(files.size() < 8 * jobs)
+    {
+    jobs = static_cast<unsigned int>(files.size() / 8);
+    }
+  if(jobs < 2)
+    {
+    for(std::vector<PlannedFile>::const_iterator i = files.begin();
+        i != files.end(); ++i)
+      {
+      bool cloned = false;
+      if(this->Reflink)
+        {
+        cmSystemTools::RemoveFile(i->To.c_str());
+        cloned = cmSystemTools::CloneFile(i->From.c_str(), i->To.c_str());
+        }
+      if(!cloned &&
+         !cmSystemTools::CopyAFile(i->From.c_str(), i->To.c_str(), true))
+        {
+        cmOStringStream e;
+        e << this->Name << " cannot copy file \"" << i->From
+          << "\" to \"" << i->To << "\".";
+        this->FileCommand->SetError(e.str());
+        return false;
+        }
+      }
+    return true;
+    }
+
+  // Each worker reads pairs of source and destination lines from a file
+  // and copies them with "cmake -E cmake_copy_files".
+  std::string listBase = this->Makefile->GetCurrentOutputDirectory();
+  listBase += cmake::GetCMakeFilesDirectory();
+  cmSystemTools::MakeDirectory(listBase.c_str());
+  // Installations may run concurrently in the same directory.
+  cmOStringStream base;
+  base << listBase << "/InstallFiles-" << cmSystemTools::RandomSeed() << "-";
+  listBase = base.str();
+  std::vector<std::string> lists;
+  for(unsigned int j = 0; j < jobs; ++j)
+    {
+    cmOStringStream name;
+    name << listBase << j << ".txt";
+    lists.push_back(name.str());
+    cmsys::ofstream fout(name.str().c_str());
+    for(size_t i = j; i < files.size(); i += jobs)
+      {
+      fout << files[i].From << "\n" << files[i].To << "\n";
+      }
+    if(!fout)
+      {
+      cmOStringStream e;
+      e << this->Name << " cannot write \"" << name.str() << "\".";
+      this->FileCommand->SetError(e.str());
+      return false;
+      }
+    }
+
+  std::vector<cmsysProcess*> workers;
+  for(std::vector<std::string>::const_iterator l = lists.begin();
+      l != lists.end(); ++l)
+    {
+    std::vector<const char*> argv;
+    argv.push_back(cmSystemTools::GetCMakeCommand().c_str());
+    argv.push_back("-E");
+    argv.push_back("cmake_copy_files");
+    argv.push_back(l->c_str());
+    if(this->Reflink)
+      {
+      argv.push_back("--reflink");
+      }
+    argv.push_back(0);
+    cmsysProcess* cp = cmsysProcess_New();
+    cmsysProcess_SetCommand(cp, &*argv.begin());
+    cmsysProcess_SetOption(cp, cmsysProcess_Option_HideWindow, 1);
+    cmsysProcess_SetPipeShared(cp, cmsysProcess_Pipe_STDOUT, 1);
+    cmsysProcess_SetPipeShared(cp, cmsysProcess_Pipe_STDERR, 1);
+    cmsysProcess_Execute(cp);
+    workers.push_back(cp);
+    }
+  bool okay = true;
+  for(std::vector<cmsysProcess*>::const_iterator w = workers.begin();
+      w != workers.end(); ++w)
+    {
+    cmsysProcess_WaitForExit(*w, 0);
+    okay = okay &&
+      cmsysProcess_GetState(*w) == cmsysProcess_State_Exited &&
+      cmsysProcess_GetExitValue(*w) == 0;
+    cmsysProcess_Delete(*w);
+    }
+  for(std::vector<std::string>::const_iterator l = lists.begin();
+      l != lists.end(); ++l)
+    {
+    cmSystemTools::RemoveFile(l->c_str());
+    }
+  if(!okay)
+    {
+    cmOStringStream e;
+    e << this->Name << " cannot copy files to \""
+      << this->Destination << "\".";
+    this->FileCommand->SetError(e.str());
+    return false;
+    }
+  return true;
+}
+
 //----------------------------------------------------------------------------
 bool cmFileCommand::HandleCopyCommand(std::vector<std::string> const& args)
 {
@@ -1709,12 +2039,43 @@ struct cmFileInstaller: public cmFileCopier
     // Check whether to copy files always or only if they have changed.
     this->Always =
       cmSystemTools::IsOn(cmSystemTools::GetEnv("CMAKE_INSTALL_ALWAYS"));
+    // Check whether to use recorded content hashes.
+#if defined(CMAKE_BUILD_WITH_CMAKE)
+    if(const char* cache = cmSystemTools::GetEnv("CMAKE_INSTALL_HASH_CACHE"))
+      {
+      if(*cache)
+        {
+        this->HashCache = &cmFileHashCache::Get(cache);
+        }
+      }
+#endif
+    // Check whether to copy files in parallel processes.
+    if(const char* jobs = cmSystemTools::GetEnv("CMAKE_INSTALL_JOBS"))
+      {
+      int n = atoi(jobs);
+      this->Jobs = n > 1? static_cast<unsigned int>(n) : 1;
+      }
+    // Check whether to clone files on file systems supporting it.
+    this->Reflink = this->Makefile->IsOn("CMAKE_INSTALL_REFLINK");
     // Get the current manifest.
     this->Manifest =
       this->Makefile->GetSafeDefinition("CMAKE_INSTALL_MANIFEST_FILES");
     }
   ~cmFileInstaller()
     {
+#if defined(CMAKE_BUILD_WITH_CMAKE)
+    // Report the amount of data copied and save the recorded hashes.
+    if(this->HashCache)
+      {
+      cmOStringStream msg;
+      msg << "Install summary: " << this->CopiedFiles << " files ("
+          << this->CopiedBytes / 1048576.0 << " MB) copied, "
+          << this->SkippedFiles << " files ("
+          << this->SkippedBytes / 1048576.0 << " MB) up-to-date";
+      this->Makefile->DisplayStatus(msg.str().c_str(), -1);
+      this->HashCache->Save();
+      }
+#endif
     // Save the updated install manifest.
     this->Makefile->AddDefinition("CMAKE_INSTALL_MANIFEST_FILES",
                                   this->Manifest.c_str());
@@ -2080,7 +2441,7 @@ bool
 cmFileCommand::HandleRPathChangeCommand(std::vector<std::string> const& args)
 {
   // Evaluate arguments.
-  const char* file = 0;
+  std::vector<std::string> files;
   const char* oldRPath = 0;
   const char* newRPath = 0;
   enum Doing { DoingNone, DoingFile, DoingOld, DoingNew };
@@ -2101,8 +2462,8 @@ cmFileCommand::HandleRPathChangeCommand(std::vector<std::string> const& args)
       }
     else if(doing == DoingFile)
       {
-      file = args[i].c_str();
-      doing = DoingNone;
+      // Many files may be updated in one call.
+      files.push_back(args[i]);
       }
     else if(doing == DoingOld)
       {
@@ -2122,7 +2483,7 @@ cmFileCommand::HandleRPathChangeCommand(std::vector<std::string> const& args)
       return false;
       }
     }
-  if(!file)
+  if(files.empty())
     {
     this->SetError("RPATH_CHANGE not given FILE option.");
     return false;
@@ -2137,6 +2498,21 @@ cmFileCommand::HandleRPathChangeCommand(std::vector<std::string> const& args)
     this->SetError("RPATH_CHANGE not given NEW_RPATH option.");
     return false;
     }
+  for(std::vector<std::string>::const_iterator fi = files.begin();
+      fi != files.end(); ++fi)
+    {
+    if(!this->RPathChange(fi->c_str(), oldRPath, newRPath))
+      {
+      return false;
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool cmFileCommand::RPathChange(const char* file, const char* oldRPath,
+                                const char* newRPath)
+{
   if(!cmSystemTools::FileExists(file, true))
     {
     cmOStringStream e;
@@ -2185,7 +2561,7 @@ bool
 cmFileCommand::HandleRPathRemoveCommand(std::vector<std::string> const& args)
 {
   // Evaluate arguments.
-  const char* file = 0;
+  std::vector<std::string> files;
   enum Doing { DoingNone, DoingFile };
   Doing doing = DoingNone;
   for(unsigned int i=1; i < args.size(); ++i)
@@ -2196,8 +2572,7 @@ cmFileCommand::HandleRPathRemoveCommand(std::vector<std::string> const& args)
       }
     else if(doing == DoingFile)
       {
-      file = args[i].c_str();
-      doing = DoingNone;
+      files.push_back(args[i]);
       }
     else
       {
@@ -2207,11 +2582,25 @@ cmFileCommand::HandleRPathRemoveCommand(std::vector<std::string> const& args)
       return false;
       }
     }
-  if(!file)
+  if(files.empty())
     {
     this->SetError("RPATH_REMOVE not given FILE option.");
     return false;
     }
+  for(std::vector<std::string>::const_iterator fi = files.begin();
+      fi != files.end(); ++fi)
+    {
+    if(!this->RPathRemove(fi->c_str()))
+      {
+      return false;
+      }
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool cmFileCommand::RPathRemove(const char* file)
+{
   if(!cmSystemTools::FileExists(file, true))
     {
     cmOStringStream e;
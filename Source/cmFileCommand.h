@@ -66,6 +66,9 @@ protected:
   bool HandleRPathChangeCommand(std::vector<std::string> const& args);
   bool HandleRPathCheckCommand(std::vector<std::string> const& args);
   bool HandleRPathRemoveCommand(std::vector<std::string> const& args);
+  bool RPathChange(const char* file, const char* oldRPath,
+                   const char* newRPath);
+  bool RPathRemove(const char* file);
   bool HandleDifferentCommand(std::vector<std::string> const& args);
 
   bool HandleCopyCommand(std::vector<std::string> const& args);
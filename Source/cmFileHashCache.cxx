@@ -0,0 +1,170 @@
+/*============================================================================
+  CMake - Cross Platform Makefile Generator
+  Copyright 2000-2009 Kitware, Inc., Insight Software Consortium
+
+  Distributed under the OSI-approved BSD License (the "License");
+  see accompanying file Copyright.txt for details.
+
+  This software is distributed WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the License for more information.
+============================================================================*/
+#include "cmFileHashCache.h"
+
+#include "cmSystemTools.h"
+#include "cmCryptoHash.h"
+
+#include <cmsys/FStream.hxx>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+//----------------------------------------------------------------------------
+cmFileHashCache& cmFileHashCache::Get(std::string const& file)
+{
+  static std::map<std::string, cmFileHashCache> caches;
+  std::map<std::string, cmFileHashCache>::iterator i = caches.find(file);
+  if(i == caches.end())
+    {
+    i = caches.insert(std::make_pair(file, cmFileHashCache())).first;
+    i->second.File = file;
+    i->second.Load();
+    }
+  return i->second;
+}
+
+//----------------------------------------------------------------------------
+std::string cmFileHashCache::GetSignature(std::string const& path)
+{
+  struct stat st;
+  if(stat(path.c_str(), &st) != 0)
+    {
+    return "";
+    }
+  cmOStringStream sig;
+  sig << static_cast<unsigned long>(st.st_size) << ":"
+      << static_cast<long>(st.st_mtime);
+#if cmsys_STAT_HAS_ST_MTIM
+  sig << "." << static_cast<long>(st.st_mtim.tv_nsec);
+#endif
+  return sig.str();
+}
+
+//----------------------------------------------------------------------------
+void cmFileHashCache::Load()
+{
+  // Each line holds the MD5 sum, the signature and the path, separated
+  // by single spaces.  Later lines replace earlier ones.
+  this->Lines = 0;
+  cmsys::ifstream fin(this->File.c_str());
+  std::string line;
+  while(cmSystemTools::GetLineFromStream(fin, line))
+    {
+    std::string::size_type sep1 = line.find(' ');
+    std::string::size_type sep2 =
+      sep1 == line.npos? line.npos : line.find(' ', sep1 + 1);
+    if(sep2 == line.npos)
+      {
+      continue;
+      }
+    Entry& e = this->Entries[line.substr(sep2 + 1)];
+    e.MD5 = line.substr(0, sep1);
+    e.Signature = line.substr(sep1 + 1, sep2 - sep1 - 1);
+    ++this->Lines;
+    }
+}
+
+//----------------------------------------------------------------------------
+bool cmFileHashCache::Lookup(std::string const& path, std::string& md5)
+{
+  std::map<std::string, Entry>::const_iterator i = this->Entries.find(path);
+  if(i == this->Entries.end() ||
+     i->second.Signature != cmFileHashCache::GetSignature(path))
+    {
+    return false;
+    }
+  md5 = i->second.MD5;
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool cmFileHashCache::Hash(std::string const& path, std::string& md5)
+{
+  if(this->Lookup(path, md5))
+    {
+    return true;
+    }
+  if(!cmFileHashCache::ComputeHash(path, md5))
+    {
+    return false;
+    }
+  this->Record(path, md5);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void cmFileHashCache::Record(std::string const& path, std::string const& md5)
+{
+  std::string sig = cmFileHashCache::GetSignature(path);
+  if(sig.empty())
+    {
+    return;
+    }
+  Entry& e = this->Entries[path];
+  if(e.Signature != sig || e.MD5 != md5)
+    {
+    e.Signature = sig;
+    e.MD5 = md5;
+    this->Changed.insert(path);
+    }
+}
+
+//----------------------------------------------------------------------------
+bool cmFileHashCache::ComputeHash(std::string const& path, std::string& md5)
+{
+  cmCryptoHashMD5 hash;
+  md5 = hash.HashFile(path);
+  return !md5.empty();
+}
+
+//----------------------------------------------------------------------------
+bool cmFileHashCache::Save()
+{
+  if(this->Changed.empty())
+    {
+    return true;
+    }
+
+  // Append the changed records unless most of the file is outdated.
+  bool rewrite = this->Lines + this->Changed.size() >
+    2 * this->Entries.size() + 64;
+  cmsys::ofstream fout(this->File.c_str(), rewrite? std::ios::out :
+                       std::ios::out | std::ios::app);
+  if(!fout)
+    {
+    return false;
+    }
+  if(rewrite)
+    {
+    this->Lines = 0;
+    for(std::map<std::string, Entry>::const_iterator i =
+          this->Entries.begin(); i != this->Entries.end(); ++i)
+      {
+      fout << i->second.MD5 << " " << i->second.Signature << " "
+           << i->first << "\n";
+      ++this->Lines;
+      }
+    }
+  else
+    {
+    for(std::set<std::string>::const_iterator i = this->Changed.begin();
+        i != this->Changed.end(); ++i)
+      {
+      Entry const& e = this->Entries[*i];
+      fout << e.MD5 << " " << e.Signature << " " << *i << "\n";
+      ++this->Lines;
+      }
+    }
+  this->Changed.clear();
+  return fout? true : false;
+}
@@ -0,0 +1,63 @@
+/*============================================================================
+  CMake - Cross Platform Makefile Generator
+  Copyright 2000-2009 Kitware, Inc., Insight Software Consortium
+
+  Distributed under the OSI-approved BSD License (the "License");
+  see accompanying file Copyright.txt for details.
+
+  This software is distributed WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the License for more information.
+============================================================================*/
+#ifndef cmFileHashCache_h
+#define cmFileHashCache_h
+
+#include "cmStandardIncludes.h"
+
+/** \class cmFileHashCache
+ * \brief Persistent MD5 sums of files keyed by their size and time.
+ *
+ * The sums are kept in a text file and reused while the size and
+ * modification time of a file are unchanged, so comparing the content
+ * of an unchanged file takes a single stat instead of reading it.
+ */
+class cmFileHashCache
+{
+public:
+  /** Get the cache stored in the given file.  It is loaded on first
+      use and shared by the whole process.  */
+  static cmFileHashCache& Get(std::string const& file);
+
+  /** Get the recorded MD5 sum of a file if the file has not changed
+      since it was recorded.  The file is not read.  */
+  bool Lookup(std::string const& path, std::string& md5);
+
+  /** Get the MD5 sum of a file, reading it only if there is no valid
+      record, and record the result.  */
+  bool Hash(std::string const& path, std::string& md5);
+
+  /** Record the MD5 sum of a file as it is now on disk.  */
+  void Record(std::string const& path, std::string const& md5);
+
+  /** Compute the MD5 sum of a file without recording it.  */
+  static bool ComputeHash(std::string const& path, std::string& md5);
+
+  /** Write the records changed since the last call to the file.  */
+  bool Save();
+
+private:
+  void Load();
+  static std::string GetSignature(std::string const& path);
+
+  struct Entry
+  {
+    std::string Signature;
+    std::string MD5;
+  };
+  std::string File;
+  std::map<std::string, Entry> Entries;
+  std::set<std::string> Changed;
+  size_t Lines;
+};
+
+#endif
@@ -37,6 +37,8 @@ public:
 
   bool FileTimesDiffer(const char* f1, const char* f2);
 
+  bool GetFileTime(const char* fname, long stamp[2]);
+
 private:
 #if defined(CMAKE_BUILD_WITH_CMAKE)
   // Use a hash table to efficiently map from file name to modification time.
@@ -131,6 +133,31 @@ bool cmFileTimeComparison::FileTimesDiffer(const char* f1, const char* f2)
   return this->Internals->FileTimesDiffer(f1, f2);
 }
 
+//----------------------------------------------------------------------------
+bool cmFileTimeComparison::GetFileTime(const char* fname, long stamp[2])
+{
+  return this->Internals->GetFileTime(fname, stamp);
+}
+
+//----------------------------------------------------------------------------
+int cmFileTimeComparison::CompareFileTimes(const long s1[2],
+                                           const long s2[2])
+{
+  // The second part is a fraction of the first, or on Windows the low
+  // word of the time, so it compares as unsigned.
+  if(s1[0] != s2[0])
+    {
+    return s1[0] < s2[0]? -1 : 1;
+    }
+  unsigned long l1 = static_cast<unsigned long>(s1[1]);
+  unsigned long l2 = static_cast<unsigned long>(s2[1]);
+  if(l1 != l2)
+    {
+    return l1 < l2? -1 : 1;
+    }
+  return 0;
+}
+
 //----------------------------------------------------------------------------
 int cmFileTimeComparisonInternal::Compare(cmFileTimeComparison_Type* s1,
                                           cmFileTimeComparison_Type* s2)
@@ -275,3 +302,27 @@ bool cmFileTimeComparisonInternal::FileTimesDiffer(const char* f1,
     return true;
     }
 }
+
+//----------------------------------------------------------------------------
+bool cmFileTimeComparisonInternal::GetFileTime(const char* fname,
+                                               long stamp[2])
+{
+  cmFileTimeComparison_Type st;
+  if(!this->Stat(fname, &st))
+    {
+    return false;
+    }
+#if !defined(_WIN32) || defined(__CYGWIN__)
+# if cmsys_STAT_HAS_ST_MTIM
+  stamp[0] = static_cast<long>(st.st_mtim.tv_sec);
+  stamp[1] = static_cast<long>(st.st_mtim.tv_nsec);
+# else
+  stamp[0] = static_cast<long>(st.st_mtime);
+  stamp[1] = 0;
+# endif
+#else
+  stamp[0] = static_cast<long>(st.dwHighDateTime);
+  stamp[1] = static_cast<long>(st.dwLowDateTime);
+#endif
+  return true;
+}
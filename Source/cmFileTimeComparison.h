@@ -41,6 +41,19 @@ public:
    */
   bool FileTimesDiffer(const char* f1, const char* f2);
 
+  /**
+   *  Get the modification time of a file as two integers that may be
+   *  stored and later compared for equality with another call.
+   *  Return false if the file does not exist.
+   */
+  bool GetFileTime(const char* fname, long stamp[2]);
+
+  /**
+   *  Compare two times obtained from GetFileTime.  Return -1, 0, +1
+   *  for s1 older, same, or newer than s2.
+   */
+  static int CompareFileTimes(const long s1[2], const long s2[2]);
+
 protected:
 
   cmFileTimeComparisonInternal* Internals;
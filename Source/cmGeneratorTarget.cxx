@@ -20,6 +20,7 @@
 #include "cmGeneratorExpressionDAGChecker.h"
 #include "cmComputeLinkInformation.h"
 #include "cmCustomCommandGenerator.h"
+#include "cmGeneratedFileStream.h"
 
 #include <queue>
 
@@ -313,6 +314,12 @@ cmGeneratorTarget
 {
   IMPLEMENT_VISIT(ObjectSources);
 
+  if(this->GlobalGenerator->SupportsUnityBuilds() &&
+     this->Target->GetPropertyAsBool("UNITY_BUILD"))
+    {
+    this->AddUnitySources(data, config);
+    }
+
   if (!this->Objects.empty())
     {
     return;
@@ -327,6 +334,152 @@ cmGeneratorTarget
   this->LocalGenerator->ComputeObjectFilenames(this->Objects, this);
 }
 
+void
+cmGeneratorTarget::AddUnitySources(std::vector<cmSourceFile const*>& sources,
+                                   const std::string& config) const
+{
+  std::map<std::string, std::vector<cmSourceFile const*> >::const_iterator
+    ui = this->UnitySources.find(config);
+  if(ui != this->UnitySources.end())
+    {
+    sources = ui->second;
+    return;
+    }
+
+  // Sources may share a unity source only if they are compiled with the
+  // same source file properties.
+  std::vector<std::string> props;
+  props.push_back("COMPILE_FLAGS");
+  props.push_back("COMPILE_DEFINITIONS");
+  if(!config.empty())
+    {
+    props.push_back("COMPILE_DEFINITIONS_" + cmSystemTools::UpperCase(config));
+    }
+
+  // Group the sources by language and properties in the order they are
+  // listed so that the batches stay the same from one run to the next.
+  std::vector<std::string> keys;
+  std::map<std::string, std::vector<cmSourceFile const*> > groups;
+  for(std::vector<cmSourceFile const*>::const_iterator si = sources.begin();
+      si != sources.end(); ++si)
+    {
+    cmSourceFile const* sf = *si;
+    std::string key = sf->GetLanguage();
+    if((key != "C" && key != "CXX") ||
+       sf->GetPropertyAsBool("SKIP_UNITY_BUILD_INCLUSION") ||
+       sf->GetPropertyAsBool("GENERATED") ||
+       sf->GetProperty("OBJECT_DEPENDS") ||
+       sf->GetProperty("OBJECT_OUTPUTS"))
+      {
+      continue;
+      }
+    for(std::vector<std::string>::const_iterator pi = props.begin();
+        pi != props.end(); ++pi)
+      {
+      const char* value = sf->GetProperty(*pi);
+      key += "\n";
+      key += value? value : "";
+      }
+    std::vector<cmSourceFile const*>& group = groups[key];
+    if(group.empty())
+      {
+      keys.push_back(key);
+      }
+    group.push_back(sf);
+    }
+
+  // A batch size of zero puts each group in a single unity source.
+  size_t batchSize = 8;
+  if(const char* value = this->GetProperty("UNITY_BUILD_BATCH_SIZE"))
+    {
+    batchSize = static_cast<size_t>(atoi(value) > 0? atoi(value) : 0);
+    }
+
+  std::string prefix = this->Makefile->GetCurrentOutputDirectory();
+  prefix += "/";
+  prefix += this->GetName();
+  prefix += "_unity_";
+  std::map<cmSourceFile const*, cmSourceFile const*> batched;
+  for(size_t g = 0; g < keys.size(); ++g)
+    {
+    std::vector<cmSourceFile const*> const& group = groups[keys[g]];
+    size_t n = batchSize? batchSize : group.size();
+    for(size_t b = 0; b*n+1 < group.size(); ++b)
+      {
+      std::vector<cmSourceFile const*>::const_iterator first =
+        group.begin() + b*n;
+      std::vector<cmSourceFile const*>::const_iterator last =
+        (group.size() - b*n > n)? first + n : group.end();
+
+      // The unity source includes the sources of the batch.  It is
+      // written by WriteGeneratedFiles.
+      cmOStringStream name;
+      name << prefix << g << "_" << b
+           << ((*first)->GetLanguage() == "C"? ".c" : ".cxx");
+      std::string& content = this->GeneratedFiles[name.str()];
+      content = "/* CMake generated unity source.  DO NOT EDIT! */\n";
+      for(std::vector<cmSourceFile const*>::const_iterator si = first;
+          si != last; ++si)
+        {
+        content += "#include \"" + (*si)->GetFullPath() + "\"\n";
+        }
+
+      cmSourceFile* unity =
+        this->Makefile->GetOrCreateSource(name.str(), true);
+      unity->GetFullPath();
+      for(std::vector<std::string>::const_iterator pi = props.begin();
+          pi != props.end(); ++pi)
+        {
+        if(const char* value = (*first)->GetProperty(*pi))
+          {
+          unity->SetProperty(*pi, value);
+          }
+        }
+      for(std::vector<cmSourceFile const*>::const_iterator si = first;
+          si != last; ++si)
+        {
+        batched[*si] = si == first? unity : 0;
+        }
+      }
+    }
+
+  // Each unity source takes the place of the first source it includes.
+  std::vector<cmSourceFile const*>& result = this->UnitySources[config];
+  for(std::vector<cmSourceFile const*>::const_iterator si = sources.begin();
+      si != sources.end(); ++si)
+    {
+    std::map<cmSourceFile const*, cmSourceFile const*>::const_iterator bi =
+      batched.find(*si);
+    if(bi == batched.end())
+      {
+      result.push_back(*si);
+      }
+    else if(bi->second)
+      {
+      result.push_back(bi->second);
+      }
+    }
+  sources = result;
+}
+
+//----------------------------------------------------------------------------
+void cmGeneratorTarget::WriteGeneratedFiles()
+{
+  for(std::map<std::string, std::string>::const_iterator
+        gi = this->GeneratedFiles.begin();
+      gi != this->GeneratedFiles.end(); ++gi)
+    {
+    // Rewrite the file only if its content changed so that what is
+    // compiled from it is not rebuilt needlessly.
+    std::string dir = cmSystemTools::GetFilenamePath(gi->first);
+    cmSystemTools::MakeDirectory(dir.c_str());
+    cmGeneratedFileStream fout(gi->first.c_str());
+    fout.SetCopyIfDifferent(true);
+    fout << gi->second;
+    }
+}
+
+//----------------------------------------------------------------------------
 void cmGeneratorTarget::ComputeObjectMapping()
 {
   if(!this->Objects.empty())
@@ -1150,3 +1303,150 @@ void cmGeneratorTarget::ConstructSourceFileFlags() const
       }
     }
 }
+
+//----------------------------------------------------------------------------
+std::string cmGeneratorTarget::GetPchHeader(const std::string& lang) const
+{
+  if(lang != "C" && lang != "CXX")
+    {
+    return "";
+    }
+  const char* headers = this->GetProperty("PRECOMPILE_HEADERS");
+  if(!headers || !*headers ||
+     !this->Makefile->GetDefinition("CMAKE_" + lang +
+                                    "_COMPILE_OPTIONS_USE_PCH"))
+    {
+    return "";
+    }
+  std::map<std::string, std::string>::const_iterator
+    hi = this->PchHeaders.find(lang);
+  if(hi != this->PchHeaders.end())
+    {
+    return hi->second;
+    }
+
+  // The header is written by WriteGeneratedFiles.
+  std::string dir = this->Target->GetSupportDirectory();
+  std::string header = dir + (lang == "C"? "/cmake_pch.h" : "/cmake_pch.hxx");
+  std::string& content = this->GeneratedFiles[header];
+  content = "/* CMake generated precompiled header.  DO NOT EDIT! */\n";
+  std::vector<std::string> files;
+  cmSystemTools::ExpandListArgument(headers, files);
+  for(std::vector<std::string>::const_iterator fi = files.begin();
+      fi != files.end(); ++fi)
+    {
+    if(fi->size() > 2 && (*fi)[0] == '<' && (*fi)[fi->size()-1] == '>')
+      {
+      content += "#include " + *fi + "\n";
+      }
+    else
+      {
+      content += "#include \"" +
+        cmSystemTools::CollapseFullPath(
+          fi->c_str(), this->Makefile->GetCurrentDirectory()) + "\"\n";
+      }
+    }
+  this->PchHeaders[lang] = header;
+  return header;
+}
+
+//----------------------------------------------------------------------------
+cmSourceFile* cmGeneratorTarget::GetPchSource(const std::string& lang) const
+{
+  std::string header = this->GetPchHeader(lang);
+  if(header.empty())
+    {
+    return 0;
+    }
+  std::string name = header + (lang == "C"? ".c" : ".cxx");
+  if(cmSourceFile* sf = this->Makefile->GetSource(name))
+    {
+    return sf;
+    }
+  this->GeneratedFiles[name] =
+    "/* CMake generated precompiled header source.  DO NOT EDIT! */\n"
+    "#include \"" + header + "\"\n";
+  cmSourceFile* sf = this->Makefile->GetOrCreateSource(name, true);
+  sf->GetFullPath();
+  return sf;
+}
+
+//----------------------------------------------------------------------------
+bool cmGeneratorTarget::IsPchObjectLinked() const
+{
+  return this->Makefile->IsOn("CMAKE_LINK_PCH");
+}
+
+//----------------------------------------------------------------------------
+std::string cmGeneratorTarget::GetPchFile(const std::string& lang) const
+{
+  std::string header = this->GetPchHeader(lang);
+  if(header.empty())
+    {
+    return "";
+    }
+  const char* ext = this->Makefile->GetSafeDefinition("CMAKE_PCH_EXTENSION");
+  if(this->IsPchObjectLinked())
+    {
+    // The compiler writes the file next to the object.
+    return this->ObjectDirectory +
+      cmSystemTools::GetFilenameName(header) + ext;
+    }
+  // The compiler looks for the file next to the header it includes.
+  return header + ext;
+}
+
+//----------------------------------------------------------------------------
+std::string
+cmGeneratorTarget::GetPchObjectName(const std::string& lang) const
+{
+  std::string header = this->GetPchHeader(lang);
+  if(header.empty())
+    {
+    return "";
+    }
+  std::string name = cmSystemTools::GetFilenameName(header);
+  if(this->IsPchObjectLinked())
+    {
+    name += (lang == "C"? ".c" : ".cxx");
+    name += this->Makefile->GetSafeDefinition("CMAKE_" + lang +
+                                              "_OUTPUT_EXTENSION");
+    }
+  else
+    {
+    name += this->Makefile->GetSafeDefinition("CMAKE_PCH_EXTENSION");
+    }
+  return name;
+}
+
+//----------------------------------------------------------------------------
+std::string
+cmGeneratorTarget::GetPchCompileOptions(const std::string& lang,
+                                        const char* action) const
+{
+  std::string header = this->GetPchHeader(lang);
+  if(header.empty())
+    {
+    return "";
+    }
+  std::string options = this->Makefile->GetSafeDefinition(
+    "CMAKE_" + lang + "_COMPILE_OPTIONS_" + action + "_PCH");
+  cmSystemTools::ReplaceString(options, "<PCH_HEADER>", header.c_str());
+  cmSystemTools::ReplaceString(options, "<PCH_FILE>",
+                               this->GetPchFile(lang).c_str());
+  return options;
+}
+
+//----------------------------------------------------------------------------
+std::string
+cmGeneratorTarget::GetPchCreateCompileOptions(const std::string& lang) const
+{
+  return this->GetPchCompileOptions(lang, "CREATE");
+}
+
+//----------------------------------------------------------------------------
+std::string
+cmGeneratorTarget::GetPchUseCompileOptions(const std::string& lang) const
+{
+  return this->GetPchCompileOptions(lang, "USE");
+}
@@ -57,6 +57,10 @@ public:
 
   void ComputeObjectMapping();
 
+  /** Write the unity sources and precompiled header files computed
+      for the UNITY_BUILD and PRECOMPILE_HEADERS properties.  */
+  void WriteGeneratedFiles();
+
   cmTarget* Target;
   cmMakefile* Makefile;
   cmLocalGenerator* LocalGenerator;
@@ -124,6 +128,29 @@ public:
   struct SourceFileFlags
   GetTargetSourceFileFlags(const cmSourceFile* sf) const;
 
+  /** Get the generated header including the PRECOMPILE_HEADERS of the
+      target for the given language.  Returns an empty string if the
+      target does not precompile headers for the language.  */
+  std::string GetPchHeader(const std::string& lang) const;
+
+  /** Get the generated source compiled to create the precompiled
+      header.  It includes only the header.  */
+  cmSourceFile* GetPchSource(const std::string& lang) const;
+
+  /** Get the full path to the precompiled header file and the name,
+      relative to the object directory, of the file produced by
+      compiling the precompiled header source.  */
+  std::string GetPchFile(const std::string& lang) const;
+  std::string GetPchObjectName(const std::string& lang) const;
+
+  /** Whether the object of the precompiled header source is linked.  */
+  bool IsPchObjectLinked() const;
+
+  /** Get the list of options to create or to use the precompiled
+      header when compiling a source of the given language.  */
+  std::string GetPchCreateCompileOptions(const std::string& lang) const;
+  std::string GetPchUseCompileOptions(const std::string& lang) const;
+
   struct ResxData {
     mutable std::set<std::string> ExpectedResxHeaders;
     mutable std::vector<cmSourceFile const*> ResxSources;
@@ -135,6 +162,17 @@ private:
   SourceEntriesType SourceEntries;
 
   mutable std::map<cmSourceFile const*, std::string> Objects;
+
+  // Replace the object sources that can be compiled together with
+  // generated unity sources including them.
+  void AddUnitySources(std::vector<cmSourceFile const*>& sources,
+                       const std::string& config) const;
+  mutable std::map<std::string, std::vector<cmSourceFile const*> >
+    UnitySources;
+  mutable std::map<std::string, std::string> GeneratedFiles;
+  mutable std::map<std::string, std::string> PchHeaders;
+  std::string GetPchCompileOptions(const std::string& lang,
+                                   const char* action) const;
   std::set<cmSourceFile const*> ExplicitObjectName;
   mutable std::map<std::string, std::vector<std::string> > SystemIncludesCache;
 
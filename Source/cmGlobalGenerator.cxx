@@ -1269,6 +1269,13 @@ void cmGlobalGenerator::Generate()
     }
   this->SetCurrentLocalGenerator(0);
 
+  // Write the files computed while generating the targets.
+  for(cmGeneratorTargetsType::iterator ti = this->GeneratorTargets.begin();
+      ti != this->GeneratorTargets.end(); ++ti)
+    {
+    ti->second->WriteGeneratedFiles();
+    }
+
   for (std::map<std::string, cmExportBuildFileGenerator*>::iterator
       it = this->BuildExportSets.begin(); it != this->BuildExportSets.end();
       ++it)
@@ -298,6 +298,10 @@ public:
       i.e. "Can I build Debug and Release in the same tree?" */
   virtual bool IsMultiConfig() { return false; }
 
+  /** Return true if the generator compiles the sources of targets with
+      the UNITY_BUILD property in batches.  */
+  virtual bool SupportsUnityBuilds() const { return false; }
+
   std::string GetSharedLibFlagsForLanguage(std::string const& lang) const;
 
   /** Generate an <output>.rule file path for a given command output.  */
@@ -300,6 +300,8 @@ public:
   void AddTargetAlias(const std::string& alias, cmTarget* target);
 
   virtual void ComputeTargetObjectDirectory(cmGeneratorTarget* gt) const;
+
+  virtual bool SupportsUnityBuilds() const { return true; }
 protected:
 
   /// Overloaded methods.
@@ -25,6 +25,8 @@ cmGlobalUnixMakefileGenerator3::cmGlobalUnixMakefileGenerator3()
   this->ForceUnixPaths = true;
   this->FindMakeProgramFile = "CMakeUnixFindMake.cmake";
   this->ToolSupportsColor = true;
+  this->ToolSupportsNonRecursive = true;
+  this->NonRecursive = false;
 
 #if defined(_WIN32) || defined(__VMS)
   this->UseLinkScript = false;
@@ -129,6 +131,12 @@ void cmGlobalUnixMakefileGenerator3::Configure()
 
 void cmGlobalUnixMakefileGenerator3::Generate()
 {
+  // Decide on the makefile layout before any rule files are written.
+  this->NonRecursive = (this->ToolSupportsNonRecursive &&
+                        !this->LocalGenerators.empty() &&
+                        this->LocalGenerators[0]->GetMakefile()
+                        ->IsOn("CMAKE_NON_RECURSIVE_MAKEFILES"));
+
   // first do superclass method
   this->cmGlobalGenerator::Generate();
 
@@ -261,6 +269,14 @@ void cmGlobalUnixMakefileGenerator3::WriteMainMakefile2()
   // Write out the "special" stuff
   lg->WriteSpecialTargetsTop(makefileStream);
 
+  // Scan the dependencies of all targets in one process.  Make
+  // restarts after updating an included file so the scan results are
+  // seen before anything is built.
+  if(this->NonRecursive)
+    {
+    this->WriteDependAllRule(makefileStream, lg);
+    }
+
   // write the target convenience rules
   unsigned int i;
   for (i = 0; i < this->LocalGenerators.size(); ++i)
@@ -275,6 +291,62 @@ void cmGlobalUnixMakefileGenerator3::WriteMainMakefile2()
 }
 
 
+//----------------------------------------------------------------------------
+void
+cmGlobalUnixMakefileGenerator3
+::WriteDependAllRule(std::ostream& ruleFileStream,
+                     cmLocalUnixMakefileGenerator3* lg)
+{
+  cmMakefile* mf = lg->GetMakefile();
+  std::string stampFile = cmake::GetCMakeFilesDirectoryPostSlash();
+  stampFile += "depend_all.make";
+  const char* root = (mf->IsOn("CMAKE_MAKE_INCLUDE_FROM_ROOT")?
+                      "$(CMAKE_BINARY_DIR)/" : "");
+  ruleFileStream
+    << "# Include the result of scanning dependencies of all targets.\n"
+    << lg->GetIncludeDirective() << " " << root << stampFile << "\n\n";
+
+  // Generate a call this signature:
+  //
+  //   cmake -E cmake_depends_all <generator>
+  //                              <home-src-dir> <home-out-dir>
+  //                              --color=$(COLOR)
+  //
+  // The scanner reads the list of targets from Makefile.cmake.
+  cmOStringStream depCmd;
+#if !defined(_WIN32) || defined(__CYGWIN__)
+  // Help cmSystemTools to create the same symlink translation table
+  // as the generator.  See cmMakefileTargetGenerator.
+  depCmd << "cd "
+         << lg->Convert(mf->GetHomeOutputDirectory(),
+                        cmLocalGenerator::FULL, cmLocalGenerator::SHELL)
+         << " && ";
+#endif
+  depCmd << "$(CMAKE_COMMAND) -E cmake_depends_all \""
+         << this->GetName() << "\" "
+         << lg->Convert(mf->GetHomeDirectory(),
+                        cmLocalGenerator::FULL, cmLocalGenerator::SHELL)
+         << " "
+         << lg->Convert(mf->GetHomeOutputDirectory(),
+                        cmLocalGenerator::FULL, cmLocalGenerator::SHELL);
+  if(lg->GetColorMakefile())
+    {
+    depCmd << " --color=$(COLOR)";
+    }
+  std::vector<std::string> commands;
+  commands.push_back(depCmd.str());
+  std::vector<std::string> depends;
+  depends.push_back("cmake_force");
+
+  // The scan has just been done when make restarts after it so do not
+  // run it again.
+  ruleFileStream << "ifndef MAKE_RESTARTS\n";
+  lg->WriteMakeRule(ruleFileStream,
+                    "Scan the dependencies of all targets.",
+                    stampFile, depends, commands, false);
+  ruleFileStream << "endif\n\n";
+}
+
 //----------------------------------------------------------------------------
 void cmGlobalUnixMakefileGenerator3::WriteMainCMakefile()
 {
@@ -653,12 +725,19 @@ cmGlobalUnixMakefileGenerator3
           << "# Target rules for targets named "
           << name << "\n\n";
 
-        // Write the rule.
+        // Write the rule.  The non-recursive Makefile2 has no rule
+        // with the plain target name.
         commands.clear();
         std::string tmp = cmake::GetCMakeFilesDirectoryPostSlash();
         tmp += "Makefile2";
+        std::string makeTargetName = name;
+        if(this->NonRecursive && !this->NeedRequiresStep(*gtarget->Target))
+          {
+          makeTargetName = lg->GetRelativeTargetDirectory(*gtarget->Target);
+          makeTargetName += "/rule";
+          }
         commands.push_back(lg->GetRecursiveMakeCall
-                            (tmp.c_str(),name));
+                            (tmp.c_str(),makeTargetName));
         depends.clear();
         depends.push_back("cmake_check_build_system");
         lg->WriteMakeRule(ruleFileStream,
@@ -674,7 +753,7 @@ cmGlobalUnixMakefileGenerator3
         makefileName += "/build.make";
         depends.clear();
         commands.clear();
-        std::string makeTargetName = localName;
+        makeTargetName = localName;
         makeTargetName += "/build";
         localName = name;
         localName += "/fast";
@@ -751,59 +830,93 @@ cmGlobalUnixMakefileGenerator3
 
       bool needRequiresStep = this->NeedRequiresStep(*gtarget->Target);
 
+      // The provides-requires mode needs recursive make calls so such
+      // targets keep their own makefile even in the non-recursive layout.
+      bool nonRecursive = this->NonRecursive && !needRequiresStep;
+
       lg->WriteDivider(ruleFileStream);
       ruleFileStream
         << "# Target rules for target "
         << localName << "\n\n";
 
       commands.clear();
-      makeTargetName = localName;
-      makeTargetName += "/depend";
-      commands.push_back(lg->GetRecursiveMakeCall
-                         (makefileName.c_str(),makeTargetName));
-
-      // add requires if we need it for this generator
-      if (needRequiresStep)
+      depends.clear();
+      if(nonRecursive)
+        {
+        // Read the target's rules into this makefile.
+        const char* root =
+          (lg->GetMakefile()->IsOn("CMAKE_MAKE_INCLUDE_FROM_ROOT")?
+           "$(CMAKE_BINARY_DIR)/" : "");
+        ruleFileStream
+          << lg->GetIncludeDirective() << " " << root
+          << lg->Convert(makefileName, cmLocalGenerator::HOME_OUTPUT,
+                         cmLocalGenerator::MAKEFILE)
+          << "\n\n";
+        }
+      else
         {
         makeTargetName = localName;
-        makeTargetName += "/requires";
+        makeTargetName += "/depend";
+        commands.push_back(lg->GetRecursiveMakeCall
+                           (makefileName.c_str(),makeTargetName));
+
+        // add requires if we need it for this generator
+        if (needRequiresStep)
+          {
+          makeTargetName = localName;
+          makeTargetName += "/requires";
+          commands.push_back(lg->GetRecursiveMakeCall
+                            (makefileName.c_str(),makeTargetName));
+          }
+        makeTargetName = localName;
+        makeTargetName += "/build";
         commands.push_back(lg->GetRecursiveMakeCall
-                          (makefileName.c_str(),makeTargetName));
+                           (makefileName.c_str(),makeTargetName));
         }
-      makeTargetName = localName;
-      makeTargetName += "/build";
-      commands.push_back(lg->GetRecursiveMakeCall
-                         (makefileName.c_str(),makeTargetName));
 
       // Write the rule.
       localName += "/all";
-      depends.clear();
 
-      std::string progressDir =
-        lg->GetMakefile()->GetHomeOutputDirectory();
-      progressDir += cmake::GetCMakeFilesDirectory();
+      cmLocalUnixMakefileGenerator3::EchoProgress progress;
+      progress.Dir = lg->GetMakefile()->GetHomeOutputDirectory();
+      progress.Dir += cmake::GetCMakeFilesDirectory();
         {
-        cmOStringStream progCmd;
-        progCmd << "$(CMAKE_COMMAND) -E cmake_progress_report ";
         // all target counts
-        progCmd << lg->Convert(progressDir,
-                                cmLocalGenerator::FULL,
-                                cmLocalGenerator::SHELL);
-        progCmd << " ";
+        const char* sep = "";
         std::vector<unsigned long>& progFiles =
           this->ProgressMap[gtarget->Target].Marks;
         for (std::vector<unsigned long>::iterator i = progFiles.begin();
               i != progFiles.end(); ++i)
           {
-          progCmd << " " << *i;
+          cmOStringStream mark;
+          mark << sep << *i;
+          progress.Arg += mark.str();
+          sep = ",";
           }
-        commands.push_back(progCmd.str());
         }
-      progressDir = "Built target ";
-      progressDir += name;
-      lg->AppendEcho(commands,progressDir.c_str());
+      // A non-recursive build runs no recipe for up-to-date targets so
+      // that a no-op build spawns no processes.  The rule that starts
+      // the build reports the progress of such targets when it is done.
+      if(!nonRecursive)
+        {
+        std::string echo = "Built target ";
+        echo += name;
+        lg->AppendEcho(commands, echo.c_str(),
+                       cmLocalUnixMakefileGenerator3::EchoNormal, &progress);
+        }
 
       this->AppendGlobalTargetDepends(depends,*gtarget->Target);
+      if(nonRecursive)
+        {
+        std::string targetDir =
+          lg->GetRelativeTargetDirectory(*gtarget->Target);
+        if(this->WriteNonRecursiveTargetRules(ruleFileStream, lg,
+                                              *gtarget->Target, depends))
+          {
+          depends.push_back(targetDir + "/depend.internal");
+          }
+        depends.push_back(targetDir + "/build");
+        }
       lg->WriteMakeRule(ruleFileStream, "All Build rule for target.",
                         localName, depends, commands, true);
 
@@ -819,8 +932,7 @@ cmGlobalUnixMakefileGenerator3
 
       // Write the rule.
       commands.clear();
-      progressDir = lg->GetMakefile()->GetHomeOutputDirectory();
-      progressDir += cmake::GetCMakeFilesDirectory();
+      std::string progressDir = progress.Dir;
 
       {
       // TODO: Convert the total progress count to a make variable.
@@ -840,6 +952,18 @@ cmGlobalUnixMakefileGenerator3
       tmp += "Makefile2";
       commands.push_back(lg->GetRecursiveMakeCall
                           (tmp.c_str(),localName));
+      if(nonRecursive)
+        {
+        // Up-to-date targets reported no progress so report it here.
+        cmLocalUnixMakefileGenerator3::EchoProgress doneProgress;
+        doneProgress.Dir = progressDir;
+        doneProgress.Arg = "all";
+        std::string echo = "Built target ";
+        echo += name;
+        lg->AppendEcho(commands, echo.c_str(),
+                       cmLocalUnixMakefileGenerator3::EchoNormal,
+                       &doneProgress);
+        }
       {
       cmOStringStream progCmd;
       progCmd << "$(CMAKE_COMMAND) -E cmake_progress_start "; // # 0
@@ -858,11 +982,16 @@ cmGlobalUnixMakefileGenerator3
                         localName, depends, commands, true);
 
       // Add a target with the canonical name (no prefix, suffix or path).
-      commands.clear();
-      depends.clear();
-      depends.push_back(localName);
-      lg->WriteMakeRule(ruleFileStream, "Convenience name for target.",
-                        name, depends, commands, true);
+      // The included rules may already use the name for a file or a
+      // utility rule so the non-recursive layout cannot have it.
+      if(!nonRecursive)
+        {
+        commands.clear();
+        depends.clear();
+        depends.push_back(localName);
+        lg->WriteMakeRule(ruleFileStream, "Convenience name for target.",
+                          name, depends, commands, true);
+        }
 
       // Add rules to prepare the target for installation.
       if(gtarget->Target
@@ -870,13 +999,16 @@ cmGlobalUnixMakefileGenerator3
         {
         localName = lg->GetRelativeTargetDirectory(*gtarget->Target);
         localName += "/preinstall";
-        depends.clear();
-        commands.clear();
-        commands.push_back(lg->GetRecursiveMakeCall
-                            (makefileName.c_str(), localName));
-        lg->WriteMakeRule(ruleFileStream,
-                          "Pre-install relink rule for target.",
-                          localName, depends, commands, true);
+        if(!nonRecursive)
+          {
+          depends.clear();
+          commands.clear();
+          commands.push_back(lg->GetRecursiveMakeCall
+                              (makefileName.c_str(), localName));
+          lg->WriteMakeRule(ruleFileStream,
+                            "Pre-install relink rule for target.",
+                            localName, depends, commands, true);
+          }
 
         if(!this->IsExcluded(this->LocalGenerators[0], *gtarget->Target))
           {
@@ -894,11 +1026,14 @@ cmGlobalUnixMakefileGenerator3
       makeTargetName += "/clean";
       depends.clear();
       commands.clear();
-      commands.push_back(lg->GetRecursiveMakeCall
-                          (makefileName.c_str(), makeTargetName));
-      lg->WriteMakeRule(ruleFileStream, "clean rule for target.",
-                        makeTargetName, depends, commands, true);
-      commands.clear();
+      if(!nonRecursive)
+        {
+        commands.push_back(lg->GetRecursiveMakeCall
+                            (makefileName.c_str(), makeTargetName));
+        lg->WriteMakeRule(ruleFileStream, "clean rule for target.",
+                          makeTargetName, depends, commands, true);
+        commands.clear();
+        }
       depends.push_back(makeTargetName);
       lg->WriteMakeRule(ruleFileStream, "clean rule for target.",
                         "clean", depends, commands, true);
@@ -955,6 +1090,15 @@ cmGlobalUnixMakefileGenerator3::RecordTargetProgress(
   TargetProgress& tp = this->ProgressMap[tg->GetTarget()];
   tp.NumberOfActions = tg->GetNumberOfProgressActions();
   tp.VariableFile = tg->GetProgressFileNameFull();
+  tp.VariablePrefix = tg->GetVariablePrefix();
+
+  if(this->NonRecursive)
+    {
+    TargetFiles& tf = this->TargetFilesMap[tg->GetTarget()];
+    tf.Objects = tg->GetObjectRuleNames();
+    tf.Generated = tg->GetGeneratedFiles();
+    tf.Driven = tg->GetDrivenFiles();
+    }
 }
 
 //----------------------------------------------------------------------------
@@ -965,7 +1109,7 @@ cmGlobalUnixMakefileGenerator3::TargetProgress
   cmGeneratedFileStream fout(this->VariableFile.c_str());
   for(unsigned long i = 1; i <= this->NumberOfActions; ++i)
     {
-    fout << "CMAKE_PROGRESS_" << i << " = ";
+    fout << this->VariablePrefix << "CMAKE_PROGRESS_" << i << " = ";
     if (total <= 100)
       {
       unsigned long num = i + current;
@@ -1009,6 +1153,123 @@ cmGlobalUnixMakefileGenerator3
     }
 }
 
+//----------------------------------------------------------------------------
+bool
+cmGlobalUnixMakefileGenerator3
+::WriteNonRecursiveTargetRules(std::ostream& ruleFileStream,
+                               cmLocalUnixMakefileGenerator3* lg,
+                               cmTarget& target,
+                               std::vector<std::string> const& depends)
+{
+  TargetFiles const& tf = this->TargetFilesMap[&target];
+
+  // Recursive make builds a target only after the targets it depends
+  // on.  Keep that order with order-only prerequisites so that make
+  // may still see the whole build graph.  Files also generated by the
+  // targets depended on are built by them and must not wait for them.
+  std::set<std::string> skip;
+  {
+  std::vector<std::string> dependGenerated;
+  std::set<cmTarget const*> emitted;
+  emitted.insert(&target);
+  TargetDependSet const& depends_set = this->GetTargetDirectDepends(target);
+  for(TargetDependSet::const_iterator i = depends_set.begin();
+      i != depends_set.end(); ++i)
+    {
+    this->AppendGeneratedFiles(dependGenerated, *i, emitted);
+    }
+  skip.insert(dependGenerated.begin(), dependGenerated.end());
+  }
+  std::vector<std::string> files;
+  std::vector<std::string> ownFiles = tf.Objects;
+  ownFiles.insert(ownFiles.end(), tf.Generated.begin(), tf.Generated.end());
+  ownFiles.insert(ownFiles.end(), tf.Driven.begin(), tf.Driven.end());
+  for(std::vector<std::string>::const_iterator fi = ownFiles.begin();
+      fi != ownFiles.end(); ++fi)
+    {
+    if(skip.insert(*fi).second)
+      {
+      files.push_back(*fi);
+      }
+    }
+  if(!files.empty() && !depends.empty())
+    {
+    lg->WriteOrderOnlyRule(ruleFileStream,
+                           "Build the files of this target after its "
+                           "dependencies.", files, depends);
+    }
+
+  // Object files may include headers generated by this target.
+  if(!tf.Objects.empty() && !tf.Generated.empty())
+    {
+    lg->WriteOrderOnlyRule(ruleFileStream,
+                           "Build the object files after the generated "
+                           "files.", tf.Objects, tf.Generated);
+    }
+
+  // Dependencies of all targets are scanned before the build starts so
+  // files generated during the build are not seen by the scan.  Drop
+  // the scan results when such a file changes so that the next build
+  // scans the target again.
+  std::vector<std::string> generated;
+  {
+  std::vector<std::string> allGenerated;
+  std::set<cmTarget const*> emitted;
+  this->AppendGeneratedFiles(allGenerated, &target, emitted);
+  std::set<std::string> unique;
+  for(std::vector<std::string>::const_iterator gi = allGenerated.begin();
+      gi != allGenerated.end(); ++gi)
+    {
+    if(unique.insert(*gi).second)
+      {
+      generated.push_back(*gi);
+      }
+    }
+  }
+  if(generated.empty())
+    {
+    return false;
+    }
+  std::string internalDependFile =
+    lg->GetRelativeTargetDirectory(target);
+  internalDependFile += "/depend.internal";
+  std::vector<std::string> commands;
+  std::string removeCommand = "$(CMAKE_COMMAND) -E remove -f ";
+  removeCommand += lg->Convert(internalDependFile,
+                               cmLocalGenerator::HOME_OUTPUT,
+                               cmLocalGenerator::SHELL);
+  commands.push_back(removeCommand);
+  lg->WriteMakeRule(ruleFileStream,
+                    "Rescan dependencies when generated files change.",
+                    internalDependFile, generated, commands, false);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void
+cmGlobalUnixMakefileGenerator3
+::AppendGeneratedFiles(std::vector<std::string>& files,
+                       cmTarget const* target,
+                       std::set<cmTarget const*>& emitted)
+{
+  if(!emitted.insert(target).second)
+    {
+    return;
+    }
+  TargetFilesMapType::const_iterator tfi = this->TargetFilesMap.find(target);
+  if(tfi != this->TargetFilesMap.end())
+    {
+    files.insert(files.end(), tfi->second.Generated.begin(),
+                 tfi->second.Generated.end());
+    }
+  TargetDependSet const& depends = this->GetTargetDirectDepends(*target);
+  for(TargetDependSet::const_iterator i = depends.begin();
+      i != depends.end(); ++i)
+    {
+    this->AppendGeneratedFiles(files, *i, emitted);
+    }
+}
+
 //----------------------------------------------------------------------------
 void cmGlobalUnixMakefileGenerator3::WriteHelpRule
 (std::ostream& ruleFileStream, cmLocalUnixMakefileGenerator3 *lg)
@@ -49,6 +49,11 @@ class cmLocalUnixMakefileGenerator3;
 
  Rules for custom commands follow the same model as rules for source files.
 
+ When CMAKE_NON_RECURSIVE_MAKEFILES is enabled and the make tool is GNU
+ make, Makefile2 instead includes every target's build.make and drives
+ the targets without recursive make invocations.  Dependencies of all
+ targets are scanned by a single process before the build starts.
+
  */
 
 class cmGlobalUnixMakefileGenerator3 : public cmGlobalGenerator
@@ -121,6 +126,15 @@ public:
   /** Record per-target progress information.  */
   void RecordTargetProgress(cmMakefileTargetGenerator* tg);
 
+  /** Whether Makefile2 includes all target rules directly instead of
+      invoking make recursively for each target.  */
+  bool GetNonRecursive() const { return this->NonRecursive; }
+
+  /** Record that the rule for a custom command output has been written.
+      Returns false if another target already wrote it.  */
+  bool AddCustomCommandOutput(const std::string& output)
+    { return this->CustomCommandOutputs.insert(output).second; }
+
   void AddCXXCompileCommand(const std::string &sourceFile,
                             const std::string &workingDirectory,
                             const std::string &compileCommand);
@@ -128,10 +142,14 @@ public:
   /** Does the make tool tolerate .NOTPARALLEL? */
   virtual bool AllowNotParallel() const { return true; }
 
+  virtual bool SupportsUnityBuilds() const { return true; }
+
   virtual void ComputeTargetObjectDirectory(cmGeneratorTarget* gt) const;
 protected:
   void WriteMainMakefile2();
   void WriteMainCMakefile();
+  void WriteDependAllRule(std::ostream& ruleFileStream,
+                          cmLocalUnixMakefileGenerator3* lg);
 
   void WriteConvenienceRules2(std::ostream& ruleFileStream,
                               cmLocalUnixMakefileGenerator3*);
@@ -146,6 +164,14 @@ protected:
   void AppendGlobalTargetDepends(std::vector<std::string>& depends,
                                  cmTarget& target);
 
+  bool WriteNonRecursiveTargetRules(std::ostream& ruleFileStream,
+                                    cmLocalUnixMakefileGenerator3* lg,
+                                    cmTarget& target,
+                                    std::vector<std::string> const& depends);
+  void AppendGeneratedFiles(std::vector<std::string>& files,
+                            cmTarget const* target,
+                            std::set<cmTarget const*>& emitted);
+
   // does this generator need a requires step for any of its targets
   bool NeedRequiresStep(cmTarget const&);
 
@@ -176,12 +202,18 @@ protected:
   // in the rule to satisfy the make program.
   std::string EmptyRuleHackCommand;
 
+  // Whether the make tool supports the GNU make features needed by
+  // the non-recursive layout, and whether the project enabled it.
+  bool ToolSupportsNonRecursive;
+  bool NonRecursive;
+
   // Store per-target progress counters.
   struct TargetProgress
   {
     TargetProgress(): NumberOfActions(0) {}
     unsigned long NumberOfActions;
     std::string VariableFile;
+    std::string VariablePrefix;
     std::vector<unsigned long> Marks;
     void WriteProgressVariables(unsigned long total, unsigned long& current);
   };
@@ -189,6 +221,21 @@ protected:
                    cmStrictTargetComparison> ProgressMapType;
   ProgressMapType ProgressMap;
 
+  // Store the files built by each target for the non-recursive layout.
+  struct TargetFiles
+  {
+    std::vector<std::string> Objects;
+    std::vector<std::string> Generated;
+    std::vector<std::string> Driven;
+  };
+  typedef std::map<cmTarget const*, TargetFiles,
+                   cmStrictTargetComparison> TargetFilesMapType;
+  TargetFilesMapType TargetFilesMap;
+
+  // Custom command outputs whose rule has been written.  All rules
+  // share one makefile in the non-recursive layout.
+  std::set<std::string> CustomCommandOutputs;
+
   size_t CountProgressMarksInTarget(cmTarget const* target,
                                     std::set<cmTarget const*>& emitted);
   size_t CountProgressMarksInAll(cmLocalUnixMakefileGenerator3* lg);
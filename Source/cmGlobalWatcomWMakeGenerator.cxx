@@ -20,6 +20,7 @@ cmGlobalWatcomWMakeGenerator::cmGlobalWatcomWMakeGenerator()
   this->ForceUnixPaths = false;
 #endif
   this->ToolSupportsColor = true;
+  this->ToolSupportsNonRecursive = false;
   this->NeedSymbolicMark = true;
   this->EmptyRuleHackCommand = "@cd .";
 }
@@ -313,6 +313,7 @@ void cmInstallTargetGenerator::GenerateScriptForConfig(std::ostream& os,
                        indent);
 
   // Add post-installation tweaks.
+  this->AddChrpathPatchRules(os, indent, config, filesTo);
   this->AddTweak(os, indent, config, filesTo,
                  &cmInstallTargetGenerator::PostReplacementTweaks);
 }
@@ -661,6 +662,8 @@ cmInstallTargetGenerator
     return;
     }
 
+  // The file(RPATH_*) rules are written for all the files of the
+  // target at once by AddChrpathPatchRules.
   if(this->Target->GetMakefile()->IsOn("CMAKE_PLATFORM_HAS_INSTALLNAME"))
     {
     // If using install_name_tool, set up the rules to modify the rpaths.
@@ -704,34 +707,85 @@ cmInstallTargetGenerator
         }
       }
     }
-  else
+}
+
+//----------------------------------------------------------------------------
+void
+cmInstallTargetGenerator
+::AddChrpathPatchRules(std::ostream& os, Indent const& indent,
+                       const std::string& config,
+                       std::vector<std::string> const& files)
+{
+  // Skip the chrpath if the target does not need it.  The
+  // install_name_tool rules are written per file by AddChrpathPatchRule.
+  if(this->ImportLibrary || !this->Target->IsChrpathUsed(config) ||
+     this->Target->GetMakefile()->IsOn("CMAKE_PLATFORM_HAS_INSTALLNAME"))
     {
-    // Construct the original rpath string to be replaced.
-    std::string oldRpath = cli->GetRPathString(false);
+    return;
+    }
 
-    // Get the install RPATH from the link information.
-    std::string newRpath = cli->GetChrpathString();
+  // Get the link information for this target.
+  // It can provide the RPATH.
+  cmComputeLinkInformation* cli = this->Target->GetLinkInformation(config);
+  if(!cli)
+    {
+    return;
+    }
 
-    // Skip the rule if the paths are identical
-    if(oldRpath == newRpath)
-      {
-      return;
-      }
+  // Construct the original rpath string to be replaced.
+  std::string oldRpath = cli->GetRPathString(false);
 
-    // Write a rule to run chrpath to set the install-tree RPATH
-    if(newRpath.empty())
-      {
-      os << indent << "file(RPATH_REMOVE\n"
-         << indent << "     FILE \"" << toDestDirPath << "\")\n";
-      }
-    else
+  // Get the install RPATH from the link information.
+  std::string newRpath = cli->GetChrpathString();
+
+  // Skip the rule if the paths are identical
+  if(oldRpath == newRpath)
+    {
+    return;
+    }
+
+  // Write a rule to run chrpath to set the install-tree RPATH.  The
+  // files that are not symlinks are collected so that all of them are
+  // rewritten by a single command.
+  std::string fileArg;
+  Indent indent2 = indent.Next();
+  if(files.size() == 1)
+    {
+    fileArg = "\"" + this->GetDestDirPath(files[0]) + "\"";
+    os << indent << "if(EXISTS " << fileArg << " AND\n"
+       << indent << "   NOT IS_SYMLINK " << fileArg << ")\n";
+    }
+  else
+    {
+    fileArg = "${files}";
+    os << indent << "set(files)\n";
+    os << indent << "foreach(file\n";
+    for(std::vector<std::string>::const_iterator i = files.begin();
+        i != files.end(); ++i)
       {
-      os << indent << "file(RPATH_CHANGE\n"
-         << indent << "     FILE \"" << toDestDirPath << "\"\n"
-         << indent << "     OLD_RPATH \"" << oldRpath << "\"\n"
-         << indent << "     NEW_RPATH \"" << newRpath << "\")\n";
+      os << indent2.Next() << "\"" << this->GetDestDirPath(*i) << "\"\n";
       }
+    os << indent2.Next() << ")\n";
+    os << indent2 << "if(EXISTS \"${file}\" AND\n"
+       << indent2 << "   NOT IS_SYMLINK \"${file}\")\n";
+    os << indent2.Next() << "list(APPEND files \"${file}\")\n";
+    os << indent2 << "endif()\n";
+    os << indent << "endforeach()\n";
+    os << indent << "if(files)\n";
+    }
+  if(newRpath.empty())
+    {
+    os << indent2 << "file(RPATH_REMOVE\n"
+       << indent2 << "     FILE " << fileArg << ")\n";
     }
+  else
+    {
+    os << indent2 << "file(RPATH_CHANGE\n"
+       << indent2 << "     FILE " << fileArg << "\n"
+       << indent2 << "     OLD_RPATH \"" << oldRpath << "\"\n"
+       << indent2 << "     NEW_RPATH \"" << newRpath << "\")\n";
+    }
+  os << indent << "endif()\n";
 }
 
 //----------------------------------------------------------------------------
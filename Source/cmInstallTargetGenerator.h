@@ -88,6 +88,9 @@ protected:
   void AddChrpathPatchRule(std::ostream& os, Indent const& indent,
                            const std::string& config,
                            std::string const& toDestDirPath);
+  void AddChrpathPatchRules(std::ostream& os, Indent const& indent,
+                            const std::string& config,
+                            std::vector<std::string> const& files);
   void AddRPathCheckRule(std::ostream& os, Indent const& indent,
                          const std::string& config,
                          std::string const& toDestDirPath);
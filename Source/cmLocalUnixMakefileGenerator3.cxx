@@ -24,6 +24,7 @@
 // Include dependency scanners for supported languages.  Only the
 // C/C++ scanner is needed for bootstrapping CMake.
 #include "cmDependsC.h"
+#include "cmDependsCompiler.h"
 #ifdef CMAKE_BUILD_WITH_CMAKE
 # include "cmDependsFortran.h"
 # include "cmDependsJava.h"
@@ -687,6 +688,34 @@ cmLocalUnixMakefileGenerator3
     }
 }
 
+//----------------------------------------------------------------------------
+void
+cmLocalUnixMakefileGenerator3
+::WriteOrderOnlyRule(std::ostream& os,
+                     const char* comment,
+                     const std::vector<std::string>& targets,
+                     const std::vector<std::string>& depends)
+{
+  if(comment)
+    {
+    os << "# " << comment << "\n";
+    }
+  const char* sep = "";
+  for(std::vector<std::string>::const_iterator t = targets.begin();
+      t != targets.end(); ++t)
+    {
+    os << sep << cmMakeSafe(this->Convert(*t,HOME_OUTPUT,MAKEFILE));
+    sep = " \\\n";
+    }
+  os << ": |";
+  for(std::vector<std::string>::const_iterator d = depends.begin();
+      d != depends.end(); ++d)
+    {
+    os << " \\\n  " << cmMakeSafe(this->Convert(*d,HOME_OUTPUT,MAKEFILE));
+    }
+  os << "\n\n";
+}
+
 //----------------------------------------------------------------------------
 std::string
 cmLocalUnixMakefileGenerator3
@@ -1284,7 +1313,8 @@ cmLocalUnixMakefileGenerator3
 void
 cmLocalUnixMakefileGenerator3::AppendEcho(std::vector<std::string>& commands,
                                           const char* text,
-                                          EchoColor color)
+                                          EchoColor color,
+                                          EchoProgress const* progress)
 {
   // Choose the color for the text.
   std::string color_name;
@@ -1316,6 +1346,18 @@ cmLocalUnixMakefileGenerator3::AppendEcho(std::vector<std::string>& commands,
     }
 #else
   (void)color;
+  // The bootstrap cmake cannot echo, so report progress separately.
+  if(progress)
+    {
+    std::string cmd = "$(CMAKE_COMMAND) -E cmake_progress_report ";
+    cmd += this->Convert(progress->Dir,
+                         cmLocalGenerator::FULL,
+                         cmLocalGenerator::SHELL);
+    cmd += " ";
+    cmd += progress->Arg;
+    commands.push_back(cmd);
+    progress = 0;
+    }
 #endif
 
   // Echo one line at a time.
@@ -1330,7 +1372,7 @@ cmLocalUnixMakefileGenerator3::AppendEcho(std::vector<std::string>& commands,
         {
         // Add a command to echo this line.
         std::string cmd;
-        if(color_name.empty())
+        if(color_name.empty() && !progress)
           {
           // Use the native echo command.
           cmd = "@echo ";
@@ -1341,6 +1383,19 @@ cmLocalUnixMakefileGenerator3::AppendEcho(std::vector<std::string>& commands,
           // Use cmake to echo the text in color.
           cmd = "@$(CMAKE_COMMAND) -E cmake_echo_color --switch=$(COLOR) ";
           cmd += color_name;
+          if(progress)
+            {
+            // The same process reports the build progress.
+            cmd += "--progress-dir=";
+            cmd += this->Convert(progress->Dir,
+                                 cmLocalGenerator::FULL,
+                                 cmLocalGenerator::SHELL);
+            cmd += " ";
+            cmd += "--progress-num=";
+            cmd += progress->Arg;
+            cmd += " ";
+            progress = 0;
+            }
           cmd += this->EscapeForShell(line);
           }
         commands.push_back(cmd);
@@ -1542,9 +1597,30 @@ bool cmLocalUnixMakefileGenerator3::UpdateDependencies(const char* tgtInfo,
     // dependency vector. This means that in the normal case, when only
     // few or one file have been edited, then also only this one file is
     // actually scanned again, instead of all files for this target.
-    needRescanDependencies = !checker.Check(dependFile.c_str(),
-                                            internalDependFile.c_str(),
-                                            validDependencies);
+    // The record of the last successful check answers the common case
+    // of nothing having changed without walking the whole dependency
+    // list.  It is not used when the dependencies may be rescanned
+    // because the rescan needs the valid dependencies.
+    if(needRescanDependInfo ||
+       !checker.CheckVerified(internalDependFile.c_str()))
+      {
+      needRescanDependencies = !checker.Check(dependFile.c_str(),
+                                              internalDependFile.c_str(),
+                                              validDependencies);
+      }
+    }
+
+  // Merge the dependency files written by the compiler.  Objects
+  // dropped from the target are forgotten when its information changes.
+  if(this->Makefile->GetDefinition("CMAKE_DEPENDS_COMPILER_FILES"))
+    {
+    cmDependsCompiler merger(this, dir.c_str());
+    merger.SetVerbose(verbose);
+    merger.SetFileComparison(ftc);
+    if(!merger.Update(needRescanDependInfo))
+      {
+      return false;
+      }
     }
 
   if(needRescanDependInfo || needRescanDirInfo || needRescanDependencies)
@@ -1873,6 +1949,15 @@ void cmLocalUnixMakefileGenerator3
   this->CreateCDCommand(commands,
                         this->Makefile->GetHomeOutputDirectory(),
                         cmLocalGenerator::START_OUTPUT);
+  if(static_cast<cmGlobalUnixMakefileGenerator3*>
+     (this->GlobalGenerator)->GetNonRecursive())
+    {
+    // Up-to-date targets reported no progress so report it here.
+    EchoProgress progress;
+    progress.Dir = progressDir;
+    progress.Arg = "all";
+    this->AppendEcho(commands, "Built all targets", EchoNormal, &progress);
+    }
     {
     cmOStringStream progCmd;
     progCmd << "$(CMAKE_COMMAND) -E cmake_progress_start "; // # 0
@@ -62,6 +62,13 @@ public:
                      bool symbolic,
                      bool in_help = false);
 
+  // Write out a rule giving order-only prerequisites to several
+  // targets.  Only GNU make understands this.
+  void WriteOrderOnlyRule(std::ostream& os,
+                          const char* comment,
+                          const std::vector<std::string>& targets,
+                          const std::vector<std::string>& depends);
+
   // write the main variables used by the makefiles
   void WriteMakeVariables(std::ostream& makefileStream);
 
@@ -173,8 +180,14 @@ public:
   // append an echo command
   enum EchoColor { EchoNormal, EchoDepend, EchoBuild, EchoLink,
                    EchoGenerate, EchoGlobal };
+  struct EchoProgress
+  {
+    std::string Dir;
+    std::string Arg;
+  };
   void AppendEcho(std::vector<std::string>& commands, const char* text,
-                  EchoColor color = EchoNormal);
+                  EchoColor color = EchoNormal,
+                  EchoProgress const* progress = 0);
 
   /** Get whether the makefile is to have color.  */
   bool GetColorMakefile() const { return this->ColorMakefile; }
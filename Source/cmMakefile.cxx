@@ -26,6 +26,7 @@
 #include "cmTest.h"
 #ifdef CMAKE_BUILD_WITH_CMAKE
 #  include "cmVariableWatch.h"
+#  include "cmFileHashCache.h"
 #endif
 #include "cmInstallGenerator.h"
 #include "cmTestGenerator.h"
@@ -3541,8 +3542,7 @@ int cmMakefile::ConfigureFile(const char* infile, const char* outfile,
 
   if(copyonly)
     {
-    if ( !cmSystemTools::CopyFileIfDifferent(sinfile.c_str(),
-                                             soutfile.c_str()))
+    if ( !this->CopyConfiguredFile(sinfile.c_str(), soutfile.c_str()))
       {
       return 0;
       }
@@ -3606,8 +3606,8 @@ int cmMakefile::ConfigureFile(const char* infile, const char* outfile,
     // close the files before attempting to copy
     fin.close();
     fout.close();
-    if ( !cmSystemTools::CopyFileIfDifferent(tempOutputFile.c_str(),
-                                             soutfile.c_str()) )
+    if ( !this->CopyConfiguredFile(tempOutputFile.c_str(),
+                                   soutfile.c_str()) )
       {
       res = 0;
       }
@@ -3620,6 +3620,36 @@ int cmMakefile::ConfigureFile(const char* infile, const char* outfile,
   return res;
 }
 
+//----------------------------------------------------------------------------
+bool cmMakefile::CopyConfiguredFile(const char* from, const char* to)
+{
+#if defined(CMAKE_BUILD_WITH_CMAKE)
+  // Compare with the recorded hash of the output instead of reading it.
+  std::string fromHash;
+  if(this->GetCMakeInstance()->GetWorkingMode() == cmake::NORMAL_MODE &&
+     cmFileHashCache::ComputeHash(from, fromHash))
+    {
+    std::string cacheFile = this->GetHomeOutputDirectory();
+    cacheFile += cmake::GetCMakeFilesDirectory();
+    cacheFile += "/ConfigureFileHashes.txt";
+    cmFileHashCache& cache = cmFileHashCache::Get(cacheFile);
+    std::string toHash;
+    if(cache.Lookup(to, toHash) && toHash == fromHash)
+      {
+      return true;
+      }
+    if(!cmSystemTools::CopyFileIfDifferent(from, to))
+      {
+      return false;
+      }
+    cache.Record(to, fromHash);
+    cache.Save();
+    return true;
+    }
+#endif
+  return cmSystemTools::CopyFileIfDifferent(from, to);
+}
+
 void cmMakefile::SetProperty(const std::string& prop, const char* value)
 {
   if ( prop == "LINK_DIRECTORIES" )
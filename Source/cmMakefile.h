@@ -964,6 +964,9 @@ private:
   bool EnforceUniqueDir(const std::string& srcPath,
                         const std::string& binPath) const;
 
+  // Copy a configured file unless its recorded content is the same.
+  bool CopyConfiguredFile(const char* from, const char* to);
+
   friend class cmMakeDepend;    // make depend needs direct access
                                 // to the Sources array
   void PrintStringVector(const char* s, const
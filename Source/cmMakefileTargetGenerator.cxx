@@ -56,6 +56,16 @@ cmMakefileTargetGenerator::cmMakefileTargetGenerator(cmTarget* target)
     this->NoRuleMessages = cmSystemTools::IsOff(ruleStatus);
     }
   MacOSXContentGenerator = new MacOSXContentGeneratorType(this);
+  this->CompilerDepends =
+    this->Makefile->IsOn("CMAKE_DEPENDS_USE_COMPILER");
+
+  // All targets share one makefile in the non-recursive layout so
+  // their flag and progress variables need distinct names.
+  if(this->GlobalGenerator->GetNonRecursive())
+    {
+    this->VariablePrefix =
+      this->LocalGenerator->CreateMakeVariable(this->Target->GetName(), "_");
+    }
 }
 
 cmMakefileTargetGenerator::~cmMakefileTargetGenerator()
@@ -197,6 +207,7 @@ void cmMakefileTargetGenerator::WriteTargetBuildRules()
     }
   std::vector<cmSourceFile const*> objectSources;
   this->GeneratorTarget->GetObjectSources(objectSources, config);
+  this->WritePchRuleFiles(objectSources);
   for(std::vector<cmSourceFile const*>::const_iterator
         si = objectSources.begin(); si != objectSources.end(); ++si)
     {
@@ -205,6 +216,29 @@ void cmMakefileTargetGenerator::WriteTargetBuildRules()
     }
 }
 
+//----------------------------------------------------------------------------
+void cmMakefileTargetGenerator
+::WritePchRuleFiles(std::vector<cmSourceFile const*> const& sources)
+{
+  std::set<std::string> languages;
+  for(std::vector<cmSourceFile const*>::const_iterator
+        si = sources.begin(); si != sources.end(); ++si)
+    {
+    languages.insert(this->LocalGenerator->GetSourceFileLanguage(**si));
+    }
+  for(std::set<std::string>::const_iterator li = languages.begin();
+      li != languages.end(); ++li)
+    {
+    if(cmSourceFile const* pch = this->GeneratorTarget->GetPchSource(*li))
+      {
+      // The sources using the precompiled header depend on the rule
+      // creating it so it must be written first.
+      this->PchSources[*li] = pch;
+      this->WriteObjectRuleFiles(*pch);
+      }
+    }
+}
+
 //----------------------------------------------------------------------------
 void cmMakefileTargetGenerator::WriteCommonCodeRules()
 {
@@ -222,6 +256,21 @@ void cmMakefileTargetGenerator::WriteCommonCodeRules()
                      cmLocalGenerator::MAKEFILE)
     << "\n\n";
 
+  // Include the dependencies written by the compiler.
+  std::string compilerDependFileNameFull;
+  if(this->CompilerDepends)
+    {
+    compilerDependFileNameFull = this->TargetBuildDirectoryFull;
+    compilerDependFileNameFull += "/compiler_depend.make";
+    *this->BuildFileStream
+      << "# Include any dependencies written by the compiler.\n"
+      << this->LocalGenerator->IncludeDirective << " " << root
+      << this->Convert(compilerDependFileNameFull,
+                       cmLocalGenerator::HOME_OUTPUT,
+                       cmLocalGenerator::MAKEFILE)
+      << "\n\n";
+    }
+
   if(!this->NoRuleMessages)
     {
     // Include the progress variables for the target.
@@ -243,6 +292,15 @@ void cmMakefileTargetGenerator::WriteCommonCodeRules()
       << "# Empty dependencies file for " << this->Target->GetName() << ".\n"
       << "# This may be replaced when dependencies are built." << std::endl;
     }
+  if(!compilerDependFileNameFull.empty() &&
+     !cmSystemTools::FileExists(compilerDependFileNameFull.c_str()))
+    {
+    cmGeneratedFileStream depFileStream(compilerDependFileNameFull.c_str());
+    depFileStream
+      << "# Empty compiler generated dependencies file for "
+      << this->Target->GetName() << ".\n"
+      << "# This may be replaced when dependencies are built." << std::endl;
+    }
 
   // Open the flags file.  This should be copy-if-different because the
   // rules may depend on this file itself.
@@ -362,9 +420,10 @@ void cmMakefileTargetGenerator::WriteTargetLanguageFlags()
   for(std::set<std::string>::const_iterator l = languages.begin();
       l != languages.end(); ++l)
     {
-    *this->FlagFileStream << *l << "_FLAGS = " << this->GetFlags(*l) << "\n\n";
-    *this->FlagFileStream << *l << "_DEFINES = " << this->GetDefines(*l) <<
-      "\n\n";
+    *this->FlagFileStream << this->VariablePrefix << *l << "_FLAGS = "
+                          << this->GetFlags(*l) << "\n\n";
+    *this->FlagFileStream << this->VariablePrefix << *l << "_DEFINES = "
+                          << this->GetDefines(*l) << "\n\n";
     }
 }
 
@@ -434,12 +493,23 @@ void cmMakefileTargetGenerator
     return;
     }
 
-  // Get the full path name of the object file.
-  std::string const& objectName = this->GeneratorTarget
-                                      ->GetObjectName(&source);
+  // Get the full path name of the object file.  The object of a
+  // precompiled header source may be the precompiled header itself.
+  std::map<std::string, cmSourceFile const*>::const_iterator
+    pchi = this->PchSources.find(lang);
+  bool isPch = pchi != this->PchSources.end() && pchi->second == &source;
   std::string obj = this->LocalGenerator->GetTargetDirectory(*this->Target);
   obj += "/";
-  obj += objectName;
+  if(isPch)
+    {
+    obj += this->GeneratorTarget->GetPchObjectName(lang);
+    this->PchObjects[lang] =
+      this->LocalGenerator->GetHomeRelativeOutputPath() + obj;
+    }
+  else
+    {
+    obj += this->GeneratorTarget->GetObjectName(&source);
+    }
 
   // Avoid generating duplicate rules.
   if(this->ObjectFiles.find(obj) == this->ObjectFiles.end())
@@ -465,8 +535,17 @@ void cmMakefileTargetGenerator
     (this->LocalGenerator->ConvertToFullPath(dir).c_str());
 
   // Save this in the target's list of object files.
-  this->Objects.push_back(obj);
+  if(!isPch || this->GeneratorTarget->IsPchObjectLinked())
+    {
+    this->Objects.push_back(obj);
+    }
   this->CleanFiles.push_back(obj);
+  if(isPch && this->GeneratorTarget->IsPchObjectLinked())
+    {
+    this->CleanFiles.push_back(this->Convert(
+      this->GeneratorTarget->GetPchFile(lang),
+      cmLocalGenerator::START_OUTPUT, cmLocalGenerator::UNCHANGED));
+    }
 
   // TODO: Remove
   //std::string relativeObj
@@ -489,10 +568,20 @@ void cmMakefileTargetGenerator
     this->Convert(objFullPath, cmLocalGenerator::FULL);
   std::string srcFullPath =
     this->Convert(source.GetFullPath(), cmLocalGenerator::FULL);
-  this->LocalGenerator->
-    AddImplicitDepends(*this->Target, lang,
-                       objFullPath.c_str(),
-                       srcFullPath.c_str());
+  if(this->GetCompilerDependFlags(lang, obj).empty())
+    {
+    this->LocalGenerator->
+      AddImplicitDepends(*this->Target, lang,
+                         objFullPath.c_str(),
+                         srcFullPath.c_str());
+    }
+  else
+    {
+    // The compiler writes the dependencies of the object.
+    this->CompilerDependFiles.push_back(objFullPath);
+    this->CompilerDependFiles.push_back(objFullPath + ".d");
+    this->CleanFiles.push_back(obj + ".d");
+    }
 }
 
 //----------------------------------------------------------------------------
@@ -524,6 +613,37 @@ cmMakefileTargetGenerator
     }
 }
 
+//----------------------------------------------------------------------------
+std::string
+cmMakefileTargetGenerator::GetCompilerDependFlags(const std::string& lang,
+                                                  std::string const& obj)
+{
+  // Only the scanning of C and C++ sources is replaced.  Fortran objects
+  // also need the module dependencies found by cmDependsFortran.
+  if(!this->CompilerDepends || (lang != "C" && lang != "CXX"))
+    {
+    return "";
+    }
+  std::string flagsVar = "CMAKE_DEPFILE_FLAGS_";
+  flagsVar += lang;
+  std::string depFlags = this->Makefile->GetSafeDefinition(flagsVar);
+  if(depFlags.empty())
+    {
+    return depFlags;
+    }
+  // The compiler runs in the directory of the object path.
+  std::string depFile = obj + ".d";
+  cmSystemTools::ReplaceString(depFlags, "<DEPFILE>",
+    this->Convert(depFile, cmLocalGenerator::NONE,
+                  cmLocalGenerator::SHELL).c_str());
+  cmSystemTools::ReplaceString(depFlags, "<OBJECT>",
+    this->Convert(obj, cmLocalGenerator::NONE,
+                  cmLocalGenerator::SHELL).c_str());
+  cmSystemTools::ReplaceString(depFlags, "<CMAKE_C_COMPILER>",
+    this->Makefile->GetSafeDefinition("CMAKE_C_COMPILER"));
+  return depFlags;
+}
+
 //----------------------------------------------------------------------------
 void
 cmMakefileTargetGenerator
@@ -542,6 +662,7 @@ cmMakefileTargetGenerator
 
   std::string relativeObj = this->LocalGenerator->GetHomeRelativeOutputPath();
   relativeObj += obj;
+  this->ObjectRuleNames.push_back(relativeObj);
   // Write the build rule.
 
   // Build the set of compiler flags.
@@ -549,6 +670,7 @@ cmMakefileTargetGenerator
 
   // Add language-specific flags.
   std::string langFlags = "$(";
+  langFlags += this->VariablePrefix;
   langFlags += lang;
   langFlags += "_FLAGS)";
   this->LocalGenerator->AppendFlags(flags, langFlags.c_str());
@@ -574,6 +696,31 @@ cmMakefileTargetGenerator
                           << "\n";
     }
 
+  // Add flags to create or to use the precompiled header.  Sources using
+  // it are rebuilt when it changes.
+  std::map<std::string, cmSourceFile const*>::const_iterator
+    pchi = this->PchSources.find(lang);
+  if(pchi != this->PchSources.end())
+    {
+    std::string pchOptions;
+    if(pchi->second == &source)
+      {
+      pchOptions = this->GeneratorTarget->GetPchCreateCompileOptions(lang);
+      }
+    else if(!source.GetPropertyAsBool("SKIP_PRECOMPILE_HEADERS"))
+      {
+      pchOptions = this->GeneratorTarget->GetPchUseCompileOptions(lang);
+      depends.push_back(this->PchObjects[lang]);
+      }
+    std::vector<std::string> opts;
+    cmSystemTools::ExpandListArgument(pchOptions, opts);
+    for(std::vector<std::string>::const_iterator oi = opts.begin();
+        oi != opts.end(); ++oi)
+      {
+      this->LocalGenerator->AppendFlagEscape(flags, *oi);
+      }
+    }
+
   // Add language-specific defines.
   std::set<std::string> defines;
 
@@ -615,16 +762,19 @@ cmMakefileTargetGenerator
   std::vector<std::string> commands;
 
   // add in a progress call if needed
-  this->AppendProgress(commands);
+  this->NumberOfProgressActions++;
 
   if(!this->NoRuleMessages)
     {
+    cmLocalUnixMakefileGenerator3::EchoProgress progress;
+    this->MakeEchoProgress(progress);
     std::string buildEcho = "Building ";
     buildEcho += lang;
     buildEcho += " object ";
     buildEcho += relativeObj;
     this->LocalGenerator->AppendEcho
-      (commands, buildEcho.c_str(), cmLocalUnixMakefileGenerator3::EchoBuild);
+      (commands, buildEcho.c_str(), cmLocalUnixMakefileGenerator3::EchoBuild,
+       &progress);
     }
 
   std::string targetOutPathReal;
@@ -687,6 +837,7 @@ cmMakefileTargetGenerator
   vars.Flags = flags.c_str();
 
   std::string definesString = "$(";
+  definesString += this->VariablePrefix;
   definesString += lang;
   definesString += "_DEFINES)";
 
@@ -706,6 +857,12 @@ cmMakefileTargetGenerator
   std::vector<std::string> compileCommands;
   cmSystemTools::ExpandListArgument(compileRule, compileCommands);
 
+  // Only the compilation itself writes the dependency file.
+  std::string compileFlags = flags;
+  this->LocalGenerator->AppendFlags(compileFlags,
+    this->GetCompilerDependFlags(lang, obj).c_str());
+  vars.Flags = compileFlags.c_str();
+
   if (this->Makefile->IsOn("CMAKE_EXPORT_COMPILE_COMMANDS") &&
       lang_is_c_or_cxx && compileCommands.size() == 1)
     {
@@ -716,7 +873,8 @@ cmMakefileTargetGenerator
         this->Makefile->GetStartOutputDirectory(), cmLocalGenerator::FULL);
     compileCommand.replace(compileCommand.find(langFlags),
                            langFlags.size(), this->GetFlags(lang));
-    std::string langDefines = std::string("$(") + lang + "_DEFINES)";
+    std::string langDefines =
+      "$(" + this->VariablePrefix + lang + "_DEFINES)";
     compileCommand.replace(compileCommand.find(langDefines),
                            langDefines.size(), this->GetDefines(lang));
     this->GlobalGenerator->AddCXXCompileCommand(
@@ -737,6 +895,7 @@ cmMakefileTargetGenerator
      cmLocalGenerator::HOME_OUTPUT);
   commands.insert(commands.end(),
                   compileCommands.begin(), compileCommands.end());
+  vars.Flags = flags.c_str();
   }
 
   // Write the rule.
@@ -1021,6 +1180,25 @@ void cmMakefileTargetGenerator::WriteTargetDependRules()
     *this->InfoFileStream << "  )\n\n";
     }
 
+  // Store the dependency files written by the compiler.
+  if(!this->CompilerDependFiles.empty())
+    {
+    *this->InfoFileStream
+      << "\n"
+      << "# Pairs of object files and their compiler dependency files.\n"
+      << "set(CMAKE_DEPENDS_COMPILER_FILES\n";
+    for(std::vector<std::string>::const_iterator ci =
+          this->CompilerDependFiles.begin();
+        ci != this->CompilerDependFiles.end(); ci += 2)
+      {
+      *this->InfoFileStream
+        << "  " << this->LocalGenerator->EscapeForCMake(*ci)
+        << " "  << this->LocalGenerator->EscapeForCMake(*(ci+1))
+        << "\n";
+      }
+    *this->InfoFileStream << "  )\n\n";
+    }
+
   // Store list of targets linked directly or transitively.
   {
   *this->InfoFileStream
@@ -1217,18 +1395,32 @@ void cmMakefileTargetGenerator
 void cmMakefileTargetGenerator
 ::GenerateCustomRuleFile(cmCustomCommandGenerator const& ccg)
 {
+  // All targets share one makefile in the non-recursive layout so the
+  // rule for outputs listed by several targets is written only once.
+  if(this->GlobalGenerator->GetNonRecursive())
+    {
+    this->AppendGeneratedFiles(ccg.GetOutputs());
+    if(!this->GlobalGenerator->AddCustomCommandOutput(ccg.GetOutputs()[0]))
+      {
+      return;
+      }
+    }
+
   // Collect the commands.
   std::vector<std::string> commands;
   std::string comment = this->LocalGenerator->ConstructComment(ccg);
   if(!comment.empty())
     {
     // add in a progress call if needed
-    this->AppendProgress(commands);
+    this->NumberOfProgressActions++;
     if(!this->NoRuleMessages)
       {
+      cmLocalUnixMakefileGenerator3::EchoProgress progress;
+      this->MakeEchoProgress(progress);
       this->LocalGenerator
         ->AppendEcho(commands, comment.c_str(),
-                     cmLocalUnixMakefileGenerator3::EchoGenerate);
+                     cmLocalUnixMakefileGenerator3::EchoGenerate,
+                     &progress);
       }
     }
 
@@ -1299,6 +1491,29 @@ void cmMakefileTargetGenerator
     }
 }
 
+//----------------------------------------------------------------------------
+void
+cmMakefileTargetGenerator
+::AppendGeneratedFiles(std::vector<std::string> const& outputs)
+{
+  // Symbolic outputs are never up to date so they would force a
+  // dependency rescan on every build.  They are still driven by the
+  // target and built after its dependencies.
+  for(std::vector<std::string>::const_iterator o = outputs.begin();
+      o != outputs.end(); ++o)
+    {
+    cmSourceFile* sf = this->Makefile->GetSource(*o);
+    if(!(sf && sf->GetPropertyAsBool("SYMBOLIC")))
+      {
+      this->GeneratedFiles.push_back(*o);
+      }
+    else
+      {
+      this->DrivenFiles.push_back(*o);
+      }
+    }
+}
+
 //----------------------------------------------------------------------------
 void
 cmMakefileTargetGenerator
@@ -1327,22 +1542,15 @@ cmMakefileTargetGenerator
 
 //----------------------------------------------------------------------------
 void
-cmMakefileTargetGenerator::AppendProgress(std::vector<std::string>& commands)
+cmMakefileTargetGenerator
+::MakeEchoProgress(cmLocalUnixMakefileGenerator3::EchoProgress& progress) const
 {
-  this->NumberOfProgressActions++;
-  if(this->NoRuleMessages)
-    {
-    return;
-    }
-  std::string progressDir = this->Makefile->GetHomeOutputDirectory();
-  progressDir += cmake::GetCMakeFilesDirectory();
-  cmOStringStream progCmd;
-  progCmd << "$(CMAKE_COMMAND) -E cmake_progress_report ";
-  progCmd << this->LocalGenerator->Convert(progressDir,
-                                           cmLocalGenerator::FULL,
-                                           cmLocalGenerator::SHELL);
-  progCmd << " $(CMAKE_PROGRESS_" << this->NumberOfProgressActions << ")";
-  commands.push_back(progCmd.str());
+  progress.Dir = this->Makefile->GetHomeOutputDirectory();
+  progress.Dir += cmake::GetCMakeFilesDirectory();
+  cmOStringStream progressArg;
+  progressArg << "$(" << this->VariablePrefix << "CMAKE_PROGRESS_"
+              << this->NumberOfProgressActions << ")";
+  progress.Arg = progressArg.str();
 }
 
 //----------------------------------------------------------------------------
@@ -1526,6 +1734,13 @@ void cmMakefileTargetGenerator::WriteTargetDriverRule(
       }
     }
 
+  // Remember the files this target drives for the non-recursive layout.
+  if(!relink)
+    {
+    this->DrivenFiles.insert(this->DrivenFiles.end(),
+                             depends.begin(), depends.end());
+    }
+
   // Write the driver rule.
   std::vector<std::string> no_commands;
   this->LocalGenerator->WriteMakeRule(*this->BuildFileStream, comment,
@@ -52,6 +52,26 @@ public:
 
   cmTarget* GetTarget() { return this->Target;}
 
+  /** Prefix of the flag and progress variable names of this target.
+      It is empty unless the non-recursive layout is used.  */
+  std::string const& GetVariablePrefix() const
+    { return this->VariablePrefix; }
+
+  /** Names of the object file rules, relative to the top of the
+      build tree.  */
+  std::vector<std::string> const& GetObjectRuleNames() const
+    { return this->ObjectRuleNames; }
+
+  /** Outputs of custom commands in this target that are real files.
+      Only recorded for the non-recursive layout.  */
+  std::vector<std::string> const& GetGeneratedFiles() const
+    { return this->GeneratedFiles; }
+
+  /** Files driven by the target's build rule and symbolic outputs of
+      custom commands in this target.  */
+  std::vector<std::string> const& GetDrivenFiles() const
+    { return this->DrivenFiles; }
+
 protected:
 
   // create the file and directory etc
@@ -91,6 +111,9 @@ protected:
   // write the rules for an object
   void WriteObjectRuleFiles(cmSourceFile const& source);
 
+  // write the rules creating the precompiled headers of the sources
+  void WritePchRuleFiles(std::vector<cmSourceFile const*> const& sources);
+
   // write the build rule for an object
   void WriteObjectBuildFile(std::string &obj,
                             const std::string& lang,
@@ -109,7 +132,7 @@ protected:
   void GenerateExtraOutput(const char* out, const char* in,
                            bool symbolic = false);
 
-  void AppendProgress(std::vector<std::string>& commands);
+  void MakeEchoProgress(cmLocalUnixMakefileGenerator3::EchoProgress&) const;
 
   // write out the variable that lists the objects for this target
   void WriteObjectsVariable(std::string& variableName,
@@ -123,6 +146,7 @@ protected:
   void WriteTargetDriverRule(const std::string& main_output, bool relink);
 
   void DriveCustomCommands(std::vector<std::string>& depends);
+  void AppendGeneratedFiles(std::vector<std::string> const& outputs);
 
   // Return the a string with -F flags on apple
   std::string GetFrameworkFlags(std::string const& l);
@@ -130,6 +154,11 @@ protected:
   void AppendFortranFormatFlags(std::string& flags,
                                 cmSourceFile const& source);
 
+  // Return the flags that make the compiler write a dependency file
+  // for the object, or an empty string if dependencies are scanned.
+  std::string GetCompilerDependFlags(const std::string& lang,
+                                     std::string const& obj);
+
   // append intertarget dependencies
   void AppendTargetDepends(std::vector<std::string>& depends);
 
@@ -224,16 +253,30 @@ protected:
   // objects used by this target
   std::vector<std::string> Objects;
   std::vector<std::string> ExternalObjects;
+  std::vector<std::string> ObjectRuleNames;
+
+  // files written by rules of this target for the non-recursive layout
+  std::string VariablePrefix;
+  std::vector<std::string> GeneratedFiles;
+  std::vector<std::string> DrivenFiles;
 
   // Set of object file names that will be built in this directory.
   std::set<std::string> ObjectFiles;
 
+  // Precompiled header sources and their objects for each language.
+  std::map<std::string, cmSourceFile const*> PchSources;
+  std::map<std::string, std::string> PchObjects;
+
   // Set of extra output files to be driven by the build.
   std::set<std::string> ExtraFiles;
 
   typedef std::map<std::string, std::string> MultipleOutputPairsType;
   MultipleOutputPairsType MultipleOutputPairs;
 
+  // Objects and the dependency files the compiler writes for them.
+  bool CompilerDepends;
+  std::vector<std::string> CompilerDependFiles;
+
   // Target name info.
   std::string TargetNameOut;
   std::string TargetNameSO;
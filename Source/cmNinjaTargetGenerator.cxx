@@ -187,6 +187,30 @@ cmNinjaTargetGenerator::ComputeFlagsForObject(cmSourceFile const* source,
   this->LocalGenerator->AppendFlags(flags,
     source->GetProperty("COMPILE_FLAGS"));
 
+  // Add flags to create or to use the precompiled header.
+  std::map<std::string, cmSourceFile const*>::const_iterator
+    pi = this->PchSources.find(language);
+  if(pi != this->PchSources.end())
+    {
+    std::string pchOptions;
+    if(pi->second == source)
+      {
+      pchOptions =
+        this->GeneratorTarget->GetPchCreateCompileOptions(language);
+      }
+    else if(!source->GetPropertyAsBool("SKIP_PRECOMPILE_HEADERS"))
+      {
+      pchOptions = this->GeneratorTarget->GetPchUseCompileOptions(language);
+      }
+    std::vector<std::string> opts;
+    cmSystemTools::ExpandListArgument(pchOptions, opts);
+    for(std::vector<std::string>::const_iterator oi = opts.begin();
+        oi != opts.end(); ++oi)
+      {
+      this->LocalGenerator->AppendFlagEscape(flags, *oi);
+      }
+    }
+
   // TODO: Handle Apple frameworks.
 
   return flags;
@@ -281,11 +305,18 @@ cmNinjaTargetGenerator
   std::string path = this->LocalGenerator->GetHomeRelativeOutputPath();
   if(!path.empty())
     path += "/";
-  std::string const& objectName = this->GeneratorTarget
-                                      ->GetObjectName(source);
   path += this->LocalGenerator->GetTargetDirectory(*this->Target);
   path += "/";
-  path += objectName;
+  std::map<std::string, cmSourceFile const*>::const_iterator
+    pi = this->PchSources.find(source->GetLanguage());
+  if(pi != this->PchSources.end() && pi->second == source)
+    {
+    path += this->GeneratorTarget->GetPchObjectName(source->GetLanguage());
+    }
+  else
+    {
+    path += this->GeneratorTarget->GetObjectName(source);
+    }
   return path;
 }
 
@@ -518,6 +549,21 @@ cmNinjaTargetGenerator
     }
   std::vector<cmSourceFile const*> objectSources;
   this->GeneratorTarget->GetObjectSources(objectSources, config);
+  std::set<std::string> languages;
+  for(std::vector<cmSourceFile const*>::const_iterator
+        si = objectSources.begin(); si != objectSources.end(); ++si)
+    {
+    languages.insert((*si)->GetLanguage());
+    }
+  for(std::set<std::string>::const_iterator li = languages.begin();
+      li != languages.end(); ++li)
+    {
+    if(cmSourceFile const* pch = this->GeneratorTarget->GetPchSource(*li))
+      {
+      this->PchSources[*li] = pch;
+      this->WriteObjectBuildStatement(pch);
+      }
+    }
   for(std::vector<cmSourceFile const*>::const_iterator
         si = objectSources.begin(); si != objectSources.end(); ++si)
     {
@@ -543,8 +589,17 @@ cmNinjaTargetGenerator
   cmNinjaDeps outputs;
   std::string objectFileName = this->GetObjectFilePath(source);
   outputs.push_back(objectFileName);
-  // Add this object to the list of object files.
-  this->Objects.push_back(objectFileName);
+
+  // The object of a precompiled header source may be the precompiled
+  // header itself, which is not linked.
+  std::map<std::string, cmSourceFile const*>::const_iterator
+    pi = this->PchSources.find(language);
+  bool isPch = pi != this->PchSources.end() && pi->second == source;
+  if(!isPch || this->GeneratorTarget->IsPchObjectLinked())
+    {
+    // Add this object to the list of object files.
+    this->Objects.push_back(objectFileName);
+    }
 
   cmNinjaDeps explicitDeps;
   std::string sourceFileName;
@@ -567,6 +622,12 @@ cmNinjaTargetGenerator
                    std::back_inserter(implicitDeps), MapToNinjaPath());
   }
 
+  // Sources using the precompiled header are rebuilt when it changes.
+  if(pi != this->PchSources.end() && !isPch &&
+     !source->GetPropertyAsBool("SKIP_PRECOMPILE_HEADERS")) {
+    implicitDeps.push_back(this->GetObjectFilePath(pi->second));
+  }
+
   // Add order-only dependencies on custom command outputs.
   for(std::vector<cmCustomCommand const*>::const_iterator
         cci = this->CustomCommands.begin();
@@ -155,6 +155,9 @@ private:
   cmNinjaDeps Objects;
   std::vector<cmCustomCommand const*> CustomCommands;
 
+  /// Precompiled header source of each language, if any.
+  std::map<std::string, cmSourceFile const*> PchSources;
+
   typedef std::map<std::string, std::string> LanguageFlagMap;
   LanguageFlagMap LanguageFlags;
 
@@ -49,6 +49,14 @@
 # include <mach-o/dyld.h>
 #endif
 
+#if defined(__linux__)
+# include <fcntl.h>
+# include <sys/ioctl.h>
+# ifndef FICLONE
+#  define FICLONE _IOW(0x94, 9, int)
+# endif
+#endif
+
 #include <sys/stat.h>
 
 #if defined(_WIN32) && \
@@ -913,6 +921,43 @@ bool cmSystemTools::RenameFile(const char* oldname, const char* newname)
 #endif
 }
 
+//----------------------------------------------------------------------------
+bool cmSystemTools::CloneFile(const char* source, const char* destination)
+{
+#if defined(__linux__)
+  int in = open(source, O_RDONLY);
+  if(in < 0)
+    {
+    return false;
+    }
+  struct stat st;
+  if(fstat(in, &st) < 0)
+    {
+    close(in);
+    return false;
+    }
+  int out = open(destination, O_WRONLY | O_CREAT | O_TRUNC,
+                 st.st_mode & 07777);
+  if(out < 0)
+    {
+    close(in);
+    return false;
+    }
+  bool cloned = ioctl(out, FICLONE, in) == 0;
+  close(out);
+  close(in);
+  if(!cloned)
+    {
+    unlink(destination);
+    }
+  return cloned;
+#else
+  (void)source;
+  (void)destination;
+  return false;
+#endif
+}
+
 bool cmSystemTools::ComputeFileMD5(const std::string& source, char* md5out)
 {
 #if defined(CMAKE_BUILD_WITH_CMAKE)
@@ -1414,7 +1459,8 @@ bool cmSystemTools::IsPathToFramework(const char* path)
 
 bool cmSystemTools::CreateTar(const char* outFileName,
                               const std::vector<std::string>& files,
-                              bool gzip, bool bzip2, bool verbose)
+                              bool gzip, bool bzip2, bool verbose,
+                              unsigned int compressionJobs)
 {
 #if defined(CMAKE_BUILD_WITH_CMAKE)
   std::string cwd = cmSystemTools::GetCurrentWorkingDirectory();
@@ -1431,7 +1477,7 @@ bool cmSystemTools::CreateTar(const char* outFileName,
   cmArchiveWrite a(fout, (gzip? cmArchiveWrite::CompressGZip :
                           (bzip2? cmArchiveWrite::CompressBZip2 :
                            cmArchiveWrite::CompressNone)),
-                           cmArchiveWrite::TypeTAR);
+                           cmArchiveWrite::TypeTAR, compressionJobs);
   a.SetVerbose(verbose);
   for(std::vector<std::string>::const_iterator i = files.begin();
       i != files.end(); ++i)
@@ -1447,7 +1493,7 @@ bool cmSystemTools::CreateTar(const char* outFileName,
       break;
       }
     }
-  if(!a)
+  if(!a.Close())
     {
     cmSystemTools::Error(a.GetError().c_str());
     return false;
@@ -1458,6 +1504,7 @@ bool cmSystemTools::CreateTar(const char* outFileName,
   (void)files;
   (void)gzip;
   (void)verbose;
+  (void)compressionJobs;
   return false;
 #endif
 }
@@ -2051,7 +2098,41 @@ static std::string cmSystemToolsCPackCommand;
 static std::string cmSystemToolsCMakeCursesCommand;
 static std::string cmSystemToolsCMakeGUICommand;
 static std::string cmSystemToolsCMakeRoot;
-void cmSystemTools::FindCMakeResources(const char* argv0)
+static std::string cmSystemToolsPendingArgv0;
+static bool cmSystemToolsResourcesPending = false;
+static void cmSystemToolsFindCMakeResources(const char* argv0);
+
+//----------------------------------------------------------------------------
+void cmSystemTools::FindCMakeResources(const char* argv0, bool lazy)
+{
+  if(!lazy)
+    {
+    cmSystemToolsResourcesPending = false;
+    cmSystemToolsFindCMakeResources(argv0);
+    return;
+    }
+  // Save what the search needs.  A relative path must be anchored in
+  // the current working directory now in case it changes later.
+  cmSystemToolsPendingArgv0 = argv0;
+  if(strchr(argv0, '/') && !cmSystemTools::FileIsFullPath(argv0))
+    {
+    cmSystemToolsPendingArgv0 = cmSystemTools::CollapseFullPath(argv0);
+    }
+  cmSystemToolsResourcesPending = true;
+}
+
+//----------------------------------------------------------------------------
+static void cmSystemToolsLoadCMakeResources()
+{
+  if(cmSystemToolsResourcesPending)
+    {
+    cmSystemToolsResourcesPending = false;
+    cmSystemToolsFindCMakeResources(cmSystemToolsPendingArgv0.c_str());
+    }
+}
+
+//----------------------------------------------------------------------------
+static void cmSystemToolsFindCMakeResources(const char* argv0)
 {
   std::string exe_dir;
 #if defined(_WIN32) && !defined(__CYGWIN__)
@@ -2176,36 +2257,42 @@ void cmSystemTools::FindCMakeResources(const char* argv0)
 //----------------------------------------------------------------------------
 std::string const& cmSystemTools::GetCMakeCommand()
 {
+  cmSystemToolsLoadCMakeResources();
   return cmSystemToolsCMakeCommand;
 }
 
 //----------------------------------------------------------------------------
 std::string const& cmSystemTools::GetCTestCommand()
 {
+  cmSystemToolsLoadCMakeResources();
   return cmSystemToolsCTestCommand;
 }
 
 //----------------------------------------------------------------------------
 std::string const& cmSystemTools::GetCPackCommand()
 {
+  cmSystemToolsLoadCMakeResources();
   return cmSystemToolsCPackCommand;
 }
 
 //----------------------------------------------------------------------------
 std::string const& cmSystemTools::GetCMakeCursesCommand()
 {
+  cmSystemToolsLoadCMakeResources();
   return cmSystemToolsCMakeCursesCommand;
 }
 
 //----------------------------------------------------------------------------
 std::string const& cmSystemTools::GetCMakeGUICommand()
 {
+  cmSystemToolsLoadCMakeResources();
   return cmSystemToolsCMakeGUICommand;
 }
 
 //----------------------------------------------------------------------------
 std::string const& cmSystemTools::GetCMakeRoot()
 {
+  cmSystemToolsLoadCMakeResources();
   return cmSystemToolsCMakeRoot;
 }
 
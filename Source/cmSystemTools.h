@@ -185,6 +185,10 @@ public:
       if possible).  */
   static bool RenameFile(const char* oldname, const char* newname);
 
+  /** Create a copy-on-write clone (reflink) of a file.  Fails without
+      leaving the destination behind if the file system cannot clone.  */
+  static bool CloneFile(const char* source, const char* destination);
+
   ///! Compute the md5sum of a file
   static bool ComputeFileMD5(const std::string& source, char* md5out);
 
@@ -384,7 +388,8 @@ public:
                       bool gzip, bool verbose);
   static bool CreateTar(const char* outFileName,
                         const std::vector<std::string>& files, bool gzip,
-                        bool bzip2, bool verbose);
+                        bool bzip2, bool verbose,
+                        unsigned int compressionJobs = 1);
   static bool ExtractTar(const char* inFileName, bool gzip,
                          bool verbose);
   // This should be called first thing in main
@@ -407,8 +412,9 @@ public:
   /** Random seed generation.  */
   static unsigned int RandomSeed();
 
-  /** Find the directory containing CMake executables.  */
-  static void FindCMakeResources(const char* argv0);
+  /** Find the directory containing CMake executables.  If 'lazy' is
+      true the search is deferred until a resource path is requested.  */
+  static void FindCMakeResources(const char* argv0, bool lazy = false);
 
   /** Get the CMake resource paths, after FindCMakeResources.  */
   static std::string const& GetCTestCommand();
@@ -316,6 +316,8 @@ void cmTarget::SetMakefile(cmMakefile* mf)
     this->SetPropertyDefault("NO_SYSTEM_FROM_IMPORTED", 0);
     this->SetPropertyDefault("CXX_STANDARD", 0);
     this->SetPropertyDefault("CXX_EXTENSIONS", 0);
+    this->SetPropertyDefault("UNITY_BUILD", 0);
+    this->SetPropertyDefault("UNITY_BUILD_BATCH_SIZE", 0);
     }
 
   // Collect the set of configuration types.
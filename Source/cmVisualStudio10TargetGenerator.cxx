@@ -1017,6 +1017,25 @@ void cmVisualStudio10TargetGenerator::WriteAllSources()
 
   std::vector<cmSourceFile const*> objectSources;
   this->GeneratorTarget->GetObjectSources(objectSources, "");
+
+  // Compile the precompiled header sources along with the others.
+  std::set<std::string> languages;
+  for(std::vector<cmSourceFile const*>::const_iterator
+        si = objectSources.begin();
+      si != objectSources.end(); ++si)
+    {
+    languages.insert((*si)->GetLanguage());
+    }
+  for(std::set<std::string>::const_iterator li = languages.begin();
+      li != languages.end(); ++li)
+    {
+    if(cmSourceFile const* pch = this->GeneratorTarget->GetPchSource(*li))
+      {
+      this->PchSources[*li] = pch;
+      objectSources.push_back(pch);
+      }
+    }
+
   for(std::vector<cmSourceFile const*>::const_iterator
         si = objectSources.begin();
       si != objectSources.end(); ++si)
@@ -1134,6 +1153,34 @@ bool cmVisualStudio10TargetGenerator::OutputSourceSpecificFlags(
     this->GlobalGenerator->GetLanguageFromExtension
     (sf.GetExtension().c_str());
   std::string sourceLang = this->LocalGenerator->GetSourceFileLanguage(sf);
+
+  // Create or use the precompiled header.  The flag table turns the
+  // options into the PrecompiledHeader settings of the source.
+  std::map<std::string, cmSourceFile const*>::const_iterator
+    pchi = this->PchSources.find(sourceLang);
+  if(pchi != this->PchSources.end())
+    {
+    std::string pchOptions;
+    if(pchi->second == source)
+      {
+      pchOptions =
+        this->GeneratorTarget->GetPchCreateCompileOptions(sourceLang);
+      }
+    else if(!sf.GetPropertyAsBool("SKIP_PRECOMPILE_HEADERS"))
+      {
+      pchOptions =
+        this->GeneratorTarget->GetPchUseCompileOptions(sourceLang);
+      }
+    std::vector<std::string> opts;
+    cmSystemTools::ExpandListArgument(pchOptions, opts);
+    for(std::vector<std::string>::const_iterator oi = opts.begin();
+        oi != opts.end(); ++oi)
+      {
+      flags += " \"";
+      flags += *oi;
+      flags += "\"";
+      }
+    }
   const std::string& linkLanguage = this->Target->GetLinkerLanguage();
   bool needForceLang = false;
   // source file does not match its extension language
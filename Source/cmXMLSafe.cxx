@@ -14,7 +14,6 @@
 #include "cm_utf8.h"
 
 #include <cmsys/ios/iostream>
-#include <cmsys/ios/sstream>
 
 #include <string.h>
 #include <stdio.h>
@@ -45,18 +44,57 @@ cmXMLSafe& cmXMLSafe::Quotes(bool b)
 //----------------------------------------------------------------------------
 cmsys_stl::string cmXMLSafe::str()
 {
-  cmsys_ios::ostringstream ss;
-  ss << *this;
-  return ss.str();
+  cmsys_stl::string s;
+  this->AppendTo(s);
+  return s;
 }
 
 //----------------------------------------------------------------------------
-cmsys_ios::ostream& operator<<(cmsys_ios::ostream& os, cmXMLSafe const& self)
+namespace
+{
+// Destinations for the escaped data.  Runs of characters that need no
+// escaping are passed on with a single call.
+struct cmXMLSafeStreamSink
+{
+  cmXMLSafeStreamSink(cmsys_ios::ostream& os): OS(os) {}
+  void Write(const char* data, size_t length)
+    { this->OS.write(data, static_cast<cmsys_ios::streamsize>(length)); }
+  cmsys_ios::ostream& OS;
+};
+struct cmXMLSafeStringSink
 {
-  char const* first = self.Data;
-  char const* last = self.Data + self.Size;
+  cmXMLSafeStringSink(cmsys_stl::string& s): S(s) {}
+  void Write(const char* data, size_t length)
+    { this->S.append(data, length); }
+  cmsys_stl::string& S;
+};
+
+template <class Sink>
+void cmXMLSafeWrite(Sink& sink, const char* first, const char* last,
+                    bool doQuotes)
+{
+  // Start of the pending run of characters to be copied verbatim.
+  const char* run = first;
   while(first != last)
     {
+    unsigned char c = static_cast<unsigned char>(*first);
+    // Fast path for the common case of printable ASCII.
+    if(c >= 0x20 && c < 0x80 && c != '&' && c != '<' && c != '>' &&
+       c != '"' && c != '\'')
+      {
+      ++first;
+      continue;
+      }
+    if(c == '\n' || c == '\t')
+      {
+      ++first;
+      continue;
+      }
+    if(run != first)
+      {
+      sink.Write(run, first - run);
+      }
+
     unsigned int ch;
     if(const char* next = cm_utf8_decode_character(first, last, &ch))
       {
@@ -69,22 +107,28 @@ cmsys_ios::ostream& operator<<(cmsys_ios::ostream& os, cmXMLSafe const& self)
         switch(ch)
           {
           // Escape XML control characters.
-          case '&': os << "&amp;"; break;
-          case '<': os << "&lt;"; break;
-          case '>': os << "&gt;"; break;
-          case '"': os << (self.DoQuotes? "&quot;" : "\""); break;
-          case '\'': os << (self.DoQuotes? "&apos;" : "'"); break;
+          case '&': sink.Write("&amp;", 5); break;
+          case '<': sink.Write("&lt;", 4); break;
+          case '>': sink.Write("&gt;", 4); break;
+          case '"':
+            if(doQuotes) { sink.Write("&quot;", 6); }
+            else { sink.Write("\"", 1); }
+            break;
+          case '\'':
+            if(doQuotes) { sink.Write("&apos;", 6); }
+            else { sink.Write("'", 1); }
+            break;
           case '\r': break; // Ignore CR
           // Print the UTF-8 character.
-          default: os.write(first, next-first); break;
+          default: sink.Write(first, next-first); break;
           }
         }
       else
         {
         // Use a human-readable hex value for this invalid character.
-        char buf[16];
-        sprintf(buf, "%X", ch);
-        os << "[NON-XML-CHAR-0x" << buf << "]";
+        char buf[32];
+        sprintf(buf, "[NON-XML-CHAR-0x%X]", ch);
+        sink.Write(buf, strlen(buf));
         }
 
       first = next;
@@ -93,10 +137,30 @@ cmsys_ios::ostream& operator<<(cmsys_ios::ostream& os, cmXMLSafe const& self)
       {
       ch = static_cast<unsigned char>(*first++);
       // Use a human-readable hex value for this invalid byte.
-      char buf[16];
-      sprintf(buf, "%X", ch);
-      os << "[NON-UTF-8-BYTE-0x" << buf << "]";
+      char buf[32];
+      sprintf(buf, "[NON-UTF-8-BYTE-0x%X]", ch);
+      sink.Write(buf, strlen(buf));
       }
+    run = first;
     }
+  if(run != first)
+    {
+    sink.Write(run, first - run);
+    }
+}
+}
+
+//----------------------------------------------------------------------------
+void cmXMLSafe::AppendTo(cmsys_stl::string& out) const
+{
+  cmXMLSafeStringSink sink(out);
+  cmXMLSafeWrite(sink, this->Data, this->Data + this->Size, this->DoQuotes);
+}
+
+//----------------------------------------------------------------------------
+cmsys_ios::ostream& operator<<(cmsys_ios::ostream& os, cmXMLSafe const& self)
+{
+  cmXMLSafeStreamSink sink(os);
+  cmXMLSafeWrite(sink, self.Data, self.Data + self.Size, self.DoQuotes);
   return os;
 }
@@ -33,6 +33,9 @@ public:
 
   /** Get the escaped data as a string.  */
   cmsys_stl::string str();
+
+  /** Append the escaped data to the given string.  */
+  void AppendTo(cmsys_stl::string& out) const;
 private:
   char const* Data;
   unsigned long Size;
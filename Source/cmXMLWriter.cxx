@@ -0,0 +1,178 @@
+/*============================================================================
+  CMake - Cross Platform Makefile Generator
+  Copyright 2000-2009 Kitware, Inc., Insight Software Consortium
+
+  Distributed under the OSI-approved BSD License (the "License");
+  see accompanying file Copyright.txt for details.
+
+  This software is distributed WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the License for more information.
+============================================================================*/
+#include "cmXMLWriter.h"
+
+#include "cmXMLSafe.h"
+
+// Hand the buffer to the stream once it grows past this size.
+#define CM_XML_WRITER_BUFFER_SIZE 65536
+
+//----------------------------------------------------------------------------
+cmXMLWriter::cmXMLWriter(std::ostream& output, std::size_t level):
+  Output(output), Level(level), ElementOpen(false), HasContent(false),
+  LineOpen(false)
+{
+  this->Buffer.reserve(CM_XML_WRITER_BUFFER_SIZE * 2);
+}
+
+//----------------------------------------------------------------------------
+cmXMLWriter::~cmXMLWriter()
+{
+  this->Flush();
+}
+
+//----------------------------------------------------------------------------
+void cmXMLWriter::StartElement(std::string const& name)
+{
+  this->CloseStartElement();
+  this->NewLine(this->Elements.size());
+  this->Buffer += '<';
+  this->Buffer += name;
+  this->Elements.push_back(name);
+  this->ElementOpen = true;
+  this->HasContent = false;
+}
+
+//----------------------------------------------------------------------------
+void cmXMLWriter::EndElement()
+{
+  if(this->Elements.empty())
+    {
+    return;
+    }
+  if(this->ElementOpen)
+    {
+    this->Buffer += "/>";
+    }
+  else
+    {
+    if(!this->HasContent)
+      {
+      this->NewLine(this->Elements.size() - 1);
+      }
+    this->Buffer += "</";
+    this->Buffer += this->Elements.back();
+    this->Buffer += '>';
+    }
+  this->Elements.pop_back();
+  if(this->Elements.empty())
+    {
+    // Finish the line after a top-level element.
+    this->Buffer += '\n';
+    this->LineOpen = false;
+    }
+  this->ElementOpen = false;
+  this->HasContent = false;
+  this->MaybeFlush();
+}
+
+//----------------------------------------------------------------------------
+void cmXMLWriter::Attribute(const char* name, std::string const& value)
+{
+  this->Buffer += ' ';
+  this->Buffer += name;
+  this->Buffer += "=\"";
+  this->Escape(value, true);
+  this->Buffer += '"';
+}
+
+//----------------------------------------------------------------------------
+void cmXMLWriter::Attribute(const char* name, const char* value)
+{
+  this->Buffer += ' ';
+  this->Buffer += name;
+  this->Buffer += "=\"";
+  this->Escape(value, true);
+  this->Buffer += '"';
+}
+
+//----------------------------------------------------------------------------
+void cmXMLWriter::Content(std::string const& data)
+{
+  this->CloseStartElement();
+  this->Escape(data, false);
+  this->HasContent = true;
+  this->MaybeFlush();
+}
+
+//----------------------------------------------------------------------------
+void cmXMLWriter::Content(const char* data)
+{
+  this->CloseStartElement();
+  this->Escape(data, false);
+  this->HasContent = true;
+  this->MaybeFlush();
+}
+
+//----------------------------------------------------------------------------
+void cmXMLWriter::Fragment(std::string const& xml)
+{
+  this->CloseStartElement();
+  this->Buffer += xml;
+  this->MaybeFlush();
+}
+
+//----------------------------------------------------------------------------
+void cmXMLWriter::Flush()
+{
+  if(!this->Buffer.empty())
+    {
+    this->Output.write(this->Buffer.data(),
+                       static_cast<std::streamsize>(this->Buffer.size()));
+    this->Buffer.clear();
+    }
+  this->Output.flush();
+}
+
+//----------------------------------------------------------------------------
+void cmXMLWriter::CloseStartElement()
+{
+  if(this->ElementOpen)
+    {
+    this->Buffer += '>';
+    this->ElementOpen = false;
+    }
+}
+
+//----------------------------------------------------------------------------
+void cmXMLWriter::NewLine(std::size_t indent)
+{
+  if(this->LineOpen)
+    {
+    this->Buffer += '\n';
+    }
+  this->Buffer.append(this->Level + indent, '\t');
+  this->LineOpen = true;
+}
+
+//----------------------------------------------------------------------------
+void cmXMLWriter::Escape(std::string const& data, bool quotes)
+{
+  cmXMLSafe(data).Quotes(quotes).AppendTo(this->Buffer);
+}
+
+//----------------------------------------------------------------------------
+void cmXMLWriter::Escape(const char* data, bool quotes)
+{
+  cmXMLSafe(data).Quotes(quotes).AppendTo(this->Buffer);
+}
+
+//----------------------------------------------------------------------------
+void cmXMLWriter::MaybeFlush()
+{
+  if(this->Buffer.size() >= CM_XML_WRITER_BUFFER_SIZE)
+    {
+    this->Output.write(this->Buffer.data(),
+                       static_cast<std::streamsize>(this->Buffer.size()));
+    this->Buffer.clear();
+    }
+}
@@ -0,0 +1,92 @@
+/*============================================================================
+  CMake - Cross Platform Makefile Generator
+  Copyright 2000-2009 Kitware, Inc., Insight Software Consortium
+
+  Distributed under the OSI-approved BSD License (the "License");
+  see accompanying file Copyright.txt for details.
+
+  This software is distributed WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the License for more information.
+============================================================================*/
+#ifndef cmXMLWriter_h
+#define cmXMLWriter_h
+
+#include "cmStandardIncludes.h"
+
+/** \class cmXMLWriter
+ * \brief Write XML elements to a stream through a buffer.
+ *
+ * Markup and escaped content are appended to an in-memory buffer that
+ * is handed to the output stream in large blocks, either when it grows
+ * past a threshold or when Flush() is called.  Elements are indented by
+ * nesting depth with tabs.  Content is escaped directly into the buffer
+ * without building temporary strings.
+ */
+class cmXMLWriter
+{
+public:
+  /** Write to the given stream.  Elements are indented as if nested
+      'level' deep.  */
+  cmXMLWriter(std::ostream& output, std::size_t level = 0);
+  ~cmXMLWriter();
+
+  void StartElement(std::string const& name);
+  void EndElement();
+
+  void Attribute(const char* name, std::string const& value);
+  void Attribute(const char* name, const char* value);
+  template <typename T>
+  void Attribute(const char* name, T const& value)
+    { this->Attribute(name, ToString(value)); }
+
+  /** Write escaped character data into the current element.  */
+  void Content(std::string const& data);
+  void Content(const char* data);
+  template <typename T>
+  void Content(T const& data)
+    { this->Content(ToString(data)); }
+
+  /** Write an element containing only the given character data.  */
+  template <typename T>
+  void Element(const char* name, T const& data)
+    {
+    this->StartElement(name);
+    this->Content(data);
+    this->EndElement();
+    }
+
+  /** Write text that is already valid XML markup.  */
+  void Fragment(std::string const& xml);
+
+  /** Hand all buffered data to the output stream.  */
+  void Flush();
+
+private:
+  cmXMLWriter(cmXMLWriter const&);
+  cmXMLWriter& operator=(cmXMLWriter const&);
+
+  template <typename T>
+  static std::string ToString(T const& value)
+    {
+    cmOStringStream ostr;
+    ostr << value;
+    return ostr.str();
+    }
+
+  void CloseStartElement();
+  void NewLine(std::size_t indent);
+  void Escape(const char* data, bool quotes);
+  void Escape(std::string const& data, bool quotes);
+  void MaybeFlush();
+
+  std::ostream& Output;
+  std::string Buffer;
+  std::vector<std::string> Elements;
+  std::size_t Level;
+  bool ElementOpen;
+  bool HasContent;
+  bool LineOpen;
+};
+
+#endif
@@ -1603,6 +1603,22 @@ int cmake::Run(const std::vector<std::string>& args, bool noconfigure)
     return 0;
     }
 
+  // If we are checking the build system and no file has changed since
+  // the last full check we are done before even loading the cache.
+  double checkStart = cmSystemTools::GetTime();
+  if(!this->CheckBuildSystemArgument.empty() && !this->ClearBuildSystem &&
+     this->CheckBuildSystemManifest())
+    {
+    if(this->GetDebugOutput())
+      {
+      cmOStringStream msg;
+      msg << "Build system is up to date by its manifest, checked in "
+          << (cmSystemTools::GetTime() - checkStart) * 1000 << " ms\n";
+      cmSystemTools::Stdout(msg.str().c_str());
+      }
+    return 0;
+    }
+
   if ( this->GetWorkingMode() == NORMAL_MODE )
     {
     // load the cache
@@ -1655,7 +1671,16 @@ int cmake::Run(const std::vector<std::string>& args, bool noconfigure)
 
   // now run the global generate
   // Check the state of the build system to see if we need to regenerate.
-  if(!this->CheckBuildSystem())
+  int rerun = this->CheckBuildSystem();
+  if(this->GetDebugOutput() && !this->CheckBuildSystemArgument.empty())
+    {
+    cmOStringStream msg;
+    msg << "Build system " << (rerun? "is out of date" : "is up to date")
+        << ", fully checked in "
+        << (cmSystemTools::GetTime() - checkStart) * 1000 << " ms\n";
+    cmSystemTools::Stdout(msg.str().c_str());
+    }
+  if(!rerun)
     {
     return 0;
     }
@@ -1933,6 +1958,9 @@ int cmake::CheckBuildSystem()
     return 1;
     }
 
+  // The manifest is valid only until the full check finds a change.
+  cmSystemTools::RemoveFile(this->GetBuildSystemManifest().c_str());
+
   // Read the rerun check file and use it to decide whether to do the
   // global generate.
   cmake cm;
@@ -2089,10 +2117,109 @@ int cmake::CheckBuildSystem()
     }
   }
 
+  // Record the files just checked so the next check can be cheap.
+  std::vector<std::string> files;
+  files.push_back(this->CheckBuildSystemArgument);
+  files.insert(files.end(), products.begin(), products.end());
+  files.insert(files.end(), depends.begin(), depends.end());
+  files.insert(files.end(), outputs.begin(), outputs.end());
+  this->WriteBuildSystemManifest(files);
+
   // No need to rerun.
   return 0;
 }
 
+//----------------------------------------------------------------------------
+// The manifest starts with this tag followed by one record per file:
+// the length of its path, the path and its modification time.
+static const char cmakeManifestTag[8] = {'C','M','C','H','E','C','K','1'};
+
+//----------------------------------------------------------------------------
+bool cmake::CheckBuildSystemManifest()
+{
+  std::string manifest = this->GetBuildSystemManifest();
+  cmsys::ifstream fin(manifest.c_str(), std::ios::in | std::ios::binary);
+  if(!fin)
+    {
+    return false;
+    }
+  std::string content;
+  char buffer[16384];
+  while(fin.read(buffer, sizeof(buffer)), fin.gcount() > 0)
+    {
+    content.append(buffer,
+                   static_cast<std::string::size_type>(fin.gcount()));
+    }
+  if(content.size() < sizeof(cmakeManifestTag) ||
+     memcmp(content.data(), cmakeManifestTag, sizeof(cmakeManifestTag)) != 0)
+    {
+    return false;
+    }
+
+  // Every file must still have the time recorded by the full check.
+  // Stat directly; each file is looked at only once.
+  cmFileTimeComparison ftc;
+  std::string::size_type pos = sizeof(cmakeManifestTag);
+  std::string::size_type const end = content.size();
+  bool any = false;
+  while(pos < end)
+    {
+    unsigned long len;
+    long stamp[2];
+    if(end - pos < sizeof(len))
+      {
+      return false;
+      }
+    memcpy(&len, content.data() + pos, sizeof(len));
+    pos += sizeof(len);
+    if(end - pos < len + sizeof(stamp))
+      {
+      return false;
+      }
+    std::string fname(content.data() + pos, len);
+    pos += len;
+    memcpy(stamp, content.data() + pos, sizeof(stamp));
+    pos += sizeof(stamp);
+
+    long current[2];
+    if(!ftc.GetFileTime(fname.c_str(), current) ||
+       current[0] != stamp[0] || current[1] != stamp[1])
+      {
+      return false;
+      }
+    any = true;
+    }
+  return any;
+}
+
+//----------------------------------------------------------------------------
+void cmake::WriteBuildSystemManifest(std::vector<std::string> const& files)
+{
+  std::string manifest = this->GetBuildSystemManifest();
+  std::string content(cmakeManifestTag, sizeof(cmakeManifestTag));
+  for(std::vector<std::string>::const_iterator fi = files.begin();
+      fi != files.end(); ++fi)
+    {
+    long stamp[2];
+    if(!this->FileComparison->GetFileTime(fi->c_str(), stamp))
+      {
+      // A byproduct may be a dangling symlink.  Always check fully.
+      return;
+      }
+    unsigned long len = static_cast<unsigned long>(fi->size());
+    content.append(reinterpret_cast<const char*>(&len), sizeof(len));
+    content.append(*fi);
+    content.append(reinterpret_cast<const char*>(stamp), sizeof(stamp));
+    }
+  cmsys::ofstream fout(manifest.c_str(), std::ios::out | std::ios::binary);
+  fout.write(content.data(), static_cast<std::streamsize>(content.size()));
+  if(!fout)
+    {
+    fout.close();
+    cmSystemTools::RemoveFile(manifest.c_str());
+    }
+}
+
 //----------------------------------------------------------------------------
 void cmake::TruncateOutputLog(const char* fname)
 {
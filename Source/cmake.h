@@ -408,6 +408,15 @@ protected:
    */
   int CheckBuildSystem();
 
+  /**
+   * Check the build system against the manifest written by the last
+   * full check.  Returns true if no file listed in it has changed.
+   */
+  bool CheckBuildSystemManifest();
+  void WriteBuildSystemManifest(std::vector<std::string> const& files);
+  std::string GetBuildSystemManifest() const
+    { return this->CheckBuildSystemArgument + ".check"; }
+
   void SetDirectoriesFromFile(const char* arg);
 
   //! Make sure all commands are what they say they are and there is no
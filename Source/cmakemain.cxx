@@ -168,6 +168,13 @@ int main(int ac, char const* const* av)
   av = args.argv();
 
   cmSystemTools::EnableMSVCDebugHook();
+  if(ac > 1 && strcmp(av[1], "-E") == 0)
+    {
+    // Build systems run command mode many times for small tasks that
+    // rarely need the resource paths.  Look them up only on demand.
+    cmSystemTools::FindCMakeResources(av[0], true);
+    return do_command(ac, av);
+    }
   cmSystemTools::FindCMakeResources(av[0]);
   if(ac > 1)
     {
@@ -175,10 +182,6 @@ int main(int ac, char const* const* av)
       {
       return do_build(ac, av);
       }
-    else if(strcmp(av[1], "-E") == 0)
-      {
-      return do_command(ac, av);
-      }
     }
   int ret = do_cmake(ac, av);
 #ifdef CMAKE_BUILD_WITH_CMAKE
@@ -15,6 +15,8 @@
 #include "cmGlobalGenerator.h"
 #include "cmQtAutoGenerators.h"
 #include "cmVersion.h"
+#include "cmFileTimeComparison.h"
+#include "cmGeneratedFileStream.h"
 
 #if defined(CMAKE_BUILD_WITH_CMAKE)
 # include "cmDependsFortran.h" // For -E cmake_copy_f90_mod callback.
@@ -92,6 +94,101 @@ void CMakeCommandUsage(const char* program)
   cmSystemTools::Error(errorStream.str().c_str());
 }
 
+//----------------------------------------------------------------------------
+static void cmcmdProgressReport(std::string const& dir,
+                                std::string const& num)
+{
+  std::string dirName = dir;
+  dirName += "/Progress";
+  std::string fName;
+  FILE *progFile;
+
+  // read the count
+  fName = dirName;
+  fName += "/count.txt";
+  progFile = cmsys::SystemTools::Fopen(fName.c_str(),"r");
+  int count = 0;
+  if (!progFile)
+    {
+    return;
+    }
+  else
+    {
+    if (1!=fscanf(progFile,"%i",&count))
+      {
+      cmSystemTools::Message("Could not read from progress file.");
+      }
+    fclose(progFile);
+    }
+
+  // The build of everything counted has finished.
+  if (num == "all")
+    {
+    if (count > 0)
+      {
+      fprintf(stdout,"[100%%] ");
+      }
+    return;
+    }
+
+  // Create a marker file for each progress mark not yet reached.  Marks
+  // may be reported more than once, e.g. again when the target is done.
+  std::string reached;
+  std::string::size_type pos = 0;
+  while (pos < num.size())
+    {
+    std::string::size_type end = num.find(',', pos);
+    if (end == num.npos)
+      {
+      end = num.size();
+      }
+    std::string mark = num.substr(pos, end - pos);
+    pos = end + 1;
+    if (mark.empty())
+      {
+      continue;
+      }
+    fName = dirName;
+    fName += "/";
+    fName += mark;
+    if (cmSystemTools::FileExists(fName.c_str()))
+      {
+      continue;
+      }
+    progFile = cmsys::SystemTools::Fopen(fName.c_str(),"w");
+    if (progFile)
+      {
+      fprintf(progFile,"empty");
+      fclose(progFile);
+      reached += ".";
+      }
+    }
+
+  // Record newly reached marks with one byte each in a shared file.
+  // Appends are atomic, so the size of the file is the number of marks
+  // reached so far without having to count the marker files.
+  fName = dirName;
+  fName += "/done.txt";
+  progFile = cmsys::SystemTools::Fopen(fName.c_str(),"a");
+  long done = 0;
+  if (progFile)
+    {
+    if (!reached.empty())
+      {
+      fwrite(reached.c_str(), 1, reached.size(), progFile);
+      fflush(progFile);
+      }
+    fseek(progFile, 0, SEEK_END);
+    done = ftell(progFile);
+    fclose(progFile);
+    }
+  if (count > 0 && done >= 0)
+    {
+    // print the progress
+    fprintf(stdout,"[%3i%%] ",static_cast<int>((done*100)/count));
+    }
+}
+
 int cmcmd::ExecuteCMakeCommand(std::vector<std::string>& args)
 {
   // IF YOU ADD A NEW COMMAND, DOCUMENT IT ABOVE and in cmakemain.cxx
@@ -438,48 +535,15 @@ int cmcmd::ExecuteCMakeCommand(std::vector<std::string>& args)
     // Command to report progress for a build
     else if (args[1] == "cmake_progress_report" && args.size() >= 3)
       {
-      std::string dirName = args[2];
-      dirName += "/Progress";
-      std::string fName;
-      FILE *progFile;
-
-      // read the count
-      fName = dirName;
-      fName += "/count.txt";
-      progFile = cmsys::SystemTools::Fopen(fName.c_str(),"r");
-      int count = 0;
-      if (!progFile)
+      std::string marks;
+      const char* sep = "";
+      for (unsigned int i = 3; i < args.size(); ++i)
         {
-        return 0;
-        }
-      else
-        {
-        if (1!=fscanf(progFile,"%i",&count))
-          {
-          cmSystemTools::Message("Could not read from progress file.");
-          }
-        fclose(progFile);
-        }
-      unsigned int i;
-      for (i = 3; i < args.size(); ++i)
-        {
-        fName = dirName;
-        fName += "/";
-        fName += args[i];
-        progFile = cmsys::SystemTools::Fopen(fName.c_str(),"w");
-        if (progFile)
-          {
-          fprintf(progFile,"empty");
-          fclose(progFile);
-          }
-        }
-      int fileNum = static_cast<int>
-        (cmsys::Directory::GetNumberOfFilesInDirectory(dirName.c_str()));
-      if (count > 0)
-        {
-        // print the progress
-        fprintf(stdout,"[%3i%%] ",((fileNum-3)*100)/count);
+        marks += sep;
+        marks += args[i];
+        sep = ",";
         }
+      cmcmdProgressReport(args[2], marks);
       return 0;
       }
 
@@ -632,6 +696,12 @@ int cmcmd::ExecuteCMakeCommand(std::vector<std::string>& args)
       return 1;
       }
 
+    // Internal CMake dependency scanning support for all targets.
+    else if (args[1] == "cmake_depends_all" && args.size() >= 5)
+      {
+      return cmcmd::ExecuteDependsAll(args);
+      }
+
     // Internal CMake link script support.
     else if (args[1] == "cmake_link_script" && args.size() >= 3)
       {
@@ -708,8 +778,17 @@ int cmcmd::ExecuteCMakeCommand(std::vector<std::string>& args)
         }
       else if ( flags.find_first_of('c') != flags.npos )
         {
+        // Compress with a parallel compressor if CMAKE_TAR_COMPRESSION_JOBS
+        // is set in the env to more than one job.
+        unsigned int jobs = 1;
+        const char* jobsVar =
+          cmSystemTools::GetEnv("CMAKE_TAR_COMPRESSION_JOBS");
+        if(jobsVar && atoi(jobsVar) > 1)
+          {
+          jobs = static_cast<unsigned int>(atoi(jobsVar));
+          }
         if ( !cmSystemTools::CreateTar(
-               outFile.c_str(), files, gzip, bzip2, verbose) )
+               outFile.c_str(), files, gzip, bzip2, verbose, jobs) )
           {
           cmSystemTools::Error("Problem creating tar: ", outFile.c_str());
           return 1;
@@ -745,6 +824,12 @@ int cmcmd::ExecuteCMakeCommand(std::vector<std::string>& args)
       return 0;
       }
 
+    // Internal CMake parallel installation support.
+    else if (args[1] == "cmake_copy_files" && args.size() >= 3)
+      {
+      return cmcmd::CopyFiles(args);
+      }
+
 #if defined(CMAKE_BUILD_WITH_CMAKE)
     // Internal CMake Fortran module support.
     else if (args[1] == "cmake_copy_f90_mod" && args.size() >= 4)
@@ -857,9 +942,21 @@ int cmcmd::ExecuteEchoColor(std::vector<std::string>& args)
   bool enabled = true;
   int color = cmsysTerminal_Color_Normal;
   bool newline = true;
+  std::string progressDir;
+  std::string progressNum;
   for(unsigned int i=2; i < args.size(); ++i)
     {
-    if(args[i].find("--switch=") == 0)
+    if(args[i].find("--progress-dir=") == 0)
+      {
+      // Report build progress before the text.  This saves running a
+      // separate cmake_progress_report for every rule.
+      progressDir = args[i].substr(15);
+      }
+    else if(args[i].find("--progress-num=") == 0)
+      {
+      progressNum = args[i].substr(15);
+      }
+    else if(args[i].find("--switch=") == 0)
       {
       // Enable or disable color based on the switch value.
       std::string value = args[i].substr(9);
@@ -925,12 +1022,21 @@ int cmcmd::ExecuteEchoColor(std::vector<std::string>& args)
       }
     else
       {
+      if(!progressDir.empty())
+        {
+        cmcmdProgressReport(progressDir, progressNum);
+        progressDir = "";
+        }
       // Color is enabled.  Print with the current color.
       cmSystemTools::MakefileColorEcho(color, args[i].c_str(),
                                        newline, enabled);
       }
     }
 
+  if(!progressDir.empty())
+    {
+    cmcmdProgressReport(progressDir, progressNum);
+    }
   return 0;
 }
 #else
@@ -940,6 +1046,148 @@ int cmcmd::ExecuteEchoColor(std::vector<std::string>&)
 }
 #endif
 
+//----------------------------------------------------------------------------
+int cmcmd::CopyFiles(std::vector<std::string>& args)
+{
+  // The list file holds alternating source and destination lines.
+  bool reflink = args.size() > 3 && args[3] == "--reflink";
+  cmsys::ifstream fin(args[2].c_str());
+  if(!fin)
+    {
+    std::cerr << "Error opening \"" << args[2] << "\".\n";
+    return 1;
+    }
+  std::string from;
+  std::string to;
+  while(cmSystemTools::GetLineFromStream(fin, from) &&
+        cmSystemTools::GetLineFromStream(fin, to))
+    {
+    if(reflink)
+      {
+      cmSystemTools::RemoveFile(to.c_str());
+      if(cmSystemTools::CloneFile(from.c_str(), to.c_str()))
+        {
+        continue;
+        }
+      }
+    if(!cmSystemTools::CopyAFile(from.c_str(), to.c_str(), true))
+      {
+      std::cerr << "Error copying file \"" << from
+                << "\" to \"" << to << "\".\n";
+      return 1;
+      }
+    }
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int cmcmd::ExecuteDependsAll(std::vector<std::string>& args)
+{
+  // The arguments are
+  //   argv[0] == <cmake-executable>
+  //   argv[1] == cmake_depends_all
+  //   argv[2] == <generator>
+  //   argv[3] == <home-src-dir>
+  //   argv[4] == <home-out-dir>
+  //   argv[5] == --color=$(COLOR)
+  bool verbose = ((cmSystemTools::GetEnv("VERBOSE") != 0)
+                  && (cmSystemTools::GetEnv("CMAKE_NO_VERBOSE") == 0));
+  bool color = false;
+  if(args.size() >= 6 && args[5].find("--color=") == 0)
+    {
+    color = (args[5].size() == 8 ||
+             cmSystemTools::IsOn(args[5].substr(8).c_str()));
+    }
+  std::string homeDir = cmSystemTools::CollapseFullPath(args[3].c_str());
+  std::string homeOutDir = cmSystemTools::CollapseFullPath(args[4].c_str());
+
+  cmake cm;
+  cm.SetHomeDirectory(homeDir);
+  cm.SetStartDirectory(homeDir);
+  cm.SetHomeOutputDirectory(homeOutDir);
+  cm.SetStartOutputDirectory(homeOutDir);
+  cmGlobalGenerator* ggd = cm.CreateGlobalGenerator(args[2]);
+  if(!ggd)
+    {
+    return 1;
+    }
+  cm.SetGlobalGenerator(ggd);
+
+  // Read the list of targets from the main dependency information.
+  std::vector<std::string> depInfoFiles;
+  {
+  cmsys::auto_ptr<cmLocalGenerator> lg(ggd->CreateLocalGenerator());
+  cmMakefile* mf = lg->GetMakefile();
+  mf->SetStartDirectory(homeDir);
+  mf->SetStartOutputDirectory(homeOutDir);
+  mf->MakeStartDirectoriesCurrent();
+  std::string cmakefileName = homeOutDir;
+  cmakefileName += cmake::GetCMakeFilesDirectory();
+  cmakefileName += "/Makefile.cmake";
+  if(!mf->ReadListFile(0, cmakefileName.c_str()) ||
+     cmSystemTools::GetErrorOccuredFlag())
+    {
+    cmSystemTools::Error("Main dependency information file not found");
+    return 1;
+    }
+  cmSystemTools::ExpandListArgument(
+    mf->GetSafeDefinition("CMAKE_DEPEND_INFO_FILES"), depInfoFiles);
+  }
+
+  // Scan each target with a local generator for its directory.  The
+  // file time comparison cache of the cmake instance is shared so that
+  // common headers are checked only once.
+  int result = 0;
+  for(std::vector<std::string>::iterator i = depInfoFiles.begin();
+      i != depInfoFiles.end(); ++i)
+    {
+    *i = homeOutDir + "/" + *i;
+    std::string tgtDir = cmSystemTools::GetFilenamePath(*i);
+    std::string startOutDir = cmSystemTools::GetFilenamePath(
+      cmSystemTools::GetFilenamePath(tgtDir));
+    cmsys::auto_ptr<cmLocalGenerator> lgd(ggd->CreateLocalGenerator());
+    lgd->GetMakefile()->SetStartDirectory(homeDir);
+    lgd->GetMakefile()->SetStartOutputDirectory(startOutDir);
+    lgd->GetMakefile()->MakeStartDirectoriesCurrent();
+    if(!lgd->UpdateDependencies(i->c_str(), verbose, color))
+      {
+      result = 2;
+      }
+    }
+
+  // Make reads the included file again only if it changed, so touch
+  // it only when some target has been scanned since it was written.
+  std::string stampFile = homeOutDir;
+  stampFile += cmake::GetCMakeFilesDirectory();
+  stampFile += "/depend_all.make";
+  bool scanned = !cmSystemTools::FileExists(stampFile.c_str());
+  cmFileTimeComparison ftc;
+  for(std::vector<std::string>::const_iterator i = depInfoFiles.begin();
+      !scanned && i != depInfoFiles.end(); ++i)
+    {
+    std::string tgtDir = cmSystemTools::GetFilenamePath(*i);
+    std::string internalDependFile = tgtDir + "/depend.internal";
+    int cmp;
+    scanned = (!ftc.FileTimeCompare(stampFile.c_str(),
+                                    internalDependFile.c_str(), &cmp) ||
+               cmp < 0);
+
+    // Dependencies written by the compiler may have been merged.
+    std::string compilerDependFile = tgtDir + "/compiler_depend.internal";
+    scanned = scanned ||
+      (ftc.FileTimeCompare(stampFile.c_str(),
+                           compilerDependFile.c_str(), &cmp) && cmp < 0);
+    }
+  if(scanned)
+    {
+    cmGeneratedFileStream stampStream(stampFile.c_str());
+    stampStream
+      << "# CMAKE generated file: DO NOT EDIT!\n"
+      << "# Dependencies of all targets have been scanned.\n";
+    }
+  return result;
+}
+
 //----------------------------------------------------------------------------
 int cmcmd::ExecuteLinkScript(std::vector<std::string>& args)
 {
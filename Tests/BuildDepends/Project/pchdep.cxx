@@ -0,0 +1,7 @@
+#include <stdio.h>
+#include "pch_dep.h"
+
+int main() {
+  printf("PCH_STRING: %s\n", PCH_STRING);
+  return 0;
+}
@@ -0,0 +1,197 @@
+/*============================================================================
+  CMake - Cross Platform Makefile Generator
+  Copyright 2000-2009 Kitware, Inc., Insight Software Consortium
+
+  Distributed under the OSI-approved BSD License (the "License");
+  see accompanying file Copyright.txt for details.
+
+  This software is distributed WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the License for more information.
+============================================================================*/
+#include "cmCTestGzipSource.h"
+
+#include "cmSystemTools.h"
+
+#include <cmsys/FStream.hxx>
+
+static const char* testFile = "testCTestGzipSource.txt";
+
+// Write several input buffers of data to the test file.
+static std::string writeInput()
+{
+  cmOStringStream oss;
+  unsigned int value = 1;
+  for(int i = 0; i < 8000; ++i)
+    {
+    value = value * 1103515245 + 12345;
+    oss << "line " << i << " value " << (value >> 16) << "\n";
+    }
+  std::string input = oss.str();
+  cmsys::ofstream fout(testFile, std::ios::out | std::ios::binary);
+  fout << input;
+  return input;
+}
+
+// Read through the curl read callback in pieces of the given size
+// until the end of the data or the given number of bytes.
+static bool readData(cmCTestGzipSource& src, size_t piece, size_t limit,
+                     std::string& out)
+{
+  std::vector<char> buffer(piece);
+  while(out.size() < limit)
+    {
+    size_t n = cmCTestGzipSource::ReadCallback(&*buffer.begin(), 1, piece,
+                                               &src);
+    if(n == CURL_READFUNC_ABORT)
+      {
+      printf("read callback aborted\n");
+      return false;
+      }
+    if(n == 0)
+      {
+      break;
+      }
+    out.append(&*buffer.begin(), n);
+    }
+  return true;
+}
+
+static bool inflateData(std::string const& in, std::string& out)
+{
+  z_stream strm;
+  strm.zalloc = Z_NULL;
+  strm.zfree = Z_NULL;
+  strm.opaque = Z_NULL;
+  strm.next_in = Z_NULL;
+  strm.avail_in = 0;
+  // A window size of 15 plus 16 accepts only the gzip format.
+  if(inflateInit2(&strm, 15 + 16) != Z_OK)
+    {
+    return false;
+    }
+  std::vector<char> data(in.begin(), in.end());
+  strm.next_in = reinterpret_cast<unsigned char*>(&*data.begin());
+  strm.avail_in = static_cast<uInt>(data.size());
+  unsigned char buffer[4096];
+  int ret = Z_OK;
+  while(ret == Z_OK)
+    {
+    strm.next_out = buffer;
+    strm.avail_out = sizeof(buffer);
+    ret = inflate(&strm, Z_NO_FLUSH);
+    out.append(reinterpret_cast<char*>(buffer),
+               sizeof(buffer) - strm.avail_out);
+    }
+  inflateEnd(&strm);
+  if(ret != Z_STREAM_END || strm.avail_in != 0)
+    {
+    printf("compressed data is not a complete gzip stream\n");
+    return false;
+    }
+  return true;
+}
+
+static bool checkData(const char* name, cmCTestGzipSource const& src,
+                      std::string const& compressed, std::string const& input)
+{
+  std::string output;
+  if(!inflateData(compressed, output) || output != input)
+    {
+    printf("%s: inflated %lu bytes do not match the %lu input bytes\n",
+           name, static_cast<unsigned long>(output.size()),
+           static_cast<unsigned long>(input.size()));
+    return false;
+    }
+  if(src.GetBytesRead() != input.size() ||
+     src.GetBytesSent() != compressed.size())
+    {
+    printf("%s: counted %lu bytes read and %lu sent, not %lu and %lu\n",
+           name, src.GetBytesRead(), src.GetBytesSent(),
+           static_cast<unsigned long>(input.size()),
+           static_cast<unsigned long>(compressed.size()));
+    return false;
+    }
+  return true;
+}
+
+static bool testSmallPieces(FILE* file, std::string const& input)
+{
+  cmCTestGzipSource src;
+  std::string compressed;
+  return (src.Start(file) &&
+          readData(src, 7, input.size() * 2, compressed) &&
+          checkData("small pieces", src, compressed, input));
+}
+
+static bool testRestart(FILE* file, std::string const& input)
+{
+  cmCTestGzipSource src;
+  std::string partial;
+  if(!src.Start(file) || !readData(src, 13, 2000, partial))
+    {
+    return false;
+    }
+  if(cmCTestGzipSource::IoctlCallback(0, CURLIOCMD_RESTARTREAD, &src)
+     != CURLIOE_OK)
+    {
+    printf("restart: ioctl callback failed to restart\n");
+    return false;
+    }
+  std::string compressed;
+  return (readData(src, 29, input.size() * 2, compressed) &&
+          checkData("restart", src, compressed, input));
+}
+
+static bool testNotStarted()
+{
+  cmCTestGzipSource src;
+  char buffer[16];
+  bool result = true;
+  if(cmCTestGzipSource::ReadCallback(buffer, 1, sizeof(buffer), &src)
+     != CURL_READFUNC_ABORT)
+    {
+    printf("not started: read callback did not abort\n");
+    result = false;
+    }
+  if(cmCTestGzipSource::IoctlCallback(0, CURLIOCMD_RESTARTREAD, &src)
+     != CURLIOE_FAILRESTART)
+    {
+    printf("not started: ioctl callback did not fail to restart\n");
+    result = false;
+    }
+  if(cmCTestGzipSource::IoctlCallback(0, CURLIOCMD_NOP, &src)
+     != CURLIOE_UNKNOWNCMD)
+    {
+    printf("not started: ioctl callback accepted an unknown command\n");
+    result = false;
+    }
+  return result;
+}
+
+int testCTestGzipSource(int, char*[])
+{
+  std::string input = writeInput();
+  FILE* file = cmSystemTools::Fopen(testFile, "rb");
+  if(!file)
+    {
+    printf("cannot open %s\n", testFile);
+    return 1;
+    }
+  int result = 0;
+  if(!testSmallPieces(file, input))
+    {
+    result = 1;
+    }
+  if(!testRestart(file, input))
+    {
+    result = 1;
+    }
+  fclose(file);
+  if(!testNotStarted())
+    {
+    result = 1;
+    }
+  cmSystemTools::RemoveFile(testFile);
+  return result;
+}
@@ -0,0 +1,55 @@
+/*============================================================================
+  CMake - Cross Platform Makefile Generator
+  Copyright 2000-2009 Kitware, Inc., Insight Software Consortium
+
+  Distributed under the OSI-approved BSD License (the "License");
+  see accompanying file Copyright.txt for details.
+
+  This software is distributed WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the License for more information.
+============================================================================*/
+#include <cmCTestRegularExpression.h>
+
+#include "cmStandardIncludes.h"
+
+static const char* const patterns[] = {
+  "foo", "^foo", "foo$", "^foo$", "^$", "^", "$", "f\\.o", "foo\\$",
+  "fo*", "^fo+b", "o?b", "^fo.b", "[fb]oo", "foo|bar", "^(foo|bar)$",
+  "a$b", "^ba", "r$", "foo\\", 0
+};
+
+static const char* const strings[] = {
+  "", "foo", "foobar", "barfoo", "fob", "foob", "fooob", "bar", "f.o",
+  "foo$", "fo", "b", "ba", "a$b", "foo\\", 0
+};
+
+int testCTestRegularExpression(int, char*[])
+{
+  int result = 0;
+  for(const char* const* p = patterns; *p; ++p)
+    {
+    cmsys::RegularExpression expected;
+    cmCTestRegularExpression actual;
+    if(expected.compile(*p) != actual.compile(*p))
+      {
+      printf("compile mismatch for [%s]\n", *p);
+      result = 1;
+      continue;
+      }
+    if(!actual.is_valid())
+      {
+      continue;
+      }
+    for(const char* const* s = strings; *s; ++s)
+      {
+      bool e = expected.find(*s);
+      if(actual.find(*s) != e || actual.find_cached(*s) != e)
+        {
+        printf("pattern [%s] on [%s]: expected %d\n", *p, *s, e? 1:0);
+        result = 1;
+        }
+      }
+    }
+  return result;
+}
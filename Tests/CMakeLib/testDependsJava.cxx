@@ -0,0 +1,95 @@
+/*============================================================================
+  CMake - Cross Platform Makefile Generator
+  Copyright 2000-2009 Kitware, Inc., Insight Software Consortium
+
+  Distributed under the OSI-approved BSD License (the "License");
+  see accompanying file Copyright.txt for details.
+
+  This software is distributed WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the License for more information.
+============================================================================*/
+#include "cmDependsJava.h"
+
+static const char source[] =
+  "/* package not.this; */\n"
+  "package com.example.app;\n"
+  "\n"
+  "import java.util.List;\n"
+  "import com.example.util.*;\n"
+  "import static com.example.math.Ops.add;\n"
+  "\n"
+  "@Deprecated\n"
+  "public class Main<T extends Comparable<T>> implements Runnable {\n"
+  "  // class NotAType\n"
+  "  private String s = \"class NotAType2 { \\\" }\";\n"
+  "  private char c = '{';\n"
+  "  class Nested { }\n"
+  "  public void run() {\n"
+  "    List<T> x = com.example.io.Files.open(0x1F, 1.5e3);\n"
+  "    Object o = Helper.class;\n"
+  "  }\n"
+  "}\n"
+  "interface Side { }\n"
+  "@interface Marker { }\n";
+
+static bool check(std::set<std::string> const& actual,
+                  const char* const* expected, const char* what)
+{
+  std::set<std::string> e;
+  for(; *expected; ++expected)
+    {
+    e.insert(*expected);
+    }
+  bool missing = false;
+  for(std::set<std::string>::const_iterator i = e.begin(); i != e.end(); ++i)
+    {
+    if(actual.find(*i) == actual.end())
+      {
+      printf("%s: missing [%s]\n", what, i->c_str());
+      missing = true;
+      }
+    }
+  return !missing;
+}
+
+static const char* const types[] = {"Main", "Side", "Marker", 0};
+static const char* const imports[] = {
+  "java.util.List", "com.example.util.*", "com.example.math.Ops", 0
+};
+static const char* const names[] = {
+  "List", "Helper", "Runnable", "Comparable", "Files", "String", 0
+};
+static const char* const qualified[] = {"com.example.io.Files.open", 0};
+static const char* const notNames[] = {
+  "NotAType", "NotAType2", "Nested", "1F", "5e3", 0
+};
+
+int testDependsJava(int, char*[])
+{
+  int result = 0;
+  cmDependsJavaSourceInfo info;
+  cmDependsJava::ScanSource(source, info);
+  if(info.Package != "com.example.app")
+    {
+    printf("package: [%s]\n", info.Package.c_str());
+    result = 1;
+    }
+  if(info.Types.size() != 3 || !check(info.Types, types, "types") ||
+     !check(info.Imports, imports, "imports") ||
+     !check(info.Names, names, "names") ||
+     !check(info.QualifiedNames, qualified, "qualified"))
+    {
+    result = 1;
+    }
+  for(const char* const* n = notNames; *n; ++n)
+    {
+    if(info.Names.find(*n) != info.Names.end() ||
+       info.Types.find(*n) != info.Types.end())
+      {
+      printf("unexpected name [%s]\n", *n);
+      result = 1;
+      }
+    }
+  return result;
+}
@@ -0,0 +1,112 @@
+/*============================================================================
+  CMake - Cross Platform Makefile Generator
+  Copyright 2000-2009 Kitware, Inc., Insight Software Consortium
+
+  Distributed under the OSI-approved BSD License (the "License");
+  see accompanying file Copyright.txt for details.
+
+  This software is distributed WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+  See the License for more information.
+============================================================================*/
+#include <cmXMLWriter.h>
+
+#include "cmStandardIncludes.h"
+
+static bool check(const char* name, std::string const& out,
+                  std::string const& expect)
+{
+  if(out != expect)
+    {
+    printf("%s: expected\n[%s]\ngot\n[%s]\n", name, expect.c_str(),
+           out.c_str());
+    return false;
+    }
+  return true;
+}
+
+static bool testNesting()
+{
+  cmOStringStream oss;
+  cmXMLWriter xml(oss);
+  xml.StartElement("Site");
+  xml.Attribute("Name", "a<b & \"c\"");
+  xml.StartElement("Test");
+  xml.Attribute("Status", "passed");
+  xml.Element("Name", "say \"hi\" <now> & \xC2\xA9 \f");
+  xml.StartElement("Empty");
+  xml.EndElement();
+  xml.Element("Count", 42);
+  xml.EndElement(); // Test
+  xml.EndElement(); // Site
+
+  // Nothing reaches the stream before the buffer is flushed.
+  bool result = check("nesting before Flush", oss.str(), "");
+  xml.Flush();
+  return check("nesting", oss.str(),
+    "<Site Name=\"a&lt;b &amp; &quot;c&quot;\">\n"
+    "\t<Test Status=\"passed\">\n"
+    "\t\t<Name>say \"hi\" &lt;now&gt; &amp; \xC2\xA9 "
+    "[NON-XML-CHAR-0xC]</Name>\n"
+    "\t\t<Empty/>\n"
+    "\t\t<Count>42</Count>\n"
+    "\t</Test>\n"
+    "</Site>\n") && result;
+}
+
+static bool testLevel()
+{
+  cmOStringStream oss;
+  {
+  cmXMLWriter xml(oss, 1);
+  xml.StartElement("Results");
+  xml.Fragment("<Raw/>");
+  xml.StartElement("Value");
+  xml.Content("1");
+  xml.Content(" & 2");
+  xml.EndElement(); // Value
+  xml.EndElement(); // Results
+  xml.Element("Next", "");
+  }
+  return check("level", oss.str(),
+    "\t<Results><Raw/>\n"
+    "\t\t<Value>1 &amp; 2</Value>\n"
+    "\t</Results>\n"
+    "\t<Next></Next>\n");
+}
+
+static bool testLargeContent()
+{
+  // Content larger than the buffer reaches the stream without a Flush.
+  cmOStringStream oss;
+  cmXMLWriter xml(oss);
+  std::string data(100000, '<');
+  xml.Element("Data", data);
+  std::string::size_type written = oss.str().size();
+  if(written != 6 + 4 * data.size())
+    {
+    printf("large content: expected %lu bytes before Flush, got %lu\n",
+           static_cast<unsigned long>(6 + 4 * data.size()),
+           static_cast<unsigned long>(written));
+    return false;
+    }
+  return true;
+}
+
+int testXMLWriter(int, char*[])
+{
+  int result = 0;
+  if(!testNesting())
+    {
+    result = 1;
+    }
+  if(!testLevel())
+    {
+    result = 1;
+    }
+  if(!testLargeContent())
+    {
+    result = 1;
+    }
+  return result;
+}
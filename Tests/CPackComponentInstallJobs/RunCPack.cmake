@@ -0,0 +1,61 @@
+foreach(var dir)
+  if(NOT DEFINED ${var})
+    message(FATAL_ERROR "${var} not defined")
+  endif()
+endforeach()
+
+message(STATUS "CTEST_FULL_OUTPUT (Avoid ctest truncation of output)")
+
+set(value "Custom b")
+
+# Package the components with the given number of install jobs and
+# check that each package holds what its component installed.
+macro(run_cpack jobs)
+  file(REMOVE ${dir}/pkg-a.tar.gz ${dir}/pkg-b.tar.gz ${dir}/pkg-c.tar.gz)
+  file(REMOVE_RECURSE ${dir}/_CPack_Packages)
+  execute_process(COMMAND ${CMAKE_CPACK_COMMAND} -G TGZ -V -C Custom
+    -D CPACK_COMPONENTS_INSTALL_JOBS=${jobs}
+    WORKING_DIRECTORY ${dir}
+    RESULT_VARIABLE result
+    OUTPUT_VARIABLE out
+    ERROR_VARIABLE out)
+  if(result)
+    message(FATAL_ERROR "cpack with ${jobs} install jobs failed:\n${out}")
+  endif()
+  foreach(comp a b c)
+    set(pkg_dir ${dir}/check-${jobs}-${comp})
+    file(REMOVE_RECURSE ${pkg_dir})
+    file(MAKE_DIRECTORY ${pkg_dir})
+    execute_process(COMMAND ${CMAKE_COMMAND} -E tar xzf
+      ${dir}/pkg-${comp}.tar.gz
+      WORKING_DIRECTORY ${pkg_dir})
+    file(GLOB_RECURSE files RELATIVE ${pkg_dir} ${pkg_dir}/*)
+    list(SORT files)
+    set(expect share/${comp}.txt)
+    if(comp STREQUAL "b")
+      set(expect share/b.txt share/value.txt)
+    endif()
+    if(NOT "${files}" STREQUAL "${expect}")
+      message(FATAL_ERROR "Package of ${comp} with ${jobs} install jobs "
+        "holds\n  ${files}\nbut expected\n  ${expect}\n${out}")
+    endif()
+  endforeach()
+  file(READ ${dir}/check-${jobs}-b/share/value.txt content)
+  if(NOT content STREQUAL "${value}")
+    message(FATAL_ERROR "Install script of b with ${jobs} install jobs "
+      "saw\n  ${content}\nbut expected\n  ${value}")
+  endif()
+endmacro()
+
+# The wrapper scripts of the child processes are left behind.
+run_cpack(1)
+file(GLOB_RECURSE scripts ${dir}/_CPack_Packages/InstallComponent-*.cmake)
+if(scripts)
+  message(FATAL_ERROR "Components installed in child processes:\n${out}")
+endif()
+run_cpack(3)
+file(GLOB_RECURSE scripts ${dir}/_CPack_Packages/InstallComponent-*.cmake)
+list(LENGTH scripts count)
+if(NOT count EQUAL 3)
+  message(FATAL_ERROR "Components not installed in child processes:\n${out}")
+endif()
@@ -0,0 +1,89 @@
+foreach(var dir src)
+  if(NOT DEFINED ${var})
+    message(FATAL_ERROR "${var} not defined")
+  endif()
+endforeach()
+
+message(STATUS "CTEST_FULL_OUTPUT (Avoid ctest truncation of output)")
+
+# Find out whether the file system of the build tree can clone files.
+set(can_clone 0)
+find_program(CP_EXECUTABLE cp)
+if(CP_EXECUTABLE AND CMAKE_HOST_SYSTEM_NAME STREQUAL "Linux")
+  file(WRITE ${dir}/clone-probe.txt "probe\n")
+  execute_process(COMMAND ${CP_EXECUTABLE} --reflink=always
+    ${dir}/clone-probe.txt ${dir}/clone-probe-copy.txt
+    RESULT_VARIABLE result OUTPUT_QUIET ERROR_QUIET)
+  if(result EQUAL 0)
+    set(can_clone 1)
+  endif()
+  file(REMOVE ${dir}/clone-probe.txt ${dir}/clone-probe-copy.txt)
+endif()
+message(STATUS "can_clone='${can_clone}'")
+
+# Run cpack with the given staging mode.
+macro(run_cpack mode)
+  file(REMOVE ${dir}/CPackStagingMode.tar.gz)
+  execute_process(COMMAND ${CMAKE_CPACK_COMMAND} -G TGZ -V
+    -D CPACK_STAGING_MODE=${mode}
+    WORKING_DIRECTORY ${dir}
+    RESULT_VARIABLE result
+    OUTPUT_VARIABLE out
+    ERROR_VARIABLE out)
+endmacro()
+
+# Check that the package of the last run holds both staged files.
+macro(check_package mode)
+  if(result)
+    message(FATAL_ERROR "cpack with ${mode} staging failed:\n${out}")
+  endif()
+  set(pkg_dir ${dir}/check-${mode})
+  file(REMOVE_RECURSE ${pkg_dir})
+  file(MAKE_DIRECTORY ${pkg_dir})
+  execute_process(COMMAND ${CMAKE_COMMAND} -E tar xzf
+    ${dir}/CPackStagingMode.tar.gz
+    WORKING_DIRECTORY ${pkg_dir})
+  foreach(pair "data/installed.txt;data/installed.txt"
+               "share/project.txt;project.txt")
+    list(GET pair 0 packaged)
+    list(GET pair 1 original)
+    file(READ ${src}/${original} expect)
+    set(content "")
+    if(EXISTS ${pkg_dir}/CPackStagingMode/${packaged})
+      file(READ ${pkg_dir}/CPackStagingMode/${packaged} content)
+    endif()
+    if(NOT content STREQUAL expect)
+      message(FATAL_ERROR
+        "${packaged} is missing or wrong in the package of ${mode} staging:"
+        "\n${out}")
+    endif()
+  endforeach()
+endmacro()
+
+# Copying stages the installed directories by copying their files.
+# Staging the file again finds it up to date and writes nothing.
+set(up_to_date "1 files up-to-date")
+run_cpack(COPY)
+check_package(COPY)
+set(expect "Staged 1 files: [^\n]* MB copied, 0 MB cloned, ${up_to_date}")
+if(NOT out MATCHES "${expect}")
+  message(FATAL_ERROR "COPY staging did not copy the files:\n${out}")
+endif()
+
+# Cloning falls back to copying on file systems that cannot clone.
+run_cpack(REFLINK)
+check_package(REFLINK)
+if(can_clone)
+  set(expect "Staged 1 files: 0 MB copied, [^\n]* MB cloned, ${up_to_date}")
+else()
+  set(expect "Staged 1 files: [^\n]* MB copied, 0 MB cloned, ${up_to_date}")
+endif()
+if(NOT out MATCHES "${expect}")
+  message(FATAL_ERROR "REFLINK staging did not match \"${expect}\":\n${out}")
+endif()
+
+# Hard links would let the package generators modify the original files.
+run_cpack(HARDLINK)
+if(NOT result OR NOT out MATCHES "CPACK_STAGING_MODE HARDLINK is not supported")
+  message(FATAL_ERROR "HARDLINK staging was not rejected:\n${out}")
+endif()
@@ -0,0 +1,14 @@
+static int covered(int n)
+{
+  if(n > 0)
+    {
+    return n;
+    }
+  return -n;
+}
+
+int main(int argc, char* argv[])
+{
+  (void)argv;
+  return covered(argc) == argc ? 0 : 1;
+}
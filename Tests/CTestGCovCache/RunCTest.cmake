@@ -0,0 +1,56 @@
+foreach(var dir src gcov)
+  if(NOT DEFINED ${var})
+    message(FATAL_ERROR "${var} not defined")
+  endif()
+endforeach()
+
+message(STATUS "CTEST_FULL_OUTPUT (Avoid ctest truncation of output)")
+
+# Write the coverage data of one run.
+file(GLOB_RECURSE gcda ${dir}/*.gcda)
+if(gcda)
+  file(REMOVE ${gcda})
+endif()
+execute_process(COMMAND ${dir}/covered RESULT_VARIABLE result)
+if(result)
+  message(FATAL_ERROR "covered failed: ${result}")
+endif()
+
+file(WRITE ${dir}/coverage.cmake "
+set(CTEST_SOURCE_DIRECTORY \"${src}\")
+set(CTEST_BINARY_DIRECTORY \"${dir}\")
+set(CTEST_COVERAGE_COMMAND \"${gcov}\")
+ctest_start(Experimental)
+ctest_coverage(RETURN_VALUE res)
+if(res)
+  message(FATAL_ERROR \"ctest_coverage failed\")
+endif()
+")
+file(REMOVE ${dir}/Testing/CoverageInfo/GCovCache.txt)
+
+# Collect the coverage and check whether gcov ran or its cached
+# results were used.
+macro(run_coverage expect)
+  execute_process(COMMAND ${CMAKE_CTEST_COMMAND} -S ${dir}/coverage.cmake -VV
+    WORKING_DIRECTORY ${dir}
+    RESULT_VARIABLE result
+    OUTPUT_VARIABLE out
+    ERROR_VARIABLE out)
+  if(result)
+    message(FATAL_ERROR "Coverage failed:\n${out}")
+  endif()
+  if(NOT out MATCHES "${expect}")
+    message(FATAL_ERROR "Coverage output does not match\n  ${expect}\n${out}")
+  endif()
+endmacro()
+
+run_coverage("Used cached coverage for 0 files.*Ran gcov on 1 files")
+run_coverage("Used cached coverage for 1 files.*Ran gcov on 0 files")
+
+# An edited source invalidates the cached results even though the
+# coverage data did not change.
+file(READ ${src}/covered.c content)
+file(APPEND ${src}/covered.c "/* edited */\n")
+run_coverage("Used cached coverage for 0 files.*Ran gcov on 1 files")
+run_coverage("Used cached coverage for 1 files.*Ran gcov on 0 files")
+file(WRITE ${src}/covered.c "${content}")
@@ -0,0 +1,35 @@
+# Write a report to the log file given in the sanitizer options, the
+# way a test built with a sanitizer would.
+foreach(var ASAN_OPTIONS LSAN_OPTIONS TSAN_OPTIONS)
+  if(DEFINED ENV{${var}})
+    set(options "$ENV{${var}}")
+    set(sanitizer ${var})
+  endif()
+endforeach()
+string(REGEX REPLACE ".*log_path=([^:]*).*" "\\1" log_file "${options}")
+
+if(sanitizer STREQUAL "ASAN_OPTIONS")
+  set(report "=================================================================
+==1234==ERROR: AddressSanitizer: heap-buffer-overflow on address 0x60200000eff4 at pc 0x4007d4 bp 0x7fff5f4c0f30 sp 0x7fff5f4c0f28
+WRITE of size 4 at 0x60200000eff4 thread T0
+    #0 0x4007d3 in main test.c:5
+")
+elseif(sanitizer STREQUAL "TSAN_OPTIONS")
+  set(report "==================
+WARNING: ThreadSanitizer: data race (pid=1234)
+  Write of size 4 at 0x7f4c44bfe010 by thread T1:
+    #0 Thread1 test.c:6
+")
+endif()
+if(NOT options MATCHES "detect_leaks=0")
+  set(report "${report}
+=================================================================
+==1234==ERROR: LeakSanitizer: detected memory leaks
+
+Direct leak of 4360 byte(s) in 1 object(s) allocated from:
+    #0 0x46c669 in malloc
+Indirect leak of 32 byte(s) in 1 object(s) allocated from:
+    #0 0x46c669 in malloc
+")
+endif()
+file(WRITE "${log_file}.1234" "${report}")
@@ -0,0 +1,16 @@
+#include <stdio.h>
+
+/* prints far more output than the capture limit */
+int main(void)
+{
+  int i;
+  for(i = 0; i < 20000; ++i)
+    {
+    if(i == 10000)
+      {
+      printf("middle of the output\n");
+      }
+    printf("line %d\n", i);
+    }
+  return 0;
+}
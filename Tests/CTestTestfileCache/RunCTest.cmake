@@ -0,0 +1,96 @@
+foreach(var dir)
+  if(NOT DEFINED ${var})
+    message(FATAL_ERROR "${var} not defined")
+  endif()
+endforeach()
+
+message(STATUS "CTEST_FULL_OUTPUT (Avoid ctest truncation of output)")
+
+unset(ENV{CTEST_TESTFILE_CACHE})
+unset(ENV{CTEST_TESTFILE_CACHE_TEST})
+set(cache ${dir}/CTestTestfile.cache)
+file(REMOVE ${cache} ${dir}/sub/flag.txt)
+
+# Regenerate the testfiles with the given options.  The testfiles
+# must be older than the run reading them to be cached.
+macro(configure)
+  execute_process(COMMAND ${CMAKE_COMMAND} ${ARGN} .
+    WORKING_DIRECTORY ${dir}
+    RESULT_VARIABLE result
+    OUTPUT_VARIABLE out
+    ERROR_VARIABLE out)
+  if(result)
+    message(FATAL_ERROR "Configuring with ${ARGN} failed:\n${out}")
+  endif()
+  execute_process(COMMAND ${CMAKE_COMMAND} -E sleep 1)
+endmacro()
+
+# List the tests and check whether they were read from the cache.
+macro(run_ctest how)
+  execute_process(COMMAND ${CMAKE_CTEST_COMMAND} -N -V
+    WORKING_DIRECTORY ${dir}
+    RESULT_VARIABLE result
+    OUTPUT_VARIABLE out
+    ERROR_VARIABLE out)
+  if(result)
+    message(FATAL_ERROR "ctest failed:\n${out}")
+  endif()
+  if("${how}" STREQUAL "cached")
+    set(expect "constructing a list of tests from [^\n]*CTestTestfile.cache")
+  else()
+    set(expect "Constructing a list of tests")
+  endif()
+  if(NOT out MATCHES "${expect}")
+    message(FATAL_ERROR "Tests not listed as ${how}:\n${out}")
+  endif()
+  set(tests ${ARGN})
+  list(LENGTH tests count)
+  if(NOT out MATCHES "Total Tests: ${count}\n")
+    message(FATAL_ERROR "Expected ${count} tests (${tests}):\n${out}")
+  endif()
+  foreach(test ${tests})
+    if(NOT out MATCHES "Test +#[0-9]+: ${test}\n")
+      message(FATAL_ERROR "Test ${test} not listed:\n${out}")
+    endif()
+  endforeach()
+endmacro()
+
+# The cache is used until a testfile changes.
+configure(-DEXTRA_TEST=OFF -DUSE_INCLUDE=OFF)
+run_ctest(read first second)
+if(NOT EXISTS ${cache})
+  message(FATAL_ERROR "${cache} was not written")
+endif()
+run_ctest(cached first second)
+configure(-DEXTRA_TEST=ON)
+run_ctest(read first extra second)
+run_ctest(cached first extra second)
+
+# Testfiles including other files are read every time.
+configure(-DUSE_INCLUDE=ON)
+run_ctest(read first extra second)
+if(EXISTS ${cache})
+  message(FATAL_ERROR "${cache} was written for a testfile with includes")
+endif()
+if(NOT out MATCHES "Not caching the list of tests: [^\n]*/include.cmake")
+  message(FATAL_ERROR "Include file not reported:\n${out}")
+endif()
+file(WRITE ${dir}/sub/flag.txt "flag\n")
+run_ctest(read first extra second flagged)
+set(ENV{CTEST_TESTFILE_CACHE_TEST} 1)
+run_ctest(read first extra second flagged env)
+unset(ENV{CTEST_TESTFILE_CACHE_TEST})
+file(REMOVE ${dir}/sub/flag.txt)
+run_ctest(read first extra second)
+
+# The cache may be turned off.
+configure(-DUSE_INCLUDE=OFF)
+set(ENV{CTEST_TESTFILE_CACHE} OFF)
+run_ctest(read first extra second)
+run_ctest(read first extra second)
+if(EXISTS ${cache})
+  message(FATAL_ERROR "${cache} was written with CTEST_TESTFILE_CACHE=OFF")
+endif()
+unset(ENV{CTEST_TESTFILE_CACHE})
+run_ctest(read first extra second)
+run_ctest(cached first extra second)
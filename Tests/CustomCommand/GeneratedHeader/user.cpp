@@ -0,0 +1,5 @@
+#include "generated.h"
+int mainGeneratedHeaderUser()
+{
+  return 0;
+}
@@ -0,0 +1,13 @@
+# Build the tree again after it has been built once.  Nothing may be
+# compiled or generated again and make may not warn about the rules.
+execute_process(COMMAND ${CMAKE_COMMAND} --build "${BUILD_DIR}"
+  OUTPUT_VARIABLE out ERROR_VARIABLE out RESULT_VARIABLE result)
+if(result)
+  message(FATAL_ERROR "Second build failed:\n${out}")
+endif()
+if(out MATCHES "warning|Circular|Building|Linking|Generating generated.h")
+  message(FATAL_ERROR "Second build was not a no-op:\n${out}")
+endif()
+if(NOT out MATCHES "\\[100%\\] Built all targets")
+  message(FATAL_ERROR "Second build did not report 100% progress:\n${out}")
+endif()
@@ -0,0 +1,3 @@
+      PROGRAM MAIN
+      CALL SUB
+      END
@@ -0,0 +1,3 @@
+      SUBROUTINE SHADOW
+      INCLUDE 'shadow.inc'
+      END
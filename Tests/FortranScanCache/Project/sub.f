@@ -0,0 +1,3 @@
+      SUBROUTINE SUB
+      INCLUDE 'late.inc'
+      END
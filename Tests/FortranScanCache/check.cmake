@@ -0,0 +1,83 @@
+# Build a Fortran project, then check that the dependency scanner reuses
+# the cached scan of an unchanged source and rescans it once one of its
+# unresolved includes appears, or a file appears earlier in the include
+# path than one of its resolved includes.
+set(src "${BUILD_DIR}/src")
+set(bld "${BUILD_DIR}/build")
+set(cache "${bld}/CMakeFiles/scan.dir/fortran.sourcecache")
+set(depends "${bld}/CMakeFiles/scan.dir/depend.make")
+
+file(REMOVE_RECURSE "${BUILD_DIR}")
+file(COPY "${CMAKE_CURRENT_LIST_DIR}/Project/" DESTINATION "${src}")
+file(MAKE_DIRECTORY "${src}/first")
+file(MAKE_DIRECTORY "${bld}")
+execute_process(COMMAND ${CMAKE_COMMAND} -G "${GENERATOR}"
+  "-DCMAKE_MAKE_PROGRAM=${MAKE_PROGRAM}"
+  "-DCMAKE_Fortran_COMPILER=${Fortran_COMPILER}"
+  "${src}"
+  WORKING_DIRECTORY "${bld}"
+  OUTPUT_VARIABLE out ERROR_VARIABLE out RESULT_VARIABLE result)
+if(result)
+  message(FATAL_ERROR "Configuring failed:\n${out}")
+endif()
+
+# Edit main.f so that the dependencies of the target are scanned again
+# and build the project.
+macro(rebuild desc)
+  execute_process(COMMAND ${CMAKE_COMMAND} -E sleep 1)
+  file(APPEND "${src}/main.f" "C     ${desc}\n")
+  execute_process(COMMAND ${CMAKE_COMMAND} --build "${bld}"
+    OUTPUT_VARIABLE out ERROR_VARIABLE out RESULT_VARIABLE result)
+  if(result)
+    message(FATAL_ERROR "Build ${desc} failed:\n${out}")
+  endif()
+  file(READ "${depends}" depend_make)
+endmacro()
+
+rebuild("initial")
+file(READ "${cache}" cache_content)
+if(NOT cache_content MATCHES " missing [^\n]*/src/late\\.inc\n")
+  message(FATAL_ERROR
+    "The unresolved late.inc is not in the scan cache:\n${cache_content}")
+endif()
+
+# Make the cache entry of sub.f claim that it includes cached.inc.  The
+# entry is still valid so the next scan must take the includes from it.
+file(MD5 "${src}/sub.f" sub_hash)
+file(MD5 "${src}/cached.inc" cached_hash)
+set(sub_entry "${src}/sub.f\n hash ${sub_hash}\n")
+string(FIND "${cache_content}" "${sub_entry}" pos)
+if(pos EQUAL -1)
+  message(FATAL_ERROR "No scan cache entry for sub.f:\n${cache_content}")
+endif()
+string(REPLACE "${sub_entry}"
+  "${sub_entry} include ${cached_hash} ${src}/cached.inc\n"
+  cache_content "${cache_content}")
+file(WRITE "${cache}" "${cache_content}")
+
+rebuild("cache hit")
+if(NOT depend_make MATCHES "cached\\.inc")
+  message(FATAL_ERROR
+    "The scan cache entry of sub.f was not used:\n${depend_make}")
+endif()
+
+# Once late.inc resolves the cached entry of sub.f is out of date.
+file(WRITE "${src}/late.inc" "C     Found by the dependency scanner.\n")
+rebuild("after late.inc appeared")
+if(depend_make MATCHES "cached\\.inc" OR
+    NOT depend_make MATCHES "src/late\\.inc")
+  message(FATAL_ERROR "sub.f was not scanned again:\n${depend_make}")
+endif()
+
+# Once a shadow.inc appears in the first include directory the cached
+# entry of shadow.f, which found it in the second one, is out of date.
+if(NOT depend_make MATCHES "src/second/shadow\\.inc")
+  message(FATAL_ERROR
+    "shadow.inc was not found in the second directory:\n${depend_make}")
+endif()
+file(WRITE "${src}/first/shadow.inc" "C     Shadows second/shadow.inc.\n")
+rebuild("after first/shadow.inc appeared")
+if(depend_make MATCHES "second/shadow\\.inc" OR
+    NOT depend_make MATCHES "src/first/shadow\\.inc")
+  message(FATAL_ERROR "shadow.f was not scanned again:\n${depend_make}")
+endif()
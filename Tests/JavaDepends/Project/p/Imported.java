@@ -0,0 +1,6 @@
+package p;
+
+public class Imported
+{
+  public static int value() { return 2; }
+}
@@ -0,0 +1,6 @@
+package p;
+
+public class Unrelated
+{
+  public int value() { return 3; }
+}
@@ -0,0 +1,6 @@
+package p;
+
+public class Used
+{
+  public static int value() { return 1; }
+}
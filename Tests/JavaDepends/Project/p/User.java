@@ -0,0 +1,7 @@
+package p;
+
+// Uses a type of the same package by its simple name.
+public class User
+{
+  public int value() { return Used.value(); }
+}
@@ -0,0 +1,9 @@
+package q;
+
+import p.Imported;
+
+// Uses a type of another package through an import.
+public class Importer
+{
+  public int value() { return Imported.value(); }
+}
@@ -0,0 +1,91 @@
+# Build a Java project, then check that editing a source rebuilds the
+# class files of the sources using its types, and that the dependency
+# scanner reuses the cached scan of unchanged sources.
+set(src "${BUILD_DIR}/src")
+set(bld "${BUILD_DIR}/build")
+set(obj "${bld}/CMakeFiles/scan.dir")
+set(cache "${obj}/java.sourcecache")
+set(classes p/Imported p/Unrelated p/Used p/User q/Importer)
+
+file(REMOVE_RECURSE "${BUILD_DIR}")
+file(COPY "${CMAKE_CURRENT_LIST_DIR}/Project/" DESTINATION "${src}")
+file(MAKE_DIRECTORY "${bld}")
+execute_process(COMMAND ${CMAKE_COMMAND} -G "${GENERATOR}"
+  "-DCMAKE_MAKE_PROGRAM=${MAKE_PROGRAM}"
+  "-DCMAKE_Java_COMPILER=${Java_COMPILER}"
+  "-DCMAKE_Java_ARCHIVE=${Java_ARCHIVE}"
+  "${src}"
+  WORKING_DIRECTORY "${bld}"
+  OUTPUT_VARIABLE out ERROR_VARIABLE out RESULT_VARIABLE result)
+if(result)
+  message(FATAL_ERROR "Configuring failed:\n${out}")
+endif()
+
+# Build the project and get the times of the class files.
+macro(build desc)
+  execute_process(COMMAND ${CMAKE_COMMAND} --build "${bld}"
+    OUTPUT_VARIABLE out ERROR_VARIABLE out RESULT_VARIABLE result)
+  if(result)
+    message(FATAL_ERROR "Build ${desc} failed:\n${out}")
+  endif()
+  file(READ "${obj}/depend.make" depend_make)
+  foreach(class ${classes})
+    file(TIMESTAMP "${obj}/${class}.class" "time_${class}" "%Y%m%d%H%M%S")
+  endforeach()
+endmacro()
+
+# Edit a source, build again, and check which class files were built.
+macro(edit source desc)
+  foreach(class ${classes})
+    set("old_${class}" "${time_${class}}")
+  endforeach()
+  execute_process(COMMAND ${CMAKE_COMMAND} -E sleep 1)
+  file(APPEND "${src}/${source}" "// ${desc}\n")
+  build("${desc}")
+  set(rebuilt)
+  foreach(class ${classes})
+    if(NOT "${time_${class}}" STREQUAL "${old_${class}}")
+      list(APPEND rebuilt ${class})
+    endif()
+  endforeach()
+endmacro()
+
+macro(check_rebuilt desc)
+  set(expect ${ARGN})
+  if(NOT "${rebuilt}" STREQUAL "${expect}")
+    message(FATAL_ERROR "After ${desc} the class files of\n  ${rebuilt}\n"
+      "were built instead of those of\n  ${expect}\n"
+      "The dependencies were:\n${depend_make}")
+  endif()
+endmacro()
+
+build("initial")
+if(NOT EXISTS "${cache}")
+  message(FATAL_ERROR "The scan cache was not written:\n  ${cache}")
+endif()
+
+# A class file depends on the source declaring a type of its package
+# that it uses by simple name.
+edit(p/Used.java "editing Used.java")
+check_rebuilt("editing Used.java" p/Used p/User)
+
+# A class file depends on the source declaring a type that it imports.
+edit(p/Imported.java "editing Imported.java")
+check_rebuilt("editing Imported.java" p/Imported q/Importer)
+
+# Make the cache entry of Unrelated.java claim that it uses Used.  The
+# entry is still valid so the next scan must take the names from it.
+file(READ "${cache}" cache_content)
+file(MD5 "${src}/p/Unrelated.java" unrelated_hash)
+set(unrelated_entry "${src}/p/Unrelated.java\n hash ${unrelated_hash}\n")
+string(FIND "${cache_content}" "${unrelated_entry}" pos)
+if(pos EQUAL -1)
+  message(FATAL_ERROR
+    "No scan cache entry for Unrelated.java:\n${cache_content}")
+endif()
+string(REPLACE "${unrelated_entry}" "${unrelated_entry} name Used\n"
+  cache_content "${cache_content}")
+file(WRITE "${cache}" "${cache_content}")
+
+edit(p/Used.java "using the scan cache")
+check_rebuilt("using the scan cache" p/Unrelated p/Used p/User)
@@ -0,0 +1,11 @@
+#ifndef EXPECT_PCH
+# include "pch.h"
+#endif
+#ifndef PCH_INCLUDED
+# error "PCH_INCLUDED not defined"
+#endif
+
+int foo()
+{
+  return pch_answer() - 41;
+}
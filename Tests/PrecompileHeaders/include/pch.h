@@ -0,0 +1,5 @@
+#ifndef PCH_H
+#define PCH_H
+#define PCH_INCLUDED 1
+inline int pch_answer() { return 42; }
+#endif
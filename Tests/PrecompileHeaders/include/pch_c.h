@@ -0,0 +1,4 @@
+#ifndef PCH_C_H
+#define PCH_C_H
+#define PCH_C_INCLUDED 1
+#endif
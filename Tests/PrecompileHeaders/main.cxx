@@ -0,0 +1,17 @@
+#ifndef EXPECT_PCH
+# include "pch.h"
+# include <vector>
+#endif
+#ifndef PCH_INCLUDED
+# error "PCH_INCLUDED not defined"
+#endif
+
+extern "C" int pchlib(void);
+int foo();
+int skip();
+
+int main()
+{
+  std::vector<int> v(1, pch_answer());
+  return (v[0] == 42 && foo() == 1 && skip() == 0 && pchlib() == 0)? 0 : 1;
+}
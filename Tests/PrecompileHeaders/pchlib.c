@@ -0,0 +1,11 @@
+#ifndef EXPECT_PCH
+# include "pch_c.h"
+#endif
+#ifndef PCH_C_INCLUDED
+# error "PCH_C_INCLUDED not defined"
+#endif
+
+int pchlib(void)
+{
+  return 0;
+}
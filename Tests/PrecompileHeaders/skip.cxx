@@ -0,0 +1,8 @@
+#ifdef PCH_INCLUDED
+# error "PCH_INCLUDED defined in a source skipping the precompiled header"
+#endif
+
+int skip()
+{
+  return 0;
+}
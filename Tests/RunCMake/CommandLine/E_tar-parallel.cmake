@@ -0,0 +1,52 @@
+set(dir ${CMAKE_CURRENT_BINARY_DIR})
+file(REMOVE_RECURSE ${dir}/in ${dir}/out ${dir}/stub ${dir}/pigz-args.txt)
+file(MAKE_DIRECTORY ${dir}/in ${dir}/out)
+string(RANDOM LENGTH 4096 content)
+foreach(i RANGE 1 64)
+  file(WRITE ${dir}/in/file${i}.txt "${i}\n${content}\n")
+endforeach()
+
+# Use a stand-in parallel compressor if possible to test the pipe to it.
+# It records its arguments to show that it was run.  It is written
+# outside the working directory, where it would be found first.
+find_program(GZIP_EXECUTABLE gzip)
+if(UNIX AND GZIP_EXECUTABLE)
+  set(stub 1)
+  file(MAKE_DIRECTORY ${dir}/bin)
+  file(WRITE ${dir}/stub/pigz "#!/bin/sh
+echo \"$@\" > \"${dir}/pigz-args.txt\"
+exec \"${GZIP_EXECUTABLE}\" -c
+")
+  file(COPY ${dir}/stub/pigz DESTINATION ${dir}/bin
+    FILE_PERMISSIONS OWNER_READ OWNER_WRITE OWNER_EXECUTE)
+  set(ENV{PATH} "${dir}/bin:$ENV{PATH}")
+endif()
+
+set(ENV{CMAKE_TAR_COMPRESSION_JOBS} 4)
+execute_process(COMMAND ${CMAKE_COMMAND} -E tar czf ${dir}/test.tar.gz in
+  WORKING_DIRECTORY ${dir} RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+  message(FATAL_ERROR "Creating the archive failed: ${result}")
+endif()
+unset(ENV{CMAKE_TAR_COMPRESSION_JOBS})
+if(stub)
+  if(NOT EXISTS ${dir}/pigz-args.txt)
+    message(FATAL_ERROR "The archive was not compressed through pigz")
+  endif()
+  file(READ ${dir}/pigz-args.txt args)
+  if(NOT args MATCHES "(^| )-p 4( |$)")
+    message(FATAL_ERROR "pigz was not given the number of jobs: ${args}")
+  endif()
+endif()
+
+execute_process(COMMAND ${CMAKE_COMMAND} -E tar xzf ${dir}/test.tar.gz
+  WORKING_DIRECTORY ${dir}/out RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+  message(FATAL_ERROR "Extracting the archive failed: ${result}")
+endif()
+foreach(i RANGE 1 64)
+  file(READ ${dir}/out/in/file${i}.txt extracted)
+  if(NOT extracted STREQUAL "${i}\n${content}\n")
+    message(FATAL_ERROR "file${i}.txt was not extracted correctly")
+  endif()
+endforeach()
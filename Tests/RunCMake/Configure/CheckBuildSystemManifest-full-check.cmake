@@ -0,0 +1,3 @@
+if(NOT EXISTS ${manifest})
+  set(RunCMake_TEST_FAILED "Manifest not written:\n  ${manifest}")
+endif()
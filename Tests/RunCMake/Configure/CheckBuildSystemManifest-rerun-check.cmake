@@ -0,0 +1,4 @@
+file(READ ${output} content)
+if(NOT content STREQUAL 2)
+  set(RunCMake_TEST_FAILED "Expected output '2' but got: '${content}'")
+endif()
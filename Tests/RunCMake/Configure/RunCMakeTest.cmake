@@ -22,3 +22,29 @@ file(WRITE "${depend}" "2")
 run_cmake_command(RerunCMake-build2 ${CMAKE_COMMAND} --build .)
 unset(RunCMake_TEST_BINARY_DIR)
 unset(RunCMake_TEST_NO_CLEAN)
+
+# A build system found up to date is recorded in a manifest checked
+# first by the next --check-build-system of the Makefile generators.
+if(RunCMake_GENERATOR MATCHES "Make")
+  set(RunCMake_TEST_BINARY_DIR
+    ${RunCMake_BINARY_DIR}/CheckBuildSystemManifest-build)
+  set(RunCMake_TEST_NO_CLEAN 1)
+  file(REMOVE_RECURSE "${RunCMake_TEST_BINARY_DIR}")
+  file(MAKE_DIRECTORY "${RunCMake_TEST_BINARY_DIR}")
+  set(depend "${RunCMake_TEST_BINARY_DIR}/CustomCMakeDepend.txt")
+  set(output "${RunCMake_TEST_BINARY_DIR}/CustomCMakeOutput.txt")
+  set(manifest "${RunCMake_TEST_BINARY_DIR}/CMakeFiles/Makefile.cmake.check")
+  set(check_build_system ${CMAKE_COMMAND}
+    -H${RunCMake_SOURCE_DIR} -B${RunCMake_TEST_BINARY_DIR}
+    --check-build-system CMakeFiles/Makefile.cmake 0 --debug-output)
+  file(WRITE "${depend}" "1")
+  run_cmake(CheckBuildSystemManifest)
+  execute_process(COMMAND ${CMAKE_COMMAND} -E sleep 1) # handle 1s resolution
+  run_cmake_command(CheckBuildSystemManifest-full ${check_build_system})
+  run_cmake_command(CheckBuildSystemManifest-manifest ${check_build_system})
+  execute_process(COMMAND ${CMAKE_COMMAND} -E sleep 1) # handle 1s resolution
+  file(WRITE "${depend}" "2")
+  run_cmake_command(CheckBuildSystemManifest-rerun ${check_build_system})
+  unset(RunCMake_TEST_BINARY_DIR)
+  unset(RunCMake_TEST_NO_CLEAN)
+endif()
@@ -0,0 +1,26 @@
+# The ELF-32.bin and ELF-64.bin files are shared libraries linked with
+# the RPATH "/sample/rpath".
+set(names ELF-32.bin ELF-64.bin)
+set(files)
+foreach(name ${names})
+  file(COPY ${CMAKE_CURRENT_LIST_DIR}/${name}
+    DESTINATION ${CMAKE_CURRENT_BINARY_DIR})
+  list(APPEND files "${CMAKE_CURRENT_BINARY_DIR}/${name}")
+endforeach()
+
+# RPATH_CHECK removes a file whose RPATH does not match.
+macro(check_rpath rpath desc)
+  foreach(f ${files})
+    file(RPATH_CHECK FILE "${f}" RPATH "${rpath}")
+    if(NOT EXISTS "${f}")
+      message(FATAL_ERROR "${desc} did not update the RPATH of\n  ${f}")
+    endif()
+  endforeach()
+endmacro()
+
+file(RPATH_CHANGE FILE ${files}
+  OLD_RPATH "/sample/rpath" NEW_RPATH "/rpath/sample")
+check_rpath("/rpath/sample" "RPATH_CHANGE")
+
+file(RPATH_REMOVE FILE ${files})
+check_rpath("" "RPATH_REMOVE")
@@ -0,0 +1,3 @@
+include(RunCMake)
+
+run_cmake_command(ELF ${CMAKE_COMMAND} -P ${RunCMake_SOURCE_DIR}/ELF.cmake)
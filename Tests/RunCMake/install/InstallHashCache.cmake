@@ -0,0 +1,22 @@
+set(dir ${CMAKE_CURRENT_BINARY_DIR})
+file(REMOVE_RECURSE ${dir}/in ${dir}/out ${dir}/hashes.txt)
+file(WRITE ${dir}/in/same.txt "same\n")
+file(WRITE ${dir}/in/changed.txt "old\n")
+set(ENV{CMAKE_INSTALL_HASH_CACHE} ${dir}/hashes.txt)
+file(INSTALL ${dir}/in/same.txt ${dir}/in/changed.txt DESTINATION ${dir}/out)
+
+# Rewrite both sources later; only the changed content is copied again.
+execute_process(COMMAND ${CMAKE_COMMAND} -E sleep 1.5)
+file(WRITE ${dir}/in/same.txt "same\n")
+file(WRITE ${dir}/in/changed.txt "new\n")
+file(INSTALL ${dir}/in/same.txt ${dir}/in/changed.txt DESTINATION ${dir}/out)
+
+file(READ ${dir}/out/changed.txt content)
+if(NOT content STREQUAL "new\n")
+  message(FATAL_ERROR "changed.txt was not installed again")
+endif()
+file(TIMESTAMP ${dir}/in/same.txt expect "%Y%m%d%H%M%S")
+file(TIMESTAMP ${dir}/out/same.txt actual "%Y%m%d%H%M%S")
+if(NOT actual STREQUAL expect)
+  message(FATAL_ERROR "same.txt has time ${actual}, not ${expect}")
+endif()
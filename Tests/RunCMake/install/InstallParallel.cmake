@@ -0,0 +1,64 @@
+set(dir ${CMAKE_CURRENT_BINARY_DIR})
+file(REMOVE_RECURSE ${dir}/in ${dir}/out ${dir}/dup ${dir}/out-dup)
+file(MAKE_DIRECTORY ${dir}/in/sub)
+string(RANDOM LENGTH 4096 content)
+foreach(i RANGE 1 64)
+  file(WRITE ${dir}/in/sub/file${i}.txt "${i}\n${content}\n")
+endforeach()
+
+# Copy the files in worker processes into a read-only tree.
+set(ENV{CMAKE_INSTALL_JOBS} 4)
+file(INSTALL ${dir}/in/ DESTINATION ${dir}/out
+  FILE_PERMISSIONS OWNER_READ
+  DIRECTORY_PERMISSIONS OWNER_READ OWNER_EXECUTE)
+unset(ENV{CMAKE_INSTALL_JOBS})
+
+foreach(i RANGE 1 64)
+  set(in ${dir}/in/sub/file${i}.txt)
+  set(out ${dir}/out/sub/file${i}.txt)
+  file(READ ${in} expect)
+  file(READ ${out} actual)
+  if(NOT actual STREQUAL expect)
+    message(FATAL_ERROR "File ${out} does not match ${in}")
+  endif()
+  file(TIMESTAMP ${in} expect "%Y%m%d%H%M%S")
+  file(TIMESTAMP ${out} actual "%Y%m%d%H%M%S")
+  if(NOT actual STREQUAL expect)
+    message(FATAL_ERROR "File ${out} has time ${actual}, not ${expect}")
+  endif()
+endforeach()
+
+if(UNIX)
+  execute_process(COMMAND chmod -R u+w ${dir}/out)
+endif()
+
+# Files installed to the same destination are installed in order, and
+# a path with a newline is not passed to the workers one per line.
+set(ENV{CMAKE_INSTALL_ALWAYS} 1)
+set(dirs)
+foreach(d RANGE 1 16)
+  foreach(i RANGE 1 9)
+    file(WRITE ${dir}/dup/${d}/file${i}.txt "${d} ${i}\n")
+  endforeach()
+  list(APPEND dirs ${dir}/dup/${d}/)
+endforeach()
+if(UNIX)
+  file(WRITE "${dir}/dup/16/new\nline.txt" "newline\n")
+endif()
+set(ENV{CMAKE_INSTALL_JOBS} 4)
+file(INSTALL ${dirs} DESTINATION ${dir}/out-dup)
+unset(ENV{CMAKE_INSTALL_JOBS})
+unset(ENV{CMAKE_INSTALL_ALWAYS})
+
+foreach(i RANGE 1 9)
+  file(READ ${dir}/out-dup/file${i}.txt actual)
+  if(NOT actual STREQUAL "16 ${i}\n")
+    message(FATAL_ERROR "File${i}.txt is not the last installed: ${actual}")
+  endif()
+endforeach()
+if(UNIX)
+  file(READ "${dir}/out-dup/new\nline.txt" actual)
+  if(NOT actual STREQUAL "newline\n")
+    message(FATAL_ERROR "File with a newline in its name was not installed")
+  endif()
+endif()
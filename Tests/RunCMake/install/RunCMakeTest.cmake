@@ -2,3 +2,9 @@ include(RunCMake)
 run_cmake(SkipInstallRulesWarning)
 run_cmake(SkipInstallRulesNoWarning1)
 run_cmake(SkipInstallRulesNoWarning2)
+run_cmake_command(InstallParallel
+  ${CMAKE_COMMAND} -P ${RunCMake_SOURCE_DIR}/InstallParallel.cmake
+  )
+run_cmake_command(InstallHashCache
+  ${CMAKE_COMMAND} -P ${RunCMake_SOURCE_DIR}/InstallHashCache.cmake
+  )
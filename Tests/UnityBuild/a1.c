@@ -0,0 +1,5 @@
+#if defined(EXPECT_UNITY) && !defined(MAIN_SEEN)
+# error "a1.c not batched with main.c"
+#endif
+#define A1_SEEN
+int a1(void) { return 1; }
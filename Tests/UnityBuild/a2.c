@@ -0,0 +1,5 @@
+#if defined(A1_SEEN)
+# error "a2.c batched with a1.c beyond the batch size"
+#endif
+#define A2_SEEN
+int a2(void) { return 1; }
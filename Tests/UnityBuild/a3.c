@@ -0,0 +1,5 @@
+#if defined(EXPECT_UNITY) && !defined(A2_SEEN)
+# error "a3.c not batched with a2.c"
+#endif
+#define A3_SEEN
+int a3(void) { return 1; }
@@ -0,0 +1,8 @@
+#if !defined(B_GROUP)
+# error "B_GROUP not defined"
+#endif
+#if defined(A3_SEEN)
+# error "b1.c batched with sources of other properties"
+#endif
+#define B1_SEEN
+int b1(void) { return 1; }
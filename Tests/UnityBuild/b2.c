@@ -0,0 +1,4 @@
+#if defined(EXPECT_UNITY) && !defined(B1_SEEN)
+# error "b2.c not batched with b1.c"
+#endif
+int b2(void) { return 1; }
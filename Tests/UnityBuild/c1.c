@@ -0,0 +1,8 @@
+#if !defined(C_GROUP)
+# error "C_GROUP not defined"
+#endif
+#if defined(A2_SEEN)
+# error "c1.c batched with sources of other configuration properties"
+#endif
+#define C1_SEEN
+int c1(void) { return 1; }
@@ -0,0 +1,7 @@
+#if !defined(C_GROUP)
+# error "C_GROUP not defined"
+#endif
+#if defined(EXPECT_UNITY) && !defined(C1_SEEN)
+# error "c2.c not batched with c1.c"
+#endif
+int c2(void) { return 1; }
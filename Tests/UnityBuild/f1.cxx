@@ -0,0 +1,2 @@
+#define F1_SEEN
+extern "C" int f1() { return 1; }
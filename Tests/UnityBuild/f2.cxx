@@ -0,0 +1,4 @@
+#if defined(EXPECT_UNITY) && !defined(F1_SEEN)
+# error "f2.cxx not batched with f1.cxx"
+#endif
+extern "C" int f2() { return 1; }
@@ -0,0 +1,17 @@
+#define MAIN_SEEN
+extern int a1(void);
+extern int a2(void);
+extern int a3(void);
+extern int b1(void);
+extern int b2(void);
+extern int c1(void);
+extern int c2(void);
+extern int skip(void);
+extern int f1(void);
+extern int f2(void);
+
+int main(void)
+{
+  return (a1() + a2() + a3() + b1() + b2() + c1() + c2() + skip() +
+          f1() + f2()) == 10? 0:1;
+}
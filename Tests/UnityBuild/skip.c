@@ -0,0 +1,4 @@
+#if defined(MAIN_SEEN) || defined(A1_SEEN) || defined(A3_SEEN)
+# error "skip.c batched despite SKIP_UNITY_BUILD_INCLUSION"
+#endif
+int skip(void) { return 1; }